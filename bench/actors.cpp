@@ -0,0 +1,54 @@
+// round trip latency and throughput of channels between a script and a worker
+#include <chrono>
+#include <fstream>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* worker =
+	"def echo(inbox, outbox, n) {\n"
+	"    for i in 0..n { chan::send(outbox, chan::recv(inbox)); }\n"
+	"}\n";
+
+static const char* source =
+	"def inbox = chan::make(64);\n"
+	"def outbox = chan::make(64);\n"
+	"def done = worker::spawn(\"actors_worker.tt\", \"echo\", inbox, outbox, 10000);\n"
+	"def ping(n) { for i in 0..n { chan::send(inbox, i); chan::recv(outbox); } }\n"
+	"def stream(n, v) {\n"
+	"    for i in 0..n { chan::send(inbox, v); if i >= 32 { chan::recv(outbox); } }\n"
+	"    for i in 0..min(n, 32) { chan::recv(outbox); }\n"
+	"}\n"
+	"def stop() { chan::recv(done); }\n";
+
+int main()
+{
+	std::ofstream f("actors_worker.tt");
+	f << worker;
+	f.close();
+
+	ScriptHost host;
+	if (!host.Load(source, "actors")) return 1;
+
+	// the worker echoes 10000 messages, one ping run and four stream runs
+	const int n = 2000;
+
+	auto t0 = std::chrono::steady_clock::now();
+	host.Function("ping")(n);
+	double rtt = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / n;
+	printf("round trip  %8.1f us\n", rtt);
+
+	ScriptFunction stream = host.Function("stream");
+	for (int size = 1; size <= 4096; size *= 16)
+	{
+		std::vector<int32_t> v(size, 1);
+		t0 = std::chrono::steady_clock::now();
+		stream(n, Literal(v));
+		double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / n;
+		printf("vec<i32> %5d %8.1f us/msg\n", size, us);
+	}
+
+	host.Function("stop")();
+	remove("actors_worker.tt");
+	return 0;
+}
@@ -0,0 +1,55 @@
+// native call overhead, Bind against a hand-written binding that takes its argument list by value
+#include <chrono>
+#include <string>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+template <typename F>
+static void Measure(const char* name, int iters, F ftn)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iters; ++i) ftn(i);
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / iters;
+	printf("%-40s %10.1f ns/call\n", name, ns);
+}
+
+int main()
+{
+	ScriptHost host;
+	Interpreter* interpreter = host.GetInterpreter();
+
+	// str::contains as it is bound now, and as the bindings were written before Binding.h
+	auto contains = [](const std::string& s, const std::string& search) { return std::string::npos != s.find(search); };
+	Literal bound = MakeNative("contains", contains, "global::");
+	Literal hand;
+	hand.SetCallable(2, [](const LiteralList& list)
+	{
+		LiteralList args = list;
+		if (!args[0].IsString() || !args[1].IsString()) return Literal();
+		return Literal(std::string::npos != args[0].StringValue().find(args[1].StringValue()));
+	}, "global::");
+
+	// a unary call on a large vector, only the list is copied, not the shared vector
+	Literal boundLen = MakeNative("len", [](const Literal& v) { return v.Len(); }, "global::");
+	Literal handLen;
+	handLen.SetCallable(1, [](const LiteralList& list)
+	{
+		LiteralList args = list;
+		return Literal(args[0].Len());
+	}, "global::");
+
+	const int iters = 200000;
+	LiteralList text = { Literal(std::string(200, 'a') + "b"), Literal(std::string("b")) };
+	LiteralList vec = { Literal(std::vector<int32_t>(2000, 1)) };
+
+	int32_t found = 0;
+	Measure("C++ call, contains", iters, [&](int) { found += contains(text[0].StringRef(), text[1].StringRef()); });
+	Measure("Bind, str::contains 200 chars", iters, [&](int) { found += bound.Call(interpreter, text).BoolValue(); });
+	Measure("hand-written, str::contains 200 chars", iters, [&](int) { found += hand.Call(interpreter, text).BoolValue(); });
+	Measure("Bind, len of 2000 element vec", iters, [&](int) { found += boundLen.Call(interpreter, vec).IntValue(); });
+	Measure("hand-written, len of 2000 element vec", iters, [&](int) { found += handLen.Call(interpreter, vec).IntValue(); });
+
+	printf("checksum = %d\n", found);
+	return 0;
+}
@@ -0,0 +1,35 @@
+// bitwise operators and bits:: against the same work emulated with % and /
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def count_div(n) { i32 c = 0; for i in 0..n { def x = i; while x > 0 { c = c + x % 2; x = (x / 2) as i32; } } return c; }\n"
+	"def count_bits(n) { i32 c = 0; for i in 0..n { c = c + bits::popcount(i); } return c; }\n"
+	"def flags_div(n) { i32 c = 0; for i in 0..n { if ((i / 4) as i32) % 2 == 1 { c = c + 1; } } return c; }\n"
+	"def flags_bits(n) { i32 c = 0; for i in 0..n { if i & 4 != 0 { c = c + 1; } } return c; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "bits")) return 1;
+
+	ScriptFunction countDiv = host.Function("count_div");
+	ScriptFunction countBits = host.Function("count_bits");
+	ScriptFunction flagsDiv = host.Function("flags_div");
+	ScriptFunction flagsBits = host.Function("flags_bits");
+
+	printf("popcount, %% and /   %8.1f ns\n", Measure(countDiv, 20000));
+	printf("bits::popcount      %8.1f ns\n", Measure(countBits, 20000));
+	printf("flag test, %% and /  %8.1f ns\n", Measure(flagsDiv, 100000));
+	printf("flag test, &        %8.1f ns\n", Measure(flagsBits, 100000));
+	return 0;
+}
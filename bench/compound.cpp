@@ -0,0 +1,38 @@
+// compound assignment against the equivalent plain assignment on a variable, a vector element and a field
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"struct unit_s { i32 hp; }\n"
+	"def add(n) { i32 x = 0; for i in 0..n { x = x + 1; } return x; }\n"
+	"def add_c(n) { i32 x = 0; for i in 0..n { x += 1; } return x; }\n"
+	"def elem(n) { vec<f32> v = [0.0, 0.0, 0.0, 0.0]; for i in 0..n { v[i % 4] = v[i % 4] + 0.5; } return v[0]; }\n"
+	"def elem_c(n) { vec<f32> v = [0.0, 0.0, 0.0, 0.0]; for i in 0..n { v[i % 4] += 0.5; } return v[0]; }\n"
+	"def field(n) { unit_s u; u.hp = n; for i in 0..n { u.hp = u.hp - 1; } return u.hp; }\n"
+	"def field_c(n) { unit_s u; u.hp = n; for i in 0..n { u.hp -= 1; } return u.hp; }\n"
+	"def text(n) { string s = \"\"; for i in 0..n { s = s + \"x\"; } return s; }\n"
+	"def text_c(n) { string s = \"\"; for i in 0..n { s += \"x\"; } return s; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "compound")) return 1;
+
+	const char* names[] = { "add", "elem", "field", "text" };
+	for (const char* name : names)
+	{
+		ScriptFunction plain = host.Function(name);
+		ScriptFunction compound = host.Function(std::string(name) + "_c");
+		printf("%-6s x = x op y %8.1f ns   x op= y %8.1f ns\n", name, Measure(plain, 100000), Measure(compound, 100000));
+	}
+	return 0;
+}
@@ -0,0 +1,35 @@
+// string + chains copied into a new string, appended in place, and written to a strbuf
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def copied(n) { string out = \"\"; for i in 0..n { string row = out + \" \" + i as string; out = row; } return len(out); }\n"
+	"def appended(n) { string out = \"\"; for i in 0..n { out = out + \" \" + i as string; } return len(out); }\n"
+	"def buffered(n) { def sb = strbuf::make(0); for i in 0..n { strbuf::append(sb, \" \"); strbuf::append(sb, i); } return strbuf::len(sb); }\n"
+	"def joined(n) { string s = \"\"; string a = \"unit\"; for i in 0..n { s = a + \" #\" + i as string + \" of \" + a; } return len(s); }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "concat")) return 1;
+
+	ScriptFunction copied = host.Function("copied");
+	ScriptFunction appended = host.Function("appended");
+	ScriptFunction buffered = host.Function("buffered");
+	ScriptFunction joined = host.Function("joined");
+
+	printf("s = s + ..., copied   %8.1f ns\n", Measure(copied, 50000));
+	printf("s = s + ..., in place %8.1f ns\n", Measure(appended, 50000));
+	printf("strbuf::append        %8.1f ns\n", Measure(buffered, 50000));
+	printf("a + b + c + d + e     %8.1f ns\n", Measure(joined, 50000));
+	return 0;
+}
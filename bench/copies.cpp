@@ -0,0 +1,40 @@
+// Literal copies per statement, built with -DLITERAL_COUNT_COPIES
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"struct point_s { f32 x; f32 y; }\n"
+	"def add(a, b) { return a + b; }\n"
+	"def empty(n) { for i in 0..n { } }\n"
+	"def assign(n) { i32 x = 0; for i in 0..n { x = x + 1; } }\n"
+	"def define(n) { for i in 0..n { i32 t = i; } }\n"
+	"def call(n) { i32 x = 0; for i in 0..n { x = add(x, 1); } }\n"
+	"def index(n) { vec<i32> v = [0; 16]; for i in 0..n { v[3] = v[3] + 1; } }\n"
+	"def field(n) { point_s p; for i in 0..n { p.x = p.x + 1.0; } }\n";
+
+static uint64_t Copies(ScriptFunction& ftn, int n)
+{
+	uint64_t before = CopyCounter::Count().load();
+	ftn(n);
+	return CopyCounter::Count().load() - before;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "copies")) return 1;
+
+	const int n = 10000;
+	ScriptFunction empty = host.Function("empty");
+	double loop = double(Copies(empty, n)) / n;
+	printf("loop iteration %6.2f copies\n", loop);
+
+	const char* names[] = { "assign", "define", "call", "index", "field" };
+	for (const char* name : names)
+	{
+		ScriptFunction ftn = host.Function(name);
+		printf("%-14s %6.2f copies\n", name, double(Copies(ftn, n)) / n - loop);
+	}
+	return 0;
+}
@@ -0,0 +1,41 @@
+// host -> script call latency through ScriptHost function handles
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"f32 total = 0.0;\n"
+	"def update(dt) { total = total + dt; }\n"
+	"def draw() { return total; }\n"
+	"def add(a, b) { return a + b; }\n";
+
+template <typename F>
+static void Measure(const char* name, int iters, F ftn)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	for (int i = 0; i < iters; ++i) ftn(i);
+	double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / iters;
+	printf("%-32s %10.1f ns/call\n", name, ns);
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "embed_call")) return 1;
+
+	ScriptFunction update = host.Function("update");
+	ScriptFunction draw = host.Function("draw");
+	ScriptFunction add = host.Function("add");
+
+	const int iters = 100000;
+	Measure("handle update(dt)", iters, [&](int) { update(0.016); });
+	Measure("handle draw()", iters, [&](int) { draw(); });
+	Measure("handle add(i, 1) as i32", iters, [&](int i) { add.CallAs<int32_t>(i, 1); });
+
+	// what a host had to do before: run a source buffer per call
+	Measure("Load(\"update(0.016);\")", iters / 10, [&](int) { host.Load("update(0.016);", "frame"); });
+
+	printf("total = %s\n", draw().ToString().c_str());
+	return 0;
+}
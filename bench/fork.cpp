@@ -0,0 +1,54 @@
+// cost of forking a loaded game state compared to running its setup again
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"struct unit_s { i32 hp; vec<f32> pos; }\n"
+	"vec<f32> grid = rand(100000);\n"
+	"vec<unit_s> units;\n"
+	"map<i32, string> names;\n"
+	"for i in 0..200 {\n"
+	"    unit_s u; u.hp = i; u.pos = [1.0, 2.0];\n"
+	"    units = vec::append(units, u);\n"
+	"    names = map::insert(names, i, \"unit\");\n"
+	"}\n"
+	"def hit(i, v) { grid[i] = v; }\n"
+	"def cell(i) { return grid[i]; }\n";
+
+static double Seconds(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main()
+{
+	const int forks = 1000;
+
+	auto t0 = std::chrono::steady_clock::now();
+	ScriptHost root;
+	root.Load(source, "fork");
+	double setup = Seconds(t0);
+
+	t0 = std::chrono::steady_clock::now();
+	std::vector<std::unique_ptr<ScriptHost> > clones;
+	for (int i = 0; i < forks; ++i) clones.push_back(root.Fork());
+	double fork = Seconds(t0) / forks;
+
+	// the first write to a shared payload pays for its copy
+	t0 = std::chrono::steady_clock::now();
+	for (auto& c : clones) c->Function("hit")(7, -1.0);
+	double write = Seconds(t0) / forks;
+
+	double before = root.Function("cell").CallAs<double>(7);
+	double after = clones[0]->Function("cell").CallAs<double>(7);
+
+	printf("setup %10.1f us\n", setup * 1e6);
+	printf("fork  %10.1f us\n", fork * 1e6);
+	printf("write %10.1f us (first write to a 100k vec in each clone)\n", write * 1e6);
+	printf("root cell %f, clone cell %f\n", before, after);
+	return 0;
+}
@@ -0,0 +1,36 @@
+// cost of resuming a generator compared to calling a function from script
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def step(i) { return i; }\n"
+	"def steps() { i32 i = 0; loop { yield i; i = i + 1; } }\n"
+	"def calls(n) { i32 s = 0; for i in 0..n { s = step(i); } return s; }\n"
+	"def resumes(n) { def g = steps(); i32 s = 0; for i in 0..n { s = co::resume(g); } return s; }\n"
+	"def empty(n) { i32 s = 0; for i in 0..n { s = i; } return s; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "generators")) return 1;
+
+	ScriptFunction empty = host.Function("empty");
+	ScriptFunction calls = host.Function("calls");
+	ScriptFunction resumes = host.Function("resumes");
+
+	const int n = 20000;
+	double loop = Measure(empty, n);
+	printf("loop iteration  %10.1f ns\n", loop);
+	printf("function call   %10.1f ns\n", Measure(calls, n) - loop);
+	printf("generator resume%10.1f ns\n", Measure(resumes, n) - loop);
+	return 0;
+}
@@ -0,0 +1,35 @@
+// a small helper called at its call site against the same helper called through a frame
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def clamp(x, lo, hi) { if x < lo { return lo; } if x > hi { return hi; } return x; }\n"
+	"def inlined(n) { i32 s = 0; for i in 0..n { s = clamp(i, 10, 20); } return s; }\n"
+	"def framed(n) { def c = clamp; i32 s = 0; for i in 0..n { s = c(i, 10, 20); } return s; }\n"
+	"def empty(n) { i32 s = 0; for i in 0..n { s = i; } return s; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "inline")) return 1;
+
+	ScriptFunction empty = host.Function("empty");
+	ScriptFunction inlined = host.Function("inlined");
+	ScriptFunction framed = host.Function("framed");
+
+	const int n = 20000;
+	double loop = Measure(empty, n);
+	printf("loop iteration  %10.1f ns\n", loop);
+	printf("framed call     %10.1f ns\n", Measure(framed, n) - loop);
+	printf("inlined call    %10.1f ns\n", Measure(inlined, n) - loop);
+	return 0;
+}
@@ -0,0 +1,39 @@
+// match against the if/else if chain it replaces, for the first and the last of eight enum states
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def chain(e, n) { def s = 0; for i in 0..n {\n"
+	"  if e == :IDLE { s = s + 1; } else if e == :WALK { s = s + 2; } else if e == :RUN { s = s + 3; } else if e == :JUMP { s = s + 4; }\n"
+	"  else if e == :FALL { s = s + 5; } else if e == :SWIM { s = s + 6; } else if e == :CLIMB { s = s + 7; } else if e == :DEAD { s = s + 8; } }\n"
+	"  return s; }\n"
+	"def matched(e, n) { def s = 0; for i in 0..n {\n"
+	"  match e { :IDLE => { s = s + 1; } :WALK => { s = s + 2; } :RUN => { s = s + 3; } :JUMP => { s = s + 4; }\n"
+	"  :FALL => { s = s + 5; } :SWIM => { s = s + 6; } :CLIMB => { s = s + 7; } :DEAD => { s = s + 8; } } }\n"
+	"  return s; }\n";
+
+static double Measure(ScriptFunction& ftn, const char* state, int n)
+{
+	Literal e = Literal(EnumLiteral(state));
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(e, n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "match")) return 1;
+
+	ScriptFunction chain = host.Function("chain");
+	ScriptFunction matched = host.Function("matched");
+
+	const int n = 100000;
+	printf("if chain, first %10.1f ns\n", Measure(chain, ":IDLE", n));
+	printf("if chain, last  %10.1f ns\n", Measure(chain, ":DEAD", n));
+	printf("match, first    %10.1f ns\n", Measure(matched, ":IDLE", n));
+	printf("match, last     %10.1f ns\n", Measure(matched, ":DEAD", n));
+	return 0;
+}
@@ -0,0 +1,39 @@
+// def pure against a plain def on repeated arguments, and the cost of a memo miss
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def fib(n) { if n < 2 { return n; } return fib(n - 1) + fib(n - 2); }\n"
+	"def pure pfib(n) { if n < 2 { return n; } return pfib(n - 1) + pfib(n - 2); }\n"
+	"def square(x) { return x * x; }\n"
+	"def pure psquare(x) { return x * x; }\n"
+	"def plain(n) { i32 s = 0; for i in 0..n { s = fib(20); } return s; }\n"
+	"def cached(n) { i32 s = 0; for i in 0..n { s = pfib(20); } return s; }\n"
+	"def calls(n) { i32 s = 0; for i in 0..n { s = square(i); } return s; }\n"
+	"def misses(n) { i32 s = 0; for i in 0..n { s = psquare(i); } return s; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "memo")) return 1;
+
+	ScriptFunction plain = host.Function("plain");
+	ScriptFunction cached = host.Function("cached");
+	ScriptFunction calls = host.Function("calls");
+	ScriptFunction misses = host.Function("misses");
+
+	printf("fib(20)         %10.1f us\n", Measure(plain, 20));
+	printf("pure fib(20)    %10.1f us\n", Measure(cached, 20000));
+	printf("call            %10.1f us\n", Measure(calls, 20000));
+	printf("pure call, miss %10.1f us\n", Measure(misses, 20000));
+	return 0;
+}
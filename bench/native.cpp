@@ -0,0 +1,45 @@
+// def native against the same body interpreted, and the first call that builds or loads the object
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def fib(n) { if n < 2 { return n; } return fib(n - 1) + fib(n - 2); }\n"
+	"def native nfib(n) { if n < 2 { return n; } return nfib(n - 1) + nfib(n - 2); }\n"
+	"def dot(a, b) { f32 s = 0; for i in 0..len(a) { s = s + a[i] * b[i]; } return s; }\n"
+	"def native ndot(a, b) { f32 s = 0; for i in 0..len(a) { s = s + a[i] * b[i]; } return s; }\n";
+
+template <typename... A>
+static double Measure(ScriptFunction& ftn, A... args)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(args...);
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "native")) return 1;
+
+	ScriptFunction fib = host.Function("fib");
+	ScriptFunction nfib = host.Function("nfib");
+	ScriptFunction dot = host.Function("dot");
+	ScriptFunction ndot = host.Function("ndot");
+
+	std::vector<double> a(100000), b(100000);
+	for (size_t i = 0; i < a.size(); ++i) { a[i] = 0.5 * i; b[i] = 1.0 / (i + 1); }
+	Literal va(a), vb(b);
+
+	// compiled, or loaded from the cache when an earlier run built it
+	printf("first call      %12.1f us\n", Measure(nfib, 1));
+
+	printf("fib(25)         %12.1f us\n", Measure(fib, 25));
+	printf("native fib(25)  %12.1f us\n", Measure(nfib, 25));
+
+	Measure(ndot, va, vb);
+	printf("dot 100k        %12.1f us\n", Measure(dot, va, vb));
+	printf("native dot 100k %12.1f us\n", Measure(ndot, va, vb));
+	return 0;
+}
@@ -0,0 +1,44 @@
+// parallel for scaling over worker thread count
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"vec<f32> px = rand(4000);\n"
+	"vec<f32> vx = rand(4000);\n"
+	"vec<f32> out = [0.0; 4000];\n"
+	"def update(dt) {\n"
+	"    parallel for i in 0..len(out) {\n"
+	"        f32 x = px[i];\n"
+	"        for k in 0..8 { x = x + vx[i] * dt + sin(x) * 0.01; }\n"
+	"        out[i] = x;\n"
+	"    }\n"
+	"}\n"
+	"def checksum() { f32 s = 0.0; for i in 0..len(out) { s = s + out[i]; } return s; }\n";
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "parallel_for")) return 1;
+	ScriptFunction update = host.Function("update");
+	ScriptFunction checksum = host.Function("checksum");
+
+	const int frames = 5;
+	double base = 0;
+	printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+	printf("%8s %12s %12s %14s\n", "threads", "ms/frame", "scaling", "checksum");
+	for (int n = 1; n <= 16; n *= 2)
+	{
+		host.GetInterpreter()->SetThreads(n);
+		update(0.016);
+
+		auto t0 = std::chrono::steady_clock::now();
+		for (int f = 0; f < frames; ++f) update(0.016);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count() / frames;
+
+		if (1 == n) base = ms;
+		printf("%8d %12.2f %11.2fx %14.4f\n", n, ms, base / ms, checksum.CallAs<double>());
+	}
+	return 0;
+}
@@ -0,0 +1,43 @@
+// println through the output buffer against printf of ToString per line, stdout goes to the null device
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def numbers(n) { for i in 0..n { println(i * 3); } flush(); return n; }\n"
+	"def vectors(n) { vec<f32> v = [0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5]; for i in 0..n { println(v); } flush(); return n; }\n"
+	"def old_numbers(n) { for i in 0..n { printf_line(i * 3); } return n; }\n"
+	"def old_vectors(n) { vec<f32> v = [0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5]; for i in 0..n { printf_line(v); } return n; }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	fflush(stdout);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+#ifdef _WIN32
+	if (!freopen("NUL", "w", stdout)) return 1;
+#else
+	if (!freopen("/dev/null", "w", stdout)) return 1;
+#endif
+
+	ScriptHost host;
+	host.Bind("printf_line", [](const Literal& value) { printf("%s\n", value.ToString().c_str()); });
+	if (!host.Load(source, "print")) return 1;
+
+	ScriptFunction numbers = host.Function("numbers");
+	ScriptFunction vectors = host.Function("vectors");
+	ScriptFunction oldNumbers = host.Function("old_numbers");
+	ScriptFunction oldVectors = host.Function("old_vectors");
+
+	fprintf(stderr, "i32 line, printf      %8.1f ns\n", Measure(oldNumbers, 200000));
+	fprintf(stderr, "i32 line, buffered    %8.1f ns\n", Measure(numbers, 200000));
+	fprintf(stderr, "vec<f32> line, printf %8.1f ns\n", Measure(oldVectors, 100000));
+	fprintf(stderr, "vec<f32> line, buffer %8.1f ns\n", Measure(vectors, 100000));
+	return 0;
+}
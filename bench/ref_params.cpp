@@ -0,0 +1,33 @@
+// updating one element of a large vec passed by value and returned, against passed by reference
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"vec<i32> data = [0; 100000];\n"
+	"def set_value(v, i) { v[i] = i; return v; }\n"
+	"def set_ref(&v, i) { v[i] = i; }\n"
+	"def by_value(n) { for i in 0..n { data = set_value(data, i); } }\n"
+	"def by_ref(n) { for i in 0..n { set_ref(&data, i); } }\n";
+
+static double Measure(ScriptFunction& ftn, int n)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ftn(n);
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "ref_params")) return 1;
+
+	ScriptFunction byValue = host.Function("by_value");
+	ScriptFunction byRef = host.Function("by_ref");
+
+	const int n = 2000;
+	printf("by value  %8.2f us/call\n", Measure(byValue, n));
+	printf("by ref    %8.2f us/call\n", Measure(byRef, n));
+	return 0;
+}
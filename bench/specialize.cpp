@@ -0,0 +1,47 @@
+// one def body run generic, while its TypeProfile has not seen enough calls, and then specialized
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+#include "TypeProfile.h"
+
+static const char* source =
+	"def poly(x, y, n) { def s = x; for i in 0..n { s = x * x * x + 2 * x * y - y * y + (x - y) * (x + y) - x * 3; } return s; }\n";
+
+static double Measure(ScriptFunction& ftn, Literal x, Literal y, int n, Literal& ret)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	ret = ftn(x, y, n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+static void Compare(const char* name, Literal x, Literal y, int n, int rounds)
+{
+	double bestSlow = 0.0, bestFast = 0.0;
+	for (int round = 1; round <= rounds; ++round)
+	{
+		// a program that was just loaded has no hot signature, so the first call runs the generic body
+		ScriptHost host;
+		if (!host.Load(source, "specialize")) return;
+		ScriptFunction poly = host.Function("poly");
+
+		Literal generic, specialized;
+		double slow = Measure(poly, x, y, n, generic);
+		for (int i = 0; i < TypeProfile::HOT; ++i) poly(x, y, 1);
+		double fast = Measure(poly, x, y, n, specialized);
+
+		printf("%s round %d  generic %8.1f ns  specialized %8.1f ns  %5.2fx%s\n", name, round, slow, fast, slow / fast,
+			generic.Equals(specialized) ? "" : "  results differ");
+		if (1 == round || slow < bestSlow) bestSlow = slow;
+		if (1 == round || fast < bestFast) bestFast = fast;
+	}
+	printf("%s best     generic %8.1f ns  specialized %8.1f ns  %5.2fx\n", name, bestSlow, bestFast, bestSlow / bestFast);
+}
+
+int main()
+{
+	const int n = 20000;
+	Compare("i32", 3, 7, n, 5);
+	Compare("f32", 0.5, 7.5, n, 5);
+	return 0;
+}
@@ -0,0 +1,31 @@
+// cost of a tail recursive step compared to a loop iteration
+#include <chrono>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def iterate(n) { i32 acc = 0; while n > 0 { acc = acc + 1; n = n - 1; } return acc; }\n"
+	"def recurse(n, acc) { if n == 0 { return acc; } return recurse(n - 1, acc + 1); }\n";
+
+static double Measure(ScriptFunction& ftn, int n, bool acc)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	if (acc) ftn(n, 0); else ftn(n);
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() / n;
+}
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "tail_calls")) return 1;
+
+	ScriptFunction iterate = host.Function("iterate");
+	ScriptFunction recurse = host.Function("recurse");
+
+	// far deeper than the C++ stack would allow without tail calls
+	const int n = 200000;
+	printf("loop iteration %10.1f ns\n", Measure(iterate, n, false));
+	printf("tail call      %10.1f ns\n", Measure(recurse, n, true));
+	return 0;
+}
@@ -0,0 +1,50 @@
+// throughput of independent interpreters, one per thread
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"def step(n) {\n"
+	"    f32 acc = 0.0;\n"
+	"    vec<f32> r = rand(16);\n"
+	"    for i in 0..n { acc = acc + sqrt(i * 1.0) + r[i % 16]; }\n"
+	"    return acc;\n"
+	"}\n";
+
+static double Run(int threads, int callsPerThread)
+{
+	auto t0 = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (int t = 0; t < threads; ++t)
+	{
+		pool.emplace_back([callsPerThread]()
+		{
+			ScriptHost host;
+			host.Load(source, "threads");
+			ScriptFunction step = host.Function("step");
+			for (int i = 0; i < callsPerThread; ++i) step(1000);
+		});
+	}
+	for (auto& t : pool) t.join();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main()
+{
+	const int calls = 50;
+	int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	double base = 0;
+	printf("%8s %12s %12s\n", "threads", "calls/s", "scaling");
+	for (int n = 1; n <= std::max(4, maxThreads); n *= 2)
+	{
+		double secs = Run(n, calls);
+		double rate = n * calls / secs;
+		if (1 == n) base = rate;
+		printf("%8d %12.1f %11.2fx\n", n, rate, rate / base);
+	}
+	return 0;
+}
@@ -0,0 +1,45 @@
+// frame budget for a long update, slice lengths and the cost of running sliced
+#include <chrono>
+#include <algorithm>
+#include <stdio.h>
+
+#include "ScriptHost.h"
+
+static const char* source =
+	"vec<f32> cells = [0.0; 4000];\n"
+	"def step(i) { return cells[i] + 1.0; }\n"
+	"def update() { for k in 0..5 { for i in 0..len(cells) { cells[i] = step(i); } } return cells[0]; }\n";
+
+typedef std::chrono::steady_clock Clock;
+
+static double Ms(Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); }
+
+int main()
+{
+	ScriptHost host;
+	if (!host.Load(source, "time_slice")) return 1;
+	ScriptFunction update = host.Function("update");
+
+	auto t0 = Clock::now();
+	update();
+	printf("direct call     %8.2f ms\n", Ms(t0));
+
+	for (int budget = 1000; budget <= 8000; budget *= 2)
+	{
+		int frames = 0;
+		double longest = 0;
+		t0 = Clock::now();
+		ScriptTask task = update.Start();
+		while (true)
+		{
+			auto f0 = Clock::now();
+			bool done = task.Run(std::chrono::microseconds(budget));
+			longest = std::max(longest, Ms(f0));
+			frames++;
+			if (done) break;
+		}
+		printf("budget %5d us %8.2f ms total, %4d frames, longest slice %6.2f ms, result %.0f\n",
+			budget, Ms(t0), frames, longest, task.Result().DoubleValue());
+	}
+	return 0;
+}
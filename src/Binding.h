@@ -0,0 +1,247 @@
+#ifndef BINDING_H
+#define BINDING_H
+
+#include <string>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <stdio.h>
+
+#include "Environment.h"
+#include "Literal.h"
+#include "Output.h"
+
+// Template glue between native C++ functions and script callables.
+//
+//     Bind(globals, "sqrt", [](double x) { return sqrt(x); }, nspace);
+//
+// The arity and the conversion of every argument are deduced from the
+// function signature, so each binding gets exactly one type check per
+// argument and reads the arguments straight out of the caller's list.
+
+
+// conversion from a script value to a native argument type, specialize to add new types
+template <typename T> struct ArgConv;
+
+template <> struct ArgConv<int32_t>
+{
+	static const char* Name() { return "i32"; }
+	static bool Check(const Literal& v) { return v.IsNumeric(); }
+	static int32_t Get(const Literal& v) { return v.IntValue(); }
+};
+
+template <> struct ArgConv<double>
+{
+	static const char* Name() { return "f32"; }
+	static bool Check(const Literal& v) { return v.IsNumeric(); }
+	static double Get(const Literal& v) { return v.DoubleValue(); }
+};
+
+template <> struct ArgConv<float>
+{
+	static const char* Name() { return "f32"; }
+	static bool Check(const Literal& v) { return v.IsNumeric(); }
+	static float Get(const Literal& v) { return float(v.DoubleValue()); }
+};
+
+template <> struct ArgConv<bool>
+{
+	static const char* Name() { return "bool"; }
+	static bool Check(const Literal& v) { return v.IsBool(); }
+	static bool Get(const Literal& v) { return v.BoolValue(); }
+};
+
+template <> struct ArgConv<std::string>
+{
+	static const char* Name() { return "string"; }
+	static bool Check(const Literal& v) { return v.IsString(); }
+	static std::string Get(const Literal& v) { return v.StringValue(); }
+};
+
+template <> struct ArgConv<EnumLiteral>
+{
+	static const char* Name() { return "enum"; }
+	static bool Check(const Literal& v) { return v.IsEnum(); }
+	static EnumLiteral Get(const Literal& v) { return v.EnumValue(); }
+};
+
+template <> struct ArgConv<std::vector<int32_t> >
+{
+	static const char* Name() { return "vec<i32>"; }
+	static bool Check(const Literal& v) { return v.IsVector() && v.IsVecInteger(); }
+	static std::vector<int32_t> Get(const Literal& v) { return v.VecValue_I(); }
+};
+
+template <> struct ArgConv<std::vector<std::string> >
+{
+	static const char* Name() { return "vec<string>"; }
+	static bool Check(const Literal& v) { return v.IsVector() && v.IsVecString(); }
+	static std::vector<std::string> Get(const Literal& v) { return v.VecValue_S(); }
+};
+
+template <> struct ArgConv<std::shared_ptr<Channel> >
+{
+	static const char* Name() { return "channel"; }
+	static bool Check(const Literal& v) { return v.IsChannel(); }
+	static const std::shared_ptr<Channel>& Get(const Literal& v) { return v.ChannelValue(); }
+};
+
+template <> struct ArgConv<std::shared_ptr<Generator> >
+{
+	static const char* Name() { return "generator"; }
+	static bool Check(const Literal& v) { return v.IsGenerator(); }
+	static const std::shared_ptr<Generator>& Get(const Literal& v) { return v.GeneratorValue(); }
+};
+
+template <> struct ArgConv<std::shared_ptr<std::string> >
+{
+	static const char* Name() { return "strbuf"; }
+	static bool Check(const Literal& v) { return v.IsStrbuf(); }
+	static const std::shared_ptr<std::string>& Get(const Literal& v) { return v.StrbufValue(); }
+};
+
+// untyped parameter, the binding inspects the value itself
+template <> struct ArgConv<Literal>
+{
+	static const char* Name() { return "any"; }
+	static bool Check(const Literal&) { return true; }
+	static const Literal& Get(const Literal& v) { return v; }
+};
+
+#ifndef NO_RAYLIB
+// raylib custom
+template <> struct ArgConv<Font>
+{
+	static const char* Name() { return "font"; }
+	static bool Check(const Literal& v) { return v.IsFont(); }
+	static const Font& Get(const Literal& v) { return v.FontValue(); }
+};
+
+template <> struct ArgConv<Image>
+{
+	static const char* Name() { return "image"; }
+	static bool Check(const Literal& v) { return v.IsImage(); }
+	static const Image& Get(const Literal& v) { return v.ImageValue(); }
+};
+
+// render textures are accepted wherever a texture is expected
+template <> struct ArgConv<Texture2D>
+{
+	static const char* Name() { return "texture"; }
+	static bool Check(const Literal& v) { return v.IsTexture() || v.IsRenderTexture2D(); }
+	static const Texture2D& Get(const Literal& v) { return v.IsTexture() ? v.TextureValue() : v.RenderTexture2dValue().texture; }
+};
+
+template <> struct ArgConv<RenderTexture2D>
+{
+	static const char* Name() { return "render texture"; }
+	static bool Check(const Literal& v) { return v.IsRenderTexture2D(); }
+	static const RenderTexture2D& Get(const Literal& v) { return v.RenderTexture2dValue(); }
+};
+
+template <> struct ArgConv<Sound>
+{
+	static const char* Name() { return "sound"; }
+	static bool Check(const Literal& v) { return v.IsSound(); }
+	static const Sound& Get(const Literal& v) { return v.SoundValue(); }
+};
+
+template <> struct ArgConv<Shader>
+{
+	static const char* Name() { return "shader"; }
+	static bool Check(const Literal& v) { return v.IsShader(); }
+	static const Shader& Get(const Literal& v) { return v.ShaderValue(); }
+};
+#endif
+
+
+// conversion from a native return value to a script value
+template <typename T> inline Literal ReturnConv(const T& v) { return Literal(v); }
+inline Literal ReturnConv(float v) { return Literal(double(v)); }
+inline Literal ReturnConv(uint8_t v) { return Literal(int32_t(v)); }
+inline Literal ReturnConv(const Literal& v) { return v; }
+
+
+// deduce the signature of function pointers and non-generic lambdas
+template <typename F> struct FunctionTraits : FunctionTraits<decltype(&F::operator())> {};
+
+template <typename R, typename... A> struct FunctionTraits<R(*)(A...)>
+{
+	typedef R Return;
+	typedef std::tuple<typename std::decay<A>::type...> Args;
+	static constexpr size_t Arity = sizeof...(A);
+};
+
+template <typename C, typename R, typename... A> struct FunctionTraits<R(C::*)(A...) const> : FunctionTraits<R(*)(A...)> {};
+template <typename C, typename R, typename... A> struct FunctionTraits<R(C::*)(A...)> : FunctionTraits<R(*)(A...)> {};
+
+
+// the check a bound function makes on argument i, name is only used for the message
+template <typename T>
+inline bool CheckArgType(const Literal& v, size_t i, const char* name)
+{
+	if (ArgConv<T>::Check(v)) return true;
+	Output::Report("Invalid argument %d for '%s', expected %s but found '%s'.\n", int(i + 1), name, ArgConv<T>::Name(), v.ToString().c_str());
+	return false;
+}
+
+
+template <typename F>
+class NativeBinding
+{
+public:
+
+	NativeBinding(F ftn, const char* name) : m_ftn(ftn), m_name(name) {}
+
+	Literal operator()(const LiteralList& args) const
+	{
+		typedef typename FunctionTraits<F>::Args Args;
+		return Invoke(args, (Args*)nullptr, std::make_index_sequence<FunctionTraits<F>::Arity>());
+	}
+
+private:
+
+	template <typename T>
+	bool CheckArg(const Literal& v, size_t i) const { return CheckArgType<T>(v, i, m_name); }
+
+	template <typename... A, size_t... I>
+	Literal Invoke(const LiteralList& args, std::tuple<A...>*, std::index_sequence<I...>) const
+	{
+		if (!(true && ... && CheckArg<A>(args[I], I))) return Literal();
+
+		if constexpr (std::is_void<typename FunctionTraits<F>::Return>::value)
+		{
+			m_ftn(ArgConv<A>::Get(args[I])...);
+			return Literal();
+		}
+		else
+		{
+			return ReturnConv(m_ftn(ArgConv<A>::Get(args[I])...));
+		}
+	}
+
+	F m_ftn;
+	const char* m_name;
+};
+
+
+// wrap a native function into a script callable, name is only used for error messages
+template <typename F>
+Literal MakeNative(const char* name, F ftn, std::string fqns)
+{
+	Literal ret;
+	ret.SetCallable(FunctionTraits<F>::Arity, NativeBinding<F>(ftn, name), fqns);
+	return ret;
+}
+
+// wrap a native function and define it in the given namespace
+template <typename F>
+void Bind(Environment* env, const char* name, F ftn, std::string fqns, IntrinsicTypeEnum intrinsic = INTRINSIC_NONE)
+{
+	Literal ret = MakeNative(name, ftn, fqns);
+	ret.SetIntrinsic(intrinsic);
+	env->Define(name, ret, fqns);
+}
+
+#endif
@@ -0,0 +1,428 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+#include "Literal.h"
+#include "Environment.h"
+
+
+// a value flattened for another interpreter, channel handles travel next to the bytes
+struct Message
+{
+	std::string data;
+	std::vector<std::shared_ptr<Channel> > channels;
+};
+
+
+// Bounded multi producer, multi consumer queue of messages between interpreters
+// on different threads. Every cell carries a sequence number that tells senders
+// and receivers whose turn it is, so neither side ever takes a lock.
+//
+// Values are packed on send and rebuilt on receive, vectors, maps and struct
+// instances arrive as copies that share nothing with the sender. Struct types
+// are matched by name and namespace in the receiving interpreter.
+class Channel
+{
+public:
+
+	// capacity is rounded up to a power of two
+	Channel(size_t capacity)
+	{
+		size_t n = 2;
+		while (n < capacity) n <<= 1;
+
+		m_mask = n - 1;
+		m_cells.reset(new Cell[n]);
+		for (size_t i = 0; i < n; ++i) m_cells[i].sequence.store(i, std::memory_order_relaxed);
+		m_send.store(0, std::memory_order_relaxed);
+		m_recv.store(0, std::memory_order_relaxed);
+	}
+
+	size_t Capacity() const { return m_mask + 1; }
+
+	// messages waiting, only a hint while other threads are using the channel
+	size_t Size() const
+	{
+		size_t s = m_send.load(std::memory_order_relaxed);
+		size_t r = m_recv.load(std::memory_order_relaxed);
+		return s > r ? s - r : 0;
+	}
+
+	// false when the channel is full, msg is left untouched then
+	bool TrySend(Message& msg)
+	{
+		Cell* cell;
+		size_t pos = m_send.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[pos & m_mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = intptr_t(seq) - intptr_t(pos);
+			if (0 == dif)
+			{
+				if (m_send.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (dif < 0) return false;
+			else pos = m_send.load(std::memory_order_relaxed);
+		}
+
+		cell->message = std::move(msg);
+		cell->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// false when the channel is empty
+	bool TryRecv(Message& msg)
+	{
+		Cell* cell;
+		size_t pos = m_recv.load(std::memory_order_relaxed);
+		while (true)
+		{
+			cell = &m_cells[pos & m_mask];
+			size_t seq = cell->sequence.load(std::memory_order_acquire);
+			intptr_t dif = intptr_t(seq) - intptr_t(pos + 1);
+			if (0 == dif)
+			{
+				if (m_recv.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+			}
+			else if (dif < 0) return false;
+			else pos = m_recv.load(std::memory_order_relaxed);
+		}
+
+		msg = std::move(cell->message);
+		cell->message = Message();
+		cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	// blocking versions spin briefly and then sleep, a waiting frame loop should use the Try calls
+	void Send(Message& msg)
+	{
+		for (int spins = 0; !TrySend(msg); ++spins) Backoff(spins);
+	}
+
+	void Recv(Message& msg)
+	{
+		for (int spins = 0; !TryRecv(msg); ++spins) Backoff(spins);
+	}
+
+
+	// flatten a value, false for values that only make sense in their own interpreter (functions, raylib handles)
+	static bool Pack(const Literal& value, Message& msg)
+	{
+		std::string& out = msg.data;
+		LiteralTypeEnum type = value.GetType();
+		PutU8(out, uint8_t(type));
+
+		switch (type)
+		{
+		case LITERAL_TYPE_INVALID: return true;
+		case LITERAL_TYPE_DOUBLE: Put(out, value.DoubleValue()); return true;
+		case LITERAL_TYPE_INTEGER: Put(out, value.IntValue()); return true;
+		case LITERAL_TYPE_BOOL: PutU8(out, value.BoolValue()); return true;
+		case LITERAL_TYPE_STRING: PutString(out, value.StringRef()); return true;
+		case LITERAL_TYPE_ENUM: PutString(out, value.EnumRef()); return true;
+		case LITERAL_TYPE_RANGE: Put(out, value.LeftValue()); Put(out, value.RightValue()); return true;
+		case LITERAL_TYPE_PAIR:
+		{
+			std::pair<Literal, Literal> p = value.PairValue();
+			return Pack(p.first, msg) && Pack(p.second, msg);
+		}
+
+		case LITERAL_TYPE_CHANNEL:
+			Put(out, uint32_t(msg.channels.size()));
+			msg.channels.push_back(value.ChannelValue());
+			return true;
+
+		case LITERAL_TYPE_VEC:
+		{
+			LiteralTypeEnum vecType = value.GetVecType();
+			uint32_t n = uint32_t(value.Len());
+			PutU8(out, uint8_t(vecType));
+			Put(out, n);
+
+			if (LITERAL_TYPE_INTEGER == vecType) PutBytes(out, value.VecRef_I().data(), n * sizeof(int32_t));
+			else if (LITERAL_TYPE_DOUBLE == vecType) PutBytes(out, value.VecRef_D().data(), n * sizeof(double));
+			else
+			{
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					if (LITERAL_TYPE_BOOL == vecType) PutU8(out, value.VecValueAt_B(i));
+					else if (LITERAL_TYPE_STRING == vecType) PutString(out, value.VecValueAt_S(i));
+					else if (LITERAL_TYPE_ENUM == vecType) PutString(out, value.VecValueAt_E(i).enumValue);
+					else if (!Pack(value.VecValueAt_U(i), msg)) return false;
+				}
+			}
+			return true;
+		}
+
+		case LITERAL_TYPE_MAP:
+		{
+			const MapLiteral& m = value.MapRef();
+			PutU8(out, uint8_t(m.keyType));
+			PutU8(out, uint8_t(m.valueType));
+			if (LITERAL_TYPE_INTEGER == m.keyType)
+			{
+				Put(out, uint32_t(m.intMap.size()));
+				for (auto& kv : m.intMap)
+				{
+					Put(out, int32_t(kv.first));
+					if (!Pack(*kv.second, msg)) return false;
+				}
+			}
+			else
+			{
+				const std::map<std::string, std::shared_ptr<Literal> >& sm = LITERAL_TYPE_ENUM == m.keyType ? m.enumMap : m.stringMap;
+				Put(out, uint32_t(sm.size()));
+				for (auto& kv : sm)
+				{
+					PutString(out, kv.first);
+					if (!Pack(*kv.second, msg)) return false;
+				}
+			}
+			return true;
+		}
+
+		case LITERAL_TYPE_TT_STRUCT:
+		{
+			if (!value.IsInstance()) return false;
+			const std::map<std::string, Literal>& params = value.Parameters();
+			PutString(out, value.FQNS());
+			PutString(out, value.StructName());
+			Put(out, uint32_t(params.size()));
+			for (auto& kv : params)
+			{
+				PutString(out, kv.first);
+				if (!Pack(kv.second, msg)) return false;
+			}
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	// rebuild the next value of msg starting at pos, struct types are looked up in globals
+	static bool Unpack(Environment* globals, const Message& msg, size_t& pos, Literal& value)
+	{
+		const std::string& in = msg.data;
+		uint8_t type;
+		if (!GetU8(in, pos, type)) return false;
+
+		switch (LiteralTypeEnum(type))
+		{
+		case LITERAL_TYPE_INVALID: value = Literal(); return true;
+
+		case LITERAL_TYPE_DOUBLE:
+		{
+			double d;
+			if (!Get(in, pos, d)) return false;
+			value = Literal(d);
+			return true;
+		}
+
+		case LITERAL_TYPE_INTEGER:
+		{
+			int32_t i;
+			if (!Get(in, pos, i)) return false;
+			value = Literal(i);
+			return true;
+		}
+
+		case LITERAL_TYPE_BOOL:
+		{
+			uint8_t b;
+			if (!GetU8(in, pos, b)) return false;
+			value = Literal(bool(b));
+			return true;
+		}
+
+		case LITERAL_TYPE_STRING:
+		case LITERAL_TYPE_ENUM:
+		{
+			std::string s;
+			if (!GetString(in, pos, s)) return false;
+			if (LITERAL_TYPE_ENUM == type) value = Literal(EnumLiteral(s));
+			else value = Literal(std::move(s));
+			return true;
+		}
+
+		case LITERAL_TYPE_RANGE:
+		{
+			int32_t l, r;
+			if (!Get(in, pos, l) || !Get(in, pos, r)) return false;
+			value = Literal(l, r);
+			return true;
+		}
+
+		case LITERAL_TYPE_PAIR:
+		{
+			Literal k, v;
+			if (!Unpack(globals, msg, pos, k) || !Unpack(globals, msg, pos, v)) return false;
+			value = Literal(k, v);
+			return true;
+		}
+
+		case LITERAL_TYPE_CHANNEL:
+		{
+			uint32_t idx;
+			if (!Get(in, pos, idx) || idx >= msg.channels.size()) return false;
+			value = Literal(msg.channels[idx]);
+			return true;
+		}
+
+		case LITERAL_TYPE_VEC:
+		{
+			uint8_t vecType;
+			uint32_t n;
+			if (!GetU8(in, pos, vecType) || !Get(in, pos, n)) return false;
+
+			if (LITERAL_TYPE_INTEGER == vecType)
+			{
+				std::vector<int32_t> v(n);
+				if (!GetBytes(in, pos, v.data(), n * sizeof(int32_t))) return false;
+				value = Literal(std::move(v));
+			}
+			else if (LITERAL_TYPE_DOUBLE == vecType)
+			{
+				std::vector<double> v(n);
+				if (!GetBytes(in, pos, v.data(), n * sizeof(double))) return false;
+				value = Literal(std::move(v));
+			}
+			else if (LITERAL_TYPE_BOOL == vecType)
+			{
+				std::vector<bool> v(n);
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					uint8_t b;
+					if (!GetU8(in, pos, b)) return false;
+					v[i] = b;
+				}
+				value = Literal(std::move(v));
+			}
+			else if (LITERAL_TYPE_STRING == vecType || LITERAL_TYPE_ENUM == vecType)
+			{
+				std::vector<std::string> v(n);
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					if (!GetString(in, pos, v[i])) return false;
+				}
+				if (LITERAL_TYPE_STRING == vecType) value = Literal(std::move(v));
+				else value = Literal(std::vector<EnumLiteral>(v.begin(), v.end()));
+			}
+			else
+			{
+				std::vector<Literal> v(n);
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					if (!Unpack(globals, msg, pos, v[i])) return false;
+				}
+				value = Literal(std::move(v), LiteralTypeEnum(vecType));
+			}
+			return true;
+		}
+
+		case LITERAL_TYPE_MAP:
+		{
+			uint8_t keyType, valueType;
+			uint32_t n;
+			if (!GetU8(in, pos, keyType) || !GetU8(in, pos, valueType) || !Get(in, pos, n)) return false;
+
+			MapLiteral m((LiteralTypeEnum)keyType, (LiteralTypeEnum)valueType);
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				int32_t ikey;
+				std::string skey;
+				if (LITERAL_TYPE_INTEGER == keyType ? !Get(in, pos, ikey) : !GetString(in, pos, skey)) return false;
+
+				std::shared_ptr<Literal> v = std::make_shared<Literal>();
+				if (!Unpack(globals, msg, pos, *v)) return false;
+
+				if (LITERAL_TYPE_INTEGER == keyType) m.intMap[ikey] = v;
+				else if (LITERAL_TYPE_ENUM == keyType) m.enumMap[skey] = v;
+				else m.stringMap[skey] = v;
+			}
+			value = Literal(std::move(m));
+			return true;
+		}
+
+		case LITERAL_TYPE_TT_STRUCT:
+		{
+			std::string fqns, name;
+			uint32_t n;
+			if (!GetString(in, pos, fqns) || !GetString(in, pos, name) || !Get(in, pos, n)) return false;
+
+			std::map<std::string, Literal> params;
+			for (uint32_t i = 0; i < n; ++i)
+			{
+				std::string field;
+				if (!GetString(in, pos, field) || !Unpack(globals, msg, pos, params[field])) return false;
+			}
+
+			Token token(TOKEN_IDENTIFIER, name, 0, "channel");
+			bool isGlobal = false;
+			Literal* def = globals->Lookup(&token, fqns, isGlobal);
+			if (!def || !def->IsStructDef()) return false;
+
+			value = def->Instance(std::move(params));
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+private:
+
+	struct alignas(64) Cell
+	{
+		std::atomic<size_t> sequence;
+		Message message;
+	};
+
+	static void Backoff(int spins)
+	{
+		if (spins < 64) std::this_thread::yield();
+		else std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	static void PutBytes(std::string& out, const void* p, size_t n) { out.append((const char*)p, n); }
+	static void PutU8(std::string& out, uint8_t v) { out.push_back(char(v)); }
+	static void PutString(std::string& out, const std::string& s) { Put(out, uint32_t(s.size())); out.append(s); }
+	template <typename T> static void Put(std::string& out, T v) { PutBytes(out, &v, sizeof(T)); }
+
+	static bool GetBytes(const std::string& in, size_t& pos, void* p, size_t n)
+	{
+		if (in.size() - pos < n) return false;
+		if (n) memcpy(p, in.data() + pos, n);
+		pos += n;
+		return true;
+	}
+	static bool GetU8(const std::string& in, size_t& pos, uint8_t& v) { return GetBytes(in, pos, &v, 1); }
+	static bool GetString(const std::string& in, size_t& pos, std::string& s)
+	{
+		uint32_t n;
+		if (!Get(in, pos, n) || in.size() - pos < n) return false;
+		s.assign(in, pos, n);
+		pos += n;
+		return true;
+	}
+	template <typename T> static bool Get(const std::string& in, size_t& pos, T& v) { return GetBytes(in, pos, &v, sizeof(T)); }
+
+	std::unique_ptr<Cell[]> m_cells;
+	size_t m_mask;
+	alignas(64) std::atomic<size_t> m_send;
+	alignas(64) std::atomic<size_t> m_recv;
+};
+
+#endif // CHANNEL_H
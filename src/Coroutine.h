@@ -0,0 +1,228 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <functional>
+#include <memory>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#include "Literal.h"
+
+class Interpreter;
+
+
+// A function running on its own stack that can be suspended part way and
+// continued later. Switching is a register swap, so the interpreter's C++
+// call stack at the suspension point, and with it every script local, stays
+// exactly as it was. The stack sits above a guard page, and script calls
+// stop with an error once less than STACK_RESERVE of it is left, see
+// StackLow, so deep recursion is reported rather than crashing.
+class Coroutine
+{
+public:
+	typedef std::function<void()> Body;
+
+	// the stack is only reserved, pages are committed by the OS as they are touched
+	static const size_t STACK_SIZE = 16 * 1024 * 1024;
+
+	// left for natives and the interpreter below the deepest script call
+	static const size_t STACK_RESERVE = 256 * 1024;
+
+	Coroutine(Body body) : m_body(body), m_started(false), m_running(false), m_done(false), m_limit(nullptr)
+	{
+#ifdef _WIN32
+		m_fiber = nullptr;
+		m_caller = nullptr;
+#else
+		m_stack = nullptr;
+		m_mapped = 0;
+#endif
+	}
+
+	~Coroutine()
+	{
+#ifdef _WIN32
+		if (m_fiber) DeleteFiber(m_fiber);
+#else
+		if (m_stack) munmap(m_stack, m_mapped);
+#endif
+	}
+
+	// true when the running coroutine on this thread is close to the end of its stack
+	static bool StackLow()
+	{
+		char probe;
+		return Limit() && &probe < Limit();
+	}
+
+	bool Started() const { return m_started; }
+	bool Running() const { return m_running; }
+	bool Done() const { return m_done; }
+
+	// run until the body yields or returns
+	void Resume()
+	{
+		if (m_running || m_done) return;
+		m_running = true;
+		const char* outer = Limit();
+#ifdef _WIN32
+		if (!IsThreadAFiber()) ConvertThreadToFiber(nullptr);
+		m_caller = GetCurrentFiber();
+		if (!m_started) m_fiber = CreateFiberEx(64 * 1024, STACK_SIZE, 0, &FiberEntry, this);
+		if (!m_fiber)
+		{
+			m_running = false;
+			return;
+		}
+		m_started = true;
+		Limit() = m_limit;
+		SwitchToFiber(m_fiber);
+#else
+		if (!m_started)
+		{
+			// the lowest page is left inaccessible, running past the reserve faults instead of overwriting memory
+			size_t page = size_t(sysconf(_SC_PAGESIZE));
+			m_mapped = STACK_SIZE + page;
+			void* stack = mmap(nullptr, m_mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (MAP_FAILED == stack || 0 != mprotect(stack, page, PROT_NONE))
+			{
+				if (MAP_FAILED != stack) munmap(stack, m_mapped);
+				m_running = false;
+				return;
+			}
+			m_stack = (char*)stack;
+			m_limit = m_stack + page + STACK_RESERVE;
+
+			getcontext(&m_context);
+			m_context.uc_stack.ss_sp = m_stack + page;
+			m_context.uc_stack.ss_size = STACK_SIZE;
+			m_context.uc_link = nullptr;
+
+			// makecontext only passes ints
+			uintptr_t self = uintptr_t(this);
+			makecontext(&m_context, (void(*)())&ContextEntry, 2, unsigned(self >> 32), unsigned(self & 0xffffffff));
+		}
+		m_started = true;
+		Limit() = m_limit;
+		swapcontext(&m_caller, &m_context);
+#endif
+		Limit() = outer;
+		m_running = false;
+	}
+
+	// back to the Resume call, only from inside the body
+	void Yield()
+	{
+#ifdef _WIN32
+		SwitchToFiber(m_caller);
+#else
+		swapcontext(&m_context, &m_caller);
+#endif
+	}
+
+private:
+
+	// lowest address script calls may reach on the running coroutine, nullptr on a thread's own stack
+	static const char*& Limit()
+	{
+		thread_local const char* limit = nullptr;
+		return limit;
+	}
+
+	// the body must not throw, nothing above this frame could catch it
+	void Run()
+	{
+		m_body();
+		m_done = true;
+		Yield();
+	}
+
+#ifdef _WIN32
+	static void CALLBACK FiberEntry(void* self)
+	{
+		// the fiber's stack ends STACK_SIZE below its first frame
+		char top;
+		Coroutine* c = (Coroutine*)self;
+		c->m_limit = &top - STACK_SIZE + STACK_RESERVE;
+		Limit() = c->m_limit;
+		c->Run();
+	}
+
+	void* m_fiber;
+	void* m_caller;
+#else
+	static void ContextEntry(unsigned hi, unsigned lo) { ((Coroutine*)((uintptr_t(hi) << 32) | uintptr_t(lo)))->Run(); }
+
+	char* m_stack;
+	size_t m_mapped;
+	ucontext_t m_context;
+	ucontext_t m_caller;
+#endif
+
+	Body m_body;
+	bool m_started;
+	bool m_running;
+	bool m_done;
+	const char* m_limit;
+};
+
+
+// script side of a def that contains yield, calling it returns one of these,
+// also runs the time sliced calls of Interpreter::RunSlice
+class Generator
+{
+public:
+
+	// body runs the function and returns its return value
+	Generator(Interpreter* interpreter, std::function<Literal()> body) : m_interpreter(interpreter), m_cancel(false),
+		m_coroutine([this, body]()
+		{
+			try
+			{
+				m_value = body();
+			}
+			catch (...)
+			{
+				// unwound by the destructor
+			}
+		})
+	{
+	}
+
+	// a suspended body is unwound so its scopes are released
+	~Generator();
+
+	bool Done() const { return m_coroutine.Done(); }
+	bool Running() const { return m_coroutine.Running(); }
+	const Literal& Value() const { return m_value; }
+
+	// continue up to the next yield, returns the yielded value or the final return value
+	Literal Resume();
+
+	// used by Interpreter, see Interpreter::Resume
+	void Switch() { m_coroutine.Resume(); }
+
+	// suspend at a yield, false when the generator is being destroyed and the body has to unwind
+	bool Yield(const Literal& value)
+	{
+		m_value = value;
+		m_coroutine.Yield();
+		return !m_cancel;
+	}
+
+private:
+
+	Interpreter* m_interpreter;
+	Literal m_value;
+	bool m_cancel;
+	Coroutine m_coroutine;
+};
+
+#endif // COROUTINE_H
@@ -25,6 +25,10 @@ enum TokenTypeEnum
 	TOKEN_STAR,
 	TOKEN_PERCENT,
 	TOKEN_AT,
+	TOKEN_AMPERSAND,
+	TOKEN_PIPE,
+	TOKEN_CARET,
+	TOKEN_TILDE,
 
 	// one or two character tokens
 	TOKEN_BANG,
@@ -35,6 +39,16 @@ enum TokenTypeEnum
 	TOKEN_GREATER_EQUAL,
 	TOKEN_LESS,
 	TOKEN_LESS_EQUAL,
+	TOKEN_LESS_LESS,
+	TOKEN_GREATER_GREATER,
+	TOKEN_ARROW,
+	TOKEN_PLUS_EQUAL,
+	TOKEN_MINUS_EQUAL,
+	TOKEN_STAR_EQUAL,
+	TOKEN_SLASH_EQUAL,
+	TOKEN_PERCENT_EQUAL,
+	TOKEN_PLUS_PLUS,
+	TOKEN_MINUS_MINUS,
 
 	// literals
 	TOKEN_IDENTIFIER,
@@ -69,8 +83,10 @@ enum TokenTypeEnum
 	TOKEN_BREAK,
 	TOKEN_CONTINUE,
 	TOKEN_LOOP,
+	TOKEN_MATCH,
 	TOKEN_DEF,
 	TOKEN_RETURN,
+	TOKEN_YIELD,
 	TOKEN_STRUCT,
 	TOKEN_PAIR,
 	TOKEN_INCLUDE,
@@ -111,6 +127,40 @@ enum ExpressionTypeEnum
 	EXPRESSION_FUNCTOR,
 	EXPRESSION_FORMAT,
 	EXPRESSION_PAIR,
+	EXPRESSION_INTRINSIC,
+	EXPRESSION_REF,
+	EXPRESSION_COMPOUND,
+	EXPRESSION_CONCAT,
+};
+
+// builtins the parser can lower to dedicated nodes
+enum IntrinsicTypeEnum
+{
+	INTRINSIC_NONE,
+	INTRINSIC_LEN,
+	INTRINSIC_MIN,
+	INTRINSIC_MAX,
+	INTRINSIC_SQRT,
+	INTRINSIC_SIN,
+	INTRINSIC_COS,
+	INTRINSIC_FLOOR,
+	INTRINSIC_FABS,
+	INTRINSIC_SGN,
+};
+
+// typed fast paths of a BinaryExpr in a specialized def body, see TypeProfile
+enum SpecOpEnum
+{
+	SPEC_NONE,
+	SPEC_ADD,
+	SPEC_SUB,
+	SPEC_MUL,
+	SPEC_DIV,
+	SPEC_MOD,
+	SPEC_LESS,
+	SPEC_LESS_EQUAL,
+	SPEC_GREATER,
+	SPEC_GREATER_EQUAL,
 };
 
 enum StatementTypeEnum
@@ -129,6 +179,10 @@ enum StatementTypeEnum
 	STATEMENT_DESTRUCT,
 	STATEMENT_RETURN,
 	STATEMENT_STRUCT,
+	STATEMENT_NATIVE_INCLUDE,
+	STATEMENT_PARALLEL_FOR,
+	STATEMENT_YIELD,
+	STATEMENT_MATCH,
 };
 
 #endif // ENUMS_H
\ No newline at end of file
@@ -2,11 +2,15 @@
 #define ENVIRONMENT_H
 
 #include <map>
+#include <set>
+#include <atomic>
 #include <string>
+#include <stdint.h>
 
 #include "Literal.h"
 #include "Token.h"
 #include "ErrorHandler.h"
+#include "Output.h"
 #include "Utility.h"
 
 class Environment
@@ -17,30 +21,54 @@ public:
 	{
 		m_errorHandler = errorHandler;
 		m_parent = nullptr;
+		m_root = this;
+		m_epoch = NextEpoch();
+		m_attached = false;
 	}
 
-	Environment(Environment* parent, ErrorHandler* errorHandler)
+	// a detached scope is not tracked by its parent, it has to be deleted by whoever
+	// created it, but creating one never writes to the parent so any thread can do it
+	Environment(Environment* parent, ErrorHandler* errorHandler, bool attach = true)
 	{
 		m_errorHandler = errorHandler;
 		m_parent = parent;
-		parent->m_children.push_back(this);
+		m_root = parent->m_root;
+		m_epoch = 0; // only the root's is read
+		m_attached = attach;
+		if (attach) parent->m_children.push_back(this);
 		m_scopeLabel = m_parent->m_nextScopeLabel;
 	}
 
+	// detached copy of the variables defined in this environment, payloads are
+	// shared copy on write so this only costs one map entry per variable
+	Environment* Snapshot(ErrorHandler* errorHandler) const
+	{
+		Environment* env = new Environment(errorHandler);
+		env->m_namespaces = m_namespaces;
+		env->m_globalNames = m_globalNames;
+		return env;
+	}
+
 	~Environment()
 	{
-		for (auto& p : m_parent->m_children)
+		if (m_attached)
 		{
-			if (p == this)
+			// scopes are normally destroyed in reverse order of creation, so search from the back
+			std::vector<Environment*>& siblings = m_parent->m_children;
+			for (size_t i = siblings.size(); i-- > 0; )
 			{
-				p = nullptr;
-				break;
+				if (siblings[i] == this)
+				{
+					siblings.erase(siblings.begin() + i);
+					break;
+				}
 			}
 		}
 
-		for (auto& p : m_children)
+		// each child removes itself from m_children
+		while (!m_children.empty())
 		{
-			if (p) delete p;
+			delete m_children.back();
 		}
 	}
 
@@ -72,12 +100,14 @@ public:
 
 		m_namespaces.clear();
 		m_namespaces = nsmap;
+		m_root->m_epoch = NextEpoch();
 		//m_fqns.clear();;
 		//m_scopeLabel.clear();
 		//m_nextScopeLabel.clear();
 	}
 
-	void Assign(std::string name, Literal value, Literal index, std::string fqns)
+	// value is moved into the variable's storage
+	void Assign(const std::string& name, Literal value, const Literal& index, const std::string& fqns)
 	{
 		//printf("Environment::Assign: %s, %s, %d\n", name.c_str(), value.ToString().c_str(), index);
 
@@ -87,11 +117,21 @@ public:
 			return;
 		}
 
+		if (!m_refs.empty())
+		{
+			auto ref = m_refs.find(name);
+			if (ref != m_refs.end())
+			{
+				Store(*ref->second, name, std::move(value), index);
+				return;
+			}
+		}
+
 		if (0 == m_namespaces.count(fqns))
 		{
 			if (m_parent)
 			{
-				m_parent->Assign(name, value, index, fqns);
+				m_parent->Assign(name, std::move(value), index, fqns);
 				return;
 			}
 
@@ -101,114 +141,23 @@ public:
 
 		VarMap& vars = m_namespaces.at(fqns).vars;
 
-		if (vars.count(name) != 0)
+		auto it = vars.find(name);
+		if (it != vars.end())
 		{
-			// check type
-			Literal& v = vars.at(name);
-			if (v.IsRange())
-			{
-				m_errorHandler->Error("", 0, "Unable to assign range.");
-			}
-			else
-			{
-				if (v.IsInt() && value.IsDouble()) value = Literal(int32_t(value.DoubleValue()));
-				if (v.IsDouble() && value.IsInt()) value = Literal(double(value.IntValue()));
-				if (v.GetType() == value.GetType())
-				{
-					v = value;
-				}
-				else if (v.IsMap())
-				{
-					LiteralTypeEnum keyType = v.GetMapKeyType();
-					if (index.GetType() == keyType)
-					{
-						MapLiteral mp = v.MapValue();
-						if (LITERAL_TYPE_INTEGER == keyType)
-						{
-							int idx = index.IntValue();
-							if (0 != mp.intMap.count(idx))
-							{
-								v.SetMapValueAt_I(std::shared_ptr<Literal>(new Literal(value)), idx);
-							}
-							else
-							{
-								m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
-							}
-						}
-						else if (LITERAL_TYPE_STRING == keyType)
-						{
-							std::string idx = index.StringValue();
-							if (0 != mp.stringMap.count(idx))
-							{
-								v.SetMapValueAt_S(std::shared_ptr<Literal>(new Literal(value)), idx);
-							}
-							else
-							{
-								m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
-							}
-						}
-						else if (LITERAL_TYPE_ENUM == keyType)
-						{
-							std::string idx = index.EnumValue().enumValue;
-							if (0 != mp.enumMap.count(idx))
-							{
-								v.SetMapValueAt_E(std::shared_ptr<Literal>(new Literal(value)), idx);
-							}
-							else
-							{
-								m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
-							}
-						}
-					}
-				}
-				else if (v.IsVector())
-				{
-					if (LITERAL_TYPE_INVALID == index.GetType())
-					{
-						m_errorHandler->Error("", 0, "No vector index provided.");
-					}
-					else
-					{
-						int idx = index.IntValue();
-						if (idx < v.Len() && idx != -1)
-						{
-							if (v.IsVecBool())
-								v.SetValueAt(value.BoolValue(), idx);
-							else if (v.IsVecInteger())
-								v.SetValueAt(value.IntValue(), idx);
-							else if (v.IsVecDouble())
-								v.SetValueAt(value.DoubleValue(), idx);
-							else if (v.IsVecString())
-								v.SetValueAt(value.StringValue(), idx);
-							else if (v.IsVecEnum())
-								v.SetValueAt(value.EnumValue(), idx);
-							else if (v.IsVecStruct())
-								v.SetValueAt(value, idx);
-						}
-						else
-						{
-							m_errorHandler->Error("", 0, "Vector index [" + std::to_string(idx) + "] out of bounds during assignment (Size: " + std::to_string(v.Len()) + ").");
-						}
-					}
-				}
-				else
-				{
-					m_errorHandler->Error("", 0, "Unable to cast between types during assignment (" + v.ToString() + ", " + value.ToString() + ").");
-				}
-			}
+			Store(it->second, name, std::move(value), index);
 			return;
 		}
 
 		if (m_parent)
 		{
-			m_parent->Assign(name, value, index, fqns);
+			m_parent->Assign(name, std::move(value), index, fqns);
 			return;
 		}
 
 		m_errorHandler->Error("", 0, "Undefined variable '" + name + "' in namespace '" + fqns + "'.");
 	}
 
-	void Define(std::string name, Literal value, std::string fqns, bool internal = false)
+	void Define(const std::string& name, Literal value, const std::string& fqns, bool internal = false)
 	{
 		if (std::string::npos != name.find_first_of("::"))
 		{
@@ -216,34 +165,44 @@ public:
 			return;
 		}
 
-		if (0 == m_namespaces.count(fqns))
-		{
-			var_struct vs;
-			m_namespaces.insert(std::make_pair(fqns, vs));
-		}
+		// a new local hides the reference parameter of the same name
+		if (!m_refs.empty()) m_refs.erase(name);
 
-		VarMap& vars = m_namespaces.at(fqns).vars;
-		PrivacyMap& privacy = m_namespaces.at(fqns).privacy;
+		var_struct& ns = m_namespaces[fqns];
+		VarMap& vars = ns.vars;
+		PrivacyMap& privacy = ns.privacy;
 
 		if (!value.IsRange())
 		{
+			// invalidate inline caches if this changes what a global name resolves to
+			if (this == m_root)
+			{
+				m_globalNames.insert(name);
+				m_epoch = NextEpoch();
+			}
+			else if (0 != m_root->m_globalNames.count(name))
+			{
+				m_root->m_epoch = NextEpoch();
+			}
+
 			// check for redefinition
-			if (vars.count(name) != 0)
+			auto it = vars.find(name);
+			if (it != vars.end())
 			{
-				if (vars.at(name).IsFunctionDef())
+				if (it->second.IsFunctionDef())
 				{
-					printf("Warning. Overwriting Function Definition for '%s'.", name.c_str());
+					Output::Report("Warning. Overwriting Function Definition for '%s'.", name.c_str());
 				}
-				else if (vars.at(name).IsStructDef())
+				else if (it->second.IsStructDef())
 				{
-					printf("Warning. Overwriting Struct Definition for '%s'.", name.c_str());
+					Output::Report("Warning. Overwriting Struct Definition for '%s'.", name.c_str());
 				}
-				vars.at(name) = value;
+				it->second = std::move(value);
 				privacy.at(name) = internal;
 			}
 			else
 			{
-				vars.insert(std::make_pair(name, value));
+				vars.emplace(name, std::move(value));
 				privacy.insert(std::make_pair(name, internal));
 			}
 		}
@@ -253,7 +212,23 @@ public:
 		}
 	}
 
+	// bind name to storage in an outer scope, the slot has to outlive this environment
+	void DefineRef(const std::string& name, Literal* slot)
+	{
+		if (0 != m_root->m_globalNames.count(name)) m_root->m_epoch = NextEpoch();
+		m_refs[name] = slot;
+	}
+
 	Literal Get(Token* token, std::string fqns)
+	{
+		bool isGlobal = false;
+		Literal* slot = Lookup(token, fqns, isGlobal);
+		if (slot) return *slot;
+		return Literal();
+	}
+
+	// find the storage for a variable, isGlobal is set when it lives in the root environment
+	Literal* Lookup(Token* token, std::string fqns, bool& isGlobal)
 	{
 		std::string name = token->Lexeme();
 		bool external_access = false;
@@ -281,10 +256,20 @@ public:
 			}
 		}
 
+		if (!external_access && !m_refs.empty())
+		{
+			auto ref = m_refs.find(name);
+			if (ref != m_refs.end())
+			{
+				isGlobal = false;
+				return ref->second;
+			}
+		}
+
 		// nothing here, go to parent
 		if (m_namespaces.empty() && m_parent)
 		{
-			return m_parent->Get(token, fqns);
+			return m_parent->Lookup(token, fqns, isGlobal);
 		}
 
 		// local search
@@ -322,31 +307,33 @@ public:
 
 			if (!found)
 			{
-				if (m_parent) return m_parent->Get(token, fqns);
+				if (m_parent) return m_parent->Lookup(token, fqns, isGlobal);
 
 				m_errorHandler->Error(token->Filename(), token->Line(), "Undefined variable '" + name + "' in namespace '" + fqns + "'.");
-				return Literal();
+				return nullptr;
 			}
 		}
 
 		if (external_access && 0 == fqns.compare(base_ns) && m_namespaces.at(fqns).privacy.at(name))
 		{
 			m_errorHandler->Error(token->Filename(), token->Line(), "Cannot access internal '" + name + "' from '" + fqns + "'.");
-			return Literal();
+			return nullptr;
 		}
 
 		VarMap& vars = m_namespaces.at(fqns).vars;
 
-		if (vars.count(name))
+		auto it = vars.find(name);
+		if (it != vars.end())
 		{
-			return vars.at(name);
+			isGlobal = (this == m_root);
+			return &it->second;
 		}
 
-		if (m_parent) return m_parent->Get(token, fqns);
+		if (m_parent) return m_parent->Lookup(token, fqns, isGlobal);
 
 		m_errorHandler->Error(token->Filename(), token->Line(), "Undefined variable '" + name + "' in namespace '" + fqns + "'.");
 
-		return Literal();
+		return nullptr;
 	}
 
 	/*void Print(std::string t = "")
@@ -375,8 +362,115 @@ public:
 		m_nextScopeLabel = label;
 	}
 
+	// bumped whenever a definition could change how a global name resolves
+	uint64_t Epoch() const { return m_root->m_epoch.load(std::memory_order_relaxed); }
+
+	// epochs are unique across every environment in the process, a cache filled against
+	// a destroyed root never matches a new one that reuses its address
+	static uint64_t NextEpoch()
+	{
+		static std::atomic<uint64_t> s_epoch(0);
+		return ++s_epoch;
+	}
+
 
 private:
+	// assignment into existing storage, whole values are cast to the stored type
+	void Store(Literal& v, const std::string& name, Literal value, const Literal& index)
+	{
+		if (v.IsRange())
+		{
+			m_errorHandler->Error("", 0, "Unable to assign range.");
+		}
+		else
+		{
+			if (v.IsInt() && value.IsDouble()) value = Literal(int32_t(value.DoubleValue()));
+			if (v.IsDouble() && value.IsInt()) value = Literal(double(value.IntValue()));
+			if (v.GetType() == value.GetType())
+			{
+				v = std::move(value);
+			}
+			else if (v.IsMap())
+			{
+				LiteralTypeEnum keyType = v.GetMapKeyType();
+				if (index.GetType() == keyType)
+				{
+					const MapLiteral& mp = v.MapRef();
+					if (LITERAL_TYPE_INTEGER == keyType)
+					{
+						int idx = index.IntValue();
+						if (0 != mp.intMap.count(idx))
+						{
+							v.SetMapValueAt_I(std::shared_ptr<Literal>(new Literal(value)), idx);
+						}
+						else
+						{
+							m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
+						}
+					}
+					else if (LITERAL_TYPE_STRING == keyType)
+					{
+						std::string idx = index.StringValue();
+						if (0 != mp.stringMap.count(idx))
+						{
+							v.SetMapValueAt_S(std::shared_ptr<Literal>(new Literal(value)), idx);
+						}
+						else
+						{
+							m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
+						}
+					}
+					else if (LITERAL_TYPE_ENUM == keyType)
+					{
+						std::string idx = index.EnumValue().enumValue;
+						if (0 != mp.enumMap.count(idx))
+						{
+							v.SetMapValueAt_E(std::shared_ptr<Literal>(new Literal(value)), idx);
+						}
+						else
+						{
+							m_errorHandler->Error("", 0, "Unable to map '" + name + " at index " + index.ToString() + ".");
+						}
+					}
+				}
+			}
+			else if (v.IsVector())
+			{
+				if (LITERAL_TYPE_INVALID == index.GetType())
+				{
+					m_errorHandler->Error("", 0, "No vector index provided.");
+				}
+				else
+				{
+					int idx = index.IntValue();
+					if (idx < v.Len() && idx != -1)
+					{
+						if (v.IsVecBool())
+							v.SetValueAt(value.BoolValue(), idx);
+						else if (v.IsVecInteger())
+							v.SetValueAt(value.IntValue(), idx);
+						else if (v.IsVecDouble())
+							v.SetValueAt(value.DoubleValue(), idx);
+						else if (v.IsVecString())
+							v.SetValueAt(value.StringValue(), idx);
+						else if (v.IsVecEnum())
+							v.SetValueAt(value.EnumValue(), idx);
+						else if (v.IsVecStruct())
+							v.SetValueAt(value, idx);
+					}
+					else
+					{
+						m_errorHandler->Error("", 0, "Vector index [" + std::to_string(idx) + "] out of bounds during assignment (Size: " + std::to_string(v.Len()) + ").");
+					}
+				}
+			}
+			else
+			{
+				m_errorHandler->Error("", 0, "Unable to cast between types during assignment (" + v.ToString() + ", " + value.ToString() + ").");
+			}
+		}
+	}
+
 	typedef std::map<std::string, Literal> VarMap;
 	typedef std::map<std::string, bool> PrivacyMap;
 	
@@ -388,12 +482,17 @@ private:
 	typedef std::map<std::string, var_struct> NameSpaceMap;
 
 	NameSpaceMap m_namespaces;
+	std::map<std::string, Literal*> m_refs;	// reference parameters, owned by the caller
 	//std::map<std::string, std::string> m_fqns;
 	std::string m_scopeLabel;
 	std::string m_nextScopeLabel;
 
 	ErrorHandler* m_errorHandler;
 	Environment* m_parent;
+	Environment* m_root;
+	std::atomic<uint64_t> m_epoch;		// atomic so scopes on parallel for workers can bump it
+	std::set<std::string> m_globalNames;
+	bool m_attached;
 	std::vector<Environment*> m_children;
 
 };
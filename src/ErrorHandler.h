@@ -3,17 +3,23 @@
 
 #include <string>
 #include <vector>
+#include <mutex>
 
+#include "Output.h"
+
+// errors can be reported from parallel for workers, so every access is locked
 class ErrorHandler
 {
 public:
 	void Clear()
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
 		if (!m_errorList.empty()) m_errorList.clear();
 	}
 
 	void Error(std::string filename, int line, std::string text)
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
 		if (m_errorList.size() > 10) return;
 
 		m_errorList.push_back(error_struct(filename, line, text));
@@ -24,6 +30,7 @@ public:
 
 	void Error(std::string filename, int line, std::string at, std::string text)
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
 		if (m_errorList.size() > 10) return;
 
 		m_errorList.push_back(error_struct(filename, line, at + ": " + text));
@@ -34,12 +41,17 @@ public:
 
 	bool HasErrors()
 	{
+		std::lock_guard<std::mutex> lock(m_mutex);
 		if (m_errorList.empty()) return false;
 		return true;
 	}
 
 	void Print()
 	{
+		// after whatever the script printed first
+		Output::Local().Flush();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
 		for (auto& e : m_errorList)
 		{
 			printf("File: %s, Line %d : %s\n", e.filename.c_str(), e.line, e.text.c_str());
@@ -56,6 +68,7 @@ private:
 	};
 
 	std::vector<error_struct> m_errorList;
+	std::mutex m_mutex;
 };
 
 #endif // ERROR_HANDLER_H
\ No newline at end of file
@@ -3,13 +3,28 @@
 
 #include <string>
 #include <cstdarg>
+#include <string.h>
 
 #include "Token.h"
 #include "Literal.h"
 
+class Environment;
+class VariableExpr;
+
+// remembers where a global name resolved to, valid while the owning
+// environment's definition epoch is unchanged
+struct GlobalCache
+{
+	Environment* env;
+	uint64_t epoch;
+	Literal* slot;
+	GlobalCache() : env(nullptr), epoch(0), slot(nullptr) {}
+};
+
 class Expr
 {
 public:
+	virtual ~Expr() {}
 	virtual ExpressionTypeEnum GetType() = 0;
 };
 
@@ -51,6 +66,7 @@ public:
 		m_left = left;
 		m_token = name;
 		m_right = right;
+		memset(m_spec, 0, sizeof(m_spec));
 	}
 
 	ExpressionTypeEnum GetType() { return EXPRESSION_BINARY; }
@@ -59,10 +75,20 @@ public:
 	Expr* Left() { return m_left; }
 	Expr* Right() { return m_right; }
 
+	// specializations of the enclosing def function, a SpecOpEnum with the operand types
+	static const int WAYS = 4;
+	static const uint8_t OP_MASK = 0x0f;
+	static const uint8_t LEFT_DOUBLE = 0x10;
+	static const uint8_t RIGHT_DOUBLE = 0x20;
+
+	uint8_t Spec(int way) { return m_spec[way]; }
+	void SetSpec(int way, uint8_t spec) { m_spec[way] = spec; }
+
 private:
 	Token* m_token;
 	Expr* m_left;
 	Expr* m_right;
+	uint8_t m_spec[WAYS];
 };
 
 
@@ -81,12 +107,38 @@ public:
 
 	Expr* GetCallee() { return m_callee; }
 	Token* Operator() { return m_token; }
-	ArgList GetArguments() { return m_arguments; }
+	const ArgList& GetArguments() { return m_arguments; }
+	GlobalCache& Cache() { return m_cache; }
 
 private:
 	Expr* m_callee;
 	Token* m_token;
 	ArgList m_arguments;
+	GlobalCache m_cache;
+};
+
+
+class IntrinsicExpr : public Expr
+{
+public:
+	IntrinsicExpr() = delete;
+	IntrinsicExpr(IntrinsicTypeEnum intrinsic, CallExpr* call, ArgList arguments)
+	{
+		m_intrinsic = intrinsic;
+		m_call = call;
+		m_arguments = arguments;
+	}
+
+	ExpressionTypeEnum GetType() { return EXPRESSION_INTRINSIC; }
+
+	IntrinsicTypeEnum Intrinsic() { return m_intrinsic; }
+	CallExpr* Call() { return m_call; }
+	const ArgList& GetArguments() { return m_arguments; }
+
+private:
+	IntrinsicTypeEnum m_intrinsic;
+	CallExpr* m_call; // generic call, used when the builtin is shadowed
+	ArgList m_arguments;
 };
 
 
@@ -104,13 +156,33 @@ public:
 	ExpressionTypeEnum GetType() { return EXPRESSION_FORMAT; }
 
 	Token* Operator() { return m_token; }
-	ArgList GetArguments() { return m_arguments; }
+	const ArgList& GetArguments() { return m_arguments; }
 	std::string FQNS() { return m_fqns; }
 
+	// piece of a literal template, its text followed by {} or {name}
+	struct Segment
+	{
+		std::string text;
+		int arg;				// argument for {}, -1 for none
+		VariableExpr* variable;	// variable for {name}, nullptr for none
+	};
+
+	// a literal template is split by the parser, empty when it is split at run time
+	void SetSegments(std::vector<Segment> segments)
+	{
+		m_segments = std::move(segments);
+		m_length = 0;
+		for (const Segment& s : m_segments) m_length += s.text.size();
+	}
+	const std::vector<Segment>& Segments() { return m_segments; }
+	size_t TextLength() { return m_length; }
+
 private:
 	Token* m_token;
 	ArgList m_arguments;
 	std::string m_fqns;
+	std::vector<Segment> m_segments;
+	size_t m_length = 0;
 };
 
 
@@ -129,7 +201,7 @@ public:
 	ExpressionTypeEnum GetType() { return EXPRESSION_FUNCTOR; }
 
 	Token* Operator() { return m_token; }
-	TokenList GetParams() { return m_params; }
+	const TokenList& GetParams() { return m_params; }
 	void* GetBody() { return m_body; }
 	std::string FQNS() { return m_fqns; }
 
@@ -194,7 +266,7 @@ public:
 
 	ExpressionTypeEnum GetType() { return EXPRESSION_LITERAL; }
 
-	Literal GetLiteral() { return m_literal; }
+	const Literal& GetLiteral() { return m_literal; }
 
 private:
 	Literal m_literal;
@@ -334,7 +406,29 @@ public:
 	ExpressionTypeEnum GetType() { return EXPRESSION_STRUCTURE; }
 
 	Token* Operator() { return m_token; }
-	ArgList GetArguments() { return m_arguments; }
+	const ArgList& GetArguments() { return m_arguments; }
+
+private:
+	Token* m_token;
+	ArgList m_arguments;
+};
+
+
+// a + b + c with a string operand, the result is sized once and written in order
+class ConcatExpr : public Expr
+{
+public:
+	ConcatExpr() = delete;
+	ConcatExpr(Token* token, ArgList arguments)
+	{
+		m_token = token;
+		m_arguments = arguments;
+	}
+
+	ExpressionTypeEnum GetType() { return EXPRESSION_CONCAT; }
+
+	Token* Operator() { return m_token; }
+	const ArgList& GetArguments() { return m_arguments; }
 
 private:
 	Token* m_token;
@@ -420,11 +514,12 @@ class VariableExpr : public Expr
 {
 public:
 	VariableExpr() = delete;
-	VariableExpr(Token* name, Expr* right, std::string fqns)
+	VariableExpr(Token* name, Expr* right, std::string fqns, int slot = -1)
 	{
 		m_token = name;
 		m_right = right;
 		m_fqns = fqns;
+		m_slot = slot;
 	}
 
 	ExpressionTypeEnum GetType() { return EXPRESSION_VARIABLE; }
@@ -432,12 +527,108 @@ public:
 	Token* Operator() { return m_token; }
 	Expr* VecIndex() { return m_right; }
 	std::string FQNS() { return m_fqns; }
+	GlobalCache& Cache() { return m_cache; }
+
+	// parameter or local of an inline body, -1 for names looked up in the environment
+	int Slot() { return m_slot; }
 
 private:
 	Token* m_token;
 	Expr* m_right;
 	std::string m_fqns;
+	GlobalCache m_cache;
+	int m_slot;
+};
+
+
+// &name as a call argument, binds a reference parameter to the variable itself
+class RefExpr : public Expr
+{
+public:
+	RefExpr() = delete;
+	RefExpr(Token* token, VariableExpr* variable)
+	{
+		m_token = token;
+		m_variable = variable;
+	}
+
+	ExpressionTypeEnum GetType() { return EXPRESSION_REF; }
+
+	Token* Operator() { return m_token; }
+	VariableExpr* Variable() { return m_variable; }
+
+private:
+	Token* m_token;
+	VariableExpr* m_variable;
+};
+
+// x += y, ++x, x-- and the like, the target is resolved once and updated in place.
+// Fallback is the equivalent plain assignment for targets that cannot be, such as
+// map values or fields of a vector element.
+class CompoundExpr : public Expr
+{
+public:
+	CompoundExpr() = delete;
+	CompoundExpr(Token* token, Expr* target, Expr* value, bool postfix, Expr* fallback, bool appends = false, Expr* read = nullptr, const ArgList& once = ArgList())
+	{
+		m_token = token;
+		m_target = target;
+		m_value = value;
+		m_postfix = postfix;
+		m_fallback = fallback;
+		m_appends = appends;
+		m_read = read ? read : target;
+		m_once = once;
+	}
+
+	ExpressionTypeEnum GetType() { return EXPRESSION_COMPOUND; }
+
+	// the arithmetic operator, TOKEN_PLUS for both += and ++
+	Token* Operator() { return m_token; }
+	Expr* Target() { return m_target; }
+	Expr* Value() { return m_value; }
+	bool Postfix() { return m_postfix; }
+	Expr* Fallback() { return m_fallback; }
+
+	// s = s + ..., only a string target is appended to in place
+	bool Appends() { return m_appends; }
+
+	// the target as the fallback reads and stores it, an index with side effects
+	// is replaced by the slot of Once() that holds its value
+	Expr* Read() { return m_read; }
+	ArgList& Once() { return m_once; }
+
+private:
+	Token* m_token;
+	Expr* m_target;
+	Expr* m_value;
+	bool m_postfix;
+	Expr* m_fallback;
+	bool m_appends;
+	Expr* m_read;
+	ArgList m_once;
 };
 
+// no side effects, so evaluating it cannot change any variable
+inline bool IsPure(Expr* expr)
+{
+	switch (expr->GetType())
+	{
+	case EXPRESSION_LITERAL: return true;
+	case EXPRESSION_VARIABLE: return !((VariableExpr*)expr)->VecIndex() || IsPure(((VariableExpr*)expr)->VecIndex());
+	case EXPRESSION_GROUP: return IsPure(((GroupExpr*)expr)->Expression());
+	case EXPRESSION_UNARY: return IsPure(((UnaryExpr*)expr)->Right());
+	case EXPRESSION_BINARY: return IsPure(((BinaryExpr*)expr)->Left()) && IsPure(((BinaryExpr*)expr)->Right());
+	case EXPRESSION_CONCAT:
+		for (Expr* e : ((ConcatExpr*)expr)->GetArguments())
+		{
+			if (!IsPure(e)) return false;
+		}
+		return true;
+	default: return false;
+	}
+}
+
+
 
 #endif // EXPRESSIONS_H
\ No newline at end of file
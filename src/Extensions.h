@@ -5,119 +5,198 @@
 #include <chrono>
 #include <fstream>
 #include <algorithm>
+#include <numeric>
 
+#include "Binding.h"
+#include "Coroutine.h"
 #include "Environment.h"
 #include "Literal.h"
+#include "Memo.h"
+#include "NativeCode.h"
+#include "Output.h"
 
 #ifndef NO_RAYLIB
 #include <raylib.h>
 #endif
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
-class Extensions
-{
-public:
-
-    static void Include_Std(Environment* globals)
-    {
-		std::string nspace = "global::";
-        // clock()
-		Literal clockLiteral = Literal();
-		clockLiteral.SetCallable(0, [](LiteralList args)->Literal
-		{
-			const auto p = std::chrono::system_clock::now();
-			return double(std::chrono::duration_cast<std::chrono::microseconds>(p.time_since_epoch()).count());
-		}, nspace);
-		globals->Define("clock", clockLiteral, nspace);
-
-        
-        // cprintln()
-		Literal cprintlnLiteral = Literal();
-		cprintlnLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-            printf("CONSOLE PRINT> %s\n", args[0].ToString().c_str());
-            return Literal();
-		}, nspace);
-		globals->Define("cprintln", cprintlnLiteral, nspace);
-
-        
-        // fabs()
-		Literal fabsLiteral = Literal();
-		fabsLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return fabs(args[0].DoubleValue());
-		}, nspace);
-		globals->Define("fabs", fabsLiteral, nspace);
-
-		
-		// floor()
-		Literal floorLiteral = Literal();
-		floorLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return floor(args[0].DoubleValue());
-		}, nspace);
-		globals->Define("floor", floorLiteral, nspace);
 
+#ifndef NO_RAYLIB
+static Color StringToColor(const std::string& s)
+{
+	// built once, thread safe and read only afterwards
+	static const std::map<std::string, Color> enumMap = {
+		{ ":LIGHTGRAY", LIGHTGRAY },
+		{ ":GRAY", GRAY },
+		{ ":DARKGRAY", Color { 60, 60, 60, 255 } },
+		{ ":DARKDARKGRAY", Color { 20, 20, 20, 255 } },
+		{ ":YELLOW", YELLOW },
+		{ ":GOLD", GOLD },
+		{ ":ORANGE", ORANGE },
+		{ ":PINK", PINK },
+		{ ":RED", RED },
+		{ ":DARKRED", Color { 128, 20, 25, 255 } },
+		{ ":MAROON", MAROON },
+		{ ":GREEN", GREEN },
+		{ ":LIME", LIME },
+		{ ":DARKGREEN", DARKGREEN },
+		{ ":SKYBLUE", SKYBLUE },
+		{ ":BLUE", BLUE },
+		{ ":DARKBLUE", DARKBLUE },
+		{ ":PURPLE", PURPLE },
+		{ ":VIOLET", VIOLET },
+		{ ":DARKPURPLE", DARKPURPLE },
+		{ ":BEIGE", BEIGE },
+		{ ":BROWN", BROWN },
+		{ ":DARKBROWN", DARKBROWN },
+		{ ":WHITE", WHITE },
+		{ ":BLACK", BLACK },
+		{ ":BLANK", BLANK },
+		{ ":MAGENTA", MAGENTA },
+		{ ":RAYWHITE", RAYWHITE },
+		{ ":SHARKGRAY", Color { 34, 32, 39, 255 } },
+		{ ":SLATEGRAY", Color { 140, 173, 181, 255 } },
+		{ ":DARKSLATEGRAY", Color { 67, 99, 107, 255 } },
+	};
+	auto it = enumMap.find(s);
+	if (enumMap.end() != it) return it->second;
+	return MAROON;
+}
+
+static int StringToKey(const std::string& s)
+{
+	static const std::map<std::string, int> enumMap = {
+		{ ":KEY_UP", KEY_UP },
+		{ ":KEY_DOWN", KEY_DOWN },
+		{ ":KEY_LEFT", KEY_LEFT },
+		{ ":KEY_RIGHT", KEY_RIGHT },
+		{ ":KEY_SPACE", KEY_SPACE },
+		{ ":KEY_ENTER", KEY_ENTER },
+		{ ":KEY_BACKSPACE", KEY_BACKSPACE },
+		{ ":KEY_A", KEY_A },
+		{ ":KEY_B", KEY_B },
+		{ ":KEY_C", KEY_C },
+		{ ":KEY_D", KEY_D },
+		{ ":KEY_E", KEY_E },
+		{ ":KEY_F", KEY_F },
+		{ ":KEY_G", KEY_G },
+		{ ":KEY_H", KEY_H },
+		{ ":KEY_I", KEY_I },
+		{ ":KEY_J", KEY_J },
+		{ ":KEY_K", KEY_K },
+		{ ":KEY_L", KEY_L },
+		{ ":KEY_M", KEY_M },
+		{ ":KEY_N", KEY_N },
+		{ ":KEY_O", KEY_O },
+		{ ":KEY_P", KEY_P },
+		{ ":KEY_Q", KEY_Q },
+		{ ":KEY_R", KEY_R },
+		{ ":KEY_S", KEY_S },
+		{ ":KEY_T", KEY_T },
+		{ ":KEY_U", KEY_U },
+		{ ":KEY_V", KEY_V },
+		{ ":KEY_W", KEY_W },
+		{ ":KEY_X", KEY_X },
+		{ ":KEY_Y", KEY_Y },
+		{ ":KEY_Z", KEY_Z },
+		{ ":MOUSE_BUTTON_LEFT", MOUSE_BUTTON_LEFT },
+		{ ":MOUSE_BUTTON_RIGHT", MOUSE_BUTTON_RIGHT },
+		{ ":MOUSE_BUTTON_MIDDLE", MOUSE_BUTTON_MIDDLE },
+	};
+	auto it = enumMap.find(s);
+	if (enumMap.end() != it) return it->second;
+	return KEY_NULL;
+}
+
+static int StringToGamepadButton(const std::string& s)
+{
+	static const std::map<std::string, int> enumMap = {
+		{ ":GAMEPAD_BUTTON_LEFT_FACE_UP", GAMEPAD_BUTTON_LEFT_FACE_UP },
+		{ ":GAMEPAD_BUTTON_LEFT_FACE_DOWN", GAMEPAD_BUTTON_LEFT_FACE_DOWN },
+		{ ":GAMEPAD_BUTTON_LEFT_FACE_LEFT", GAMEPAD_BUTTON_LEFT_FACE_LEFT },
+		{ ":GAMEPAD_BUTTON_LEFT_FACE_RIGHT", GAMEPAD_BUTTON_LEFT_FACE_RIGHT },
+	};
+	auto it = enumMap.find(s);
+	if (enumMap.end() != it) return it->second;
+	return KEY_NULL;
+}
+
+// colors are passed either as an enum name or as a vec<i32> of rgba values
+template <> struct ArgConv<Color>
+{
+	static const char* Name() { return "color"; }
+	static bool Check(const Literal& v) { return v.IsEnum() || (v.IsVector() && v.IsVecInteger() && 4 == v.Len()); }
+	static Color Get(const Literal& v)
+	{
+		if (v.IsEnum()) return StringToColor(v.EnumValue().enumValue);
+		return Color { (unsigned char)v.VecValueAt_I(0), (unsigned char)v.VecValueAt_I(1), (unsigned char)v.VecValueAt_I(2), (unsigned char)v.VecValueAt_I(3) };
+	}
+};
+#endif
 
-        // input()
-		Literal inputLiteral = Literal();
-		inputLiteral.SetCallable(0, [](LiteralList args)->Literal
-		{
-			char inbuf[256];
-			std::cin.getline(inbuf, 256);
-			return std::string(inbuf);
-		}, nspace);
-		globals->Define("input", inputLiteral, nspace);
 
 
-		// len()
-		Literal lenLiteral = Literal();
-		lenLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return args[0].Len();
-		}, nspace);
-		globals->Define("len", lenLiteral, nspace);
+// bit counts of an i32 taken as 32 unsigned bits, ctz and clz of zero are 32
+static int32_t PopCount(uint32_t x)
+{
+#ifdef _MSC_VER
+	return int32_t(__popcnt(x));
+#else
+	return __builtin_popcount(x);
+#endif
+}
 
-        
-        // min()
-		Literal minLiteral = Literal();
-		minLiteral.SetCallable(2, [](LiteralList args)->Literal
-		{
-            double m = args[0].DoubleValue();
-            if (args[1].DoubleValue() < m) m = args[1].DoubleValue();
-            return m;
-		}, nspace);
-		globals->Define("min", minLiteral, nspace);
+static int32_t CountTrailingZeros(uint32_t x)
+{
+	if (0 == x) return 32;
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward(&i, x);
+	return int32_t(i);
+#else
+	return __builtin_ctz(x);
+#endif
+}
 
+static int32_t CountLeadingZeros(uint32_t x)
+{
+	if (0 == x) return 32;
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanReverse(&i, x);
+	return 31 - int32_t(i);
+#else
+	return __builtin_clz(x);
+#endif
+}
 
-        // max()
-		Literal maxLiteral = Literal();
-		maxLiteral.SetCallable(2, [](LiteralList args)->Literal
-		{
-            double m = args[0].DoubleValue();
-            if (args[1].DoubleValue() > m) m = args[1].DoubleValue();
-            return m;
-		}, nspace);
-		globals->Define("max", maxLiteral, nspace);
+// compiles to a single rotate instruction
+static int32_t RotateLeft(uint32_t x, int32_t n)
+{
+	n &= 31;
+	return int32_t((x << n) | (x >> ((32 - n) & 31)));
+}
+class Extensions
+{
+public:
 
+    // rand(), each interpreter gets its own generator
+    static Literal MakeRand(Environment* globals, std::string nspace)
+    {
+		uint64_t timeSeed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+		uint64_t envSeed = uint64_t(uintptr_t(globals));
+		std::seed_seq ss{uint32_t(timeSeed & 0xffffffff), uint32_t(timeSeed>>32), uint32_t(envSeed & 0xffffffff), uint32_t(envSeed>>32)};
+		std::shared_ptr<std::mt19937_64> rng = std::make_shared<std::mt19937_64>(ss);
 
-		// rand()
 		Literal randLiteral = Literal();
-		randLiteral.SetCallable(1, [](LiteralList args)->Literal
+		randLiteral.SetCallable(1, [rng](const LiteralList& args)->Literal
 		{
-            static bool first_pass = true;
-            static std::mt19937_64 rng;
-	        static std::uniform_real_distribution<double> unif(0, 1);
-
-            if (first_pass)
-            {
-                first_pass = false;
-                uint64_t timeSeed = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-                std::seed_seq ss{uint32_t(timeSeed & 0xffffffff), uint32_t(timeSeed>>32)};
-                rng.seed(ss);
-            }
+	        std::uniform_real_distribution<double> unif(0, 1);
 
-            double ret = unif(rng);
+            double ret = unif(*rng);
 			if (1 == args.size() && args[0].IsRange())
 			{
 				// return a value within a range
@@ -134,9 +213,9 @@ public:
 				{
 					std::vector<double> ret;
 					ret.reserve(sz);
-					for (size_t i = 0; i < sz; ++i)
+					for (int i = 0; i < sz; ++i)
 					{
-						ret.push_back(unif(rng));
+						ret.push_back(unif(*rng));
 					}
 					return Literal(ret);
 				}
@@ -152,9 +231,9 @@ public:
 					int32_t lhs = args[0].LeftValue();
 					int32_t rhs = args[0].RightValue();
 					int32_t delta = rhs - lhs;
-					for (size_t i = 0; i < sz; ++i)
+					for (int i = 0; i < sz; ++i)
 					{
-						ret.push_back(int32_t(lhs + unif(rng) * delta));
+						ret.push_back(int32_t(lhs + unif(*rng) * delta));
 					}
 					return Literal(ret);
 				}
@@ -162,190 +241,274 @@ public:
 			return ret;
 
 		}, nspace, false);
-		globals->Define("rand", randLiteral, nspace);
+		return randLiteral;
+    }
+
+    static void Include_Std(Environment* globals)
+    {
+		std::string nspace = "global::";
+        // clock()
+		Bind(globals, "clock", []()
+		{
+			const auto p = std::chrono::system_clock::now();
+			return double(std::chrono::duration_cast<std::chrono::microseconds>(p.time_since_epoch()).count());
+		}, nspace);
+
+        
+        // cprintln()
+		Bind(globals, "cprintln", [](const Literal& value)
+		{
+			Output::Local().Write("CONSOLE PRINT> ");
+			Output::Local().Line(value);
+		}, nspace);
+
+		// flush(), writes out what print has buffered
+		Bind(globals, "flush", []() { Output::Local().Flush(); }, nspace);
+
+		// output::buffer(bytes, lines), print is written out after this many bytes, and at each newline when lines is set
+		Bind(globals, "buffer", [](int32_t bytes, bool lines)
+		{
+			Output::Capacity() = size_t(std::max(0, bytes));
+			Output::Lines() = lines;
+			Output::Local().Flush();
+		}, "global::output::");
+
+		// output::capacity() and output::lines(), the current settings so a script can restore them
+		Bind(globals, "capacity", []() { return int32_t(Output::Capacity()); }, "global::output::");
+		Bind(globals, "lines", []() { return bool(Output::Lines()); }, "global::output::");
+
+		// output::shortest(), f32 values are written with the fewest digits that read back the same instead of six decimals
+		Bind(globals, "shortest", [](bool shortest) { Literal::SetShortest(shortest); }, "global::output::");
+
+        
+        // fabs()
+		Bind(globals, "fabs", [](double x) { return fabs(x); }, nspace, INTRINSIC_FABS);
+
+		
+		// floor()
+		Bind(globals, "floor", [](double x) { return floor(x); }, nspace, INTRINSIC_FLOOR);
+
+
+        // input()
+		Bind(globals, "input", []()
+		{
+			// the prompt has to be out before waiting on the user
+			Output::Local().Flush();
+			char inbuf[256];
+			std::cin.getline(inbuf, 256);
+			return std::string(inbuf);
+		}, nspace);
+
+
+		// len()
+		Bind(globals, "len", [](const Literal& value) { return value.Len(); }, nspace, INTRINSIC_LEN);
+
+        
+        // min()
+		Bind(globals, "min", [](double a, double b) { return b < a ? b : a; }, nspace, INTRINSIC_MIN);
+
+
+        // max()
+		Bind(globals, "max", [](double a, double b) { return b > a ? b : a; }, nspace, INTRINSIC_MAX);
+
+
+		// rand()
+		globals->Define("rand", MakeRand(globals, nspace), nspace);
+
+
+		///////////////////////
+
+		// co::resume(), runs a generator up to its next yield
+		Bind(globals, "resume", [](const std::shared_ptr<Generator>& g) { return g->Resume(); }, "global::co::");
+
+		// co::done()
+		Bind(globals, "done", [](const std::shared_ptr<Generator>& g) { return g->Done(); }, "global::co::");
+
+
+		///////////////////////
+
+		// memo::hits(), calls of a def pure function answered from its memo
+		Bind(globals, "hits", [](const Literal& f) { Memo* m = f.GetMemo(); return int32_t(m ? m->Hits() : 0); }, "global::memo::");
+
+		// memo::misses()
+		Bind(globals, "misses", [](const Literal& f) { Memo* m = f.GetMemo(); return int32_t(m ? m->Misses() : 0); }, "global::memo::");
+
+		// memo::size(), results currently held
+		Bind(globals, "size", [](const Literal& f) { Memo* m = f.GetMemo(); return int32_t(m ? m->Size() : 0); }, "global::memo::");
+
+		// memo::clear(), drops the results and resets the counters
+		Bind(globals, "clear", [](const Literal& f)
+		{
+			Memo* m = f.GetMemo();
+			if (!m) Output::Report("memo::clear() expects a def pure function.\n");
+			else m->Clear();
+			return nullptr != m;
+		}, "global::memo::");
+
+		// native::compiled(), argument signatures of a def native function running compiled code
+		Bind(globals, "compiled", [](const Literal& f) { NativeCode* n = f.GetNative(); return int32_t(n ? n->Compiled() : 0); }, "global::native::");
+
+
+		///////////////////////
+
+		// bits::popcount(), set bits of an i32
+		Bind(globals, "popcount", [](int32_t x) { return PopCount(uint32_t(x)); }, "global::bits::");
+
+		// bits::ctz(), zero bits below the lowest set one
+		Bind(globals, "ctz", [](int32_t x) { return CountTrailingZeros(uint32_t(x)); }, "global::bits::");
+
+		// bits::clz(), zero bits above the highest set one
+		Bind(globals, "clz", [](int32_t x) { return CountLeadingZeros(uint32_t(x)); }, "global::bits::");
+
+		// bits::rotl(x, n), bits shifted out at the top come back in at the bottom
+		Bind(globals, "rotl", [](int32_t x, int32_t n) { return RotateLeft(uint32_t(x), n); }, "global::bits::");
+
+		// bits::rotr(x, n)
+		Bind(globals, "rotr", [](int32_t x, int32_t n) { return RotateLeft(uint32_t(x), -n); }, "global::bits::");
+
+
+		///////////////////////
+
+		// strbuf::make(), growing text for loops, s = s + x copies s every time
+		Bind(globals, "make", [](int32_t capacity)
+		{
+			std::shared_ptr<std::string> sb = std::make_shared<std::string>();
+			sb->reserve(size_t(std::max(0, capacity)));
+			return sb;
+		}, "global::strbuf::");
+
+		// strbuf::append(sb, value), numbers are written without a temporary string
+		Bind(globals, "append", [](const std::shared_ptr<std::string>& sb, const Literal& value)
+		{
+			value.AppendTo(*sb);
+			return sb;
+		}, "global::strbuf::");
+
+		// strbuf::append_line(sb, value)
+		Bind(globals, "append_line", [](const std::shared_ptr<std::string>& sb, const Literal& value)
+		{
+			value.AppendTo(*sb);
+			sb->push_back('\n');
+			return sb;
+		}, "global::strbuf::");
+
+		// strbuf::to_string()
+		Bind(globals, "to_string", [](const std::shared_ptr<std::string>& sb) { return *sb; }, "global::strbuf::");
+
+		// strbuf::len()
+		Bind(globals, "len", [](const std::shared_ptr<std::string>& sb) { return int32_t(sb->size()); }, "global::strbuf::");
+
+		// strbuf::clear(), keeps the capacity
+		Bind(globals, "clear", [](const std::shared_ptr<std::string>& sb)
+		{
+			sb->clear();
+			return sb;
+		}, "global::strbuf::");
 
 
 		///////////////////////
 
 		// file::readlines()
-		Literal fileReadlinesLiteral = Literal();
-		fileReadlinesLiteral.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "readlines", [](const std::string& filename)->Literal
 		{
-			if (args[0].IsString())
+			std::ifstream file(filename.c_str());
+			if (file.is_open())
 			{
-				std::ifstream file(args[0].StringValue().c_str());
-				if (file.is_open())
+				std::vector<std::string> lines;
+				for (std::string line; std::getline(file, line); )
 				{
-					std::vector<std::string> lines;
-					for (std::string line; std::getline(file, line); )
-					{
-						lines.push_back(line);
-					}
-					return lines;
+					lines.push_back(line);
 				}
+				return lines;
 			}
 			return 0;
-		}, nspace);
-		globals->Define("readlines", fileReadlinesLiteral, "global::file::");
+		}, "global::file::");
 
 		// file::writelines()
-		Literal fileWritelinesLiteral = Literal();
-		fileWritelinesLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "writelines", [](const std::string& filename, const std::vector<std::string>& lines)
 		{
-			if (args[0].IsString() && args[1].IsVector() && args[1].IsVecString())
+			std::ofstream file(filename.c_str());
+			if (file.is_open())
 			{
-				std::ofstream file(args[0].StringValue().c_str());
-				if (file.is_open())
+				for (auto& l : lines)
 				{
-					std::vector<std::string> lines = args[1].VecValue_S();
-					for (auto& l : lines)
-					{
-						file << l << std::endl;
-					}
-					file.close();
+					file << l << std::endl;
 				}
+				file.close();
 			}
 			return 0;
-		}, nspace);
-		globals->Define("writelines", fileWritelinesLiteral, "global::file::");
+		}, "global::file::");
 		
 		///////////////////////
 
 		// str::contains()
-		Literal strContainsLiteral = Literal();
-		strContainsLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "contains", [](const std::string& s, const std::string& search)
 		{
-			if (args[0].IsString() && args[1].IsString())
-			{
-				return std::string::npos != args[0].StringValue().find(args[1].StringValue());
-			}
-			return false;
-		}, nspace);
-		globals->Define("contains", strContainsLiteral, "global::str::");
+			return std::string::npos != s.find(search);
+		}, "global::str::");
 
 		// str::replace()
-		Literal strReplaceLiteral = Literal();
-		strReplaceLiteral.SetCallable(3, [](LiteralList args)->Literal
+		Bind(globals, "replace", [](const std::string& s, const std::string& from, const std::string& to)
 		{
-			if (args[0].IsString() && args[1].IsString() && args[2].IsString())
-			{
-				return StrReplace(args[0].StringValue(), args[1].StringValue(), args[2].StringValue());
-			}
-			return 0;
-		}, nspace);
-		globals->Define("replace", strReplaceLiteral, "global::str::");
+			return StrReplace(s, from, to);
+		}, "global::str::");
 
 		// str::split()
-		Literal strSplitLiteral = Literal();
-		strSplitLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "split", [](const std::string& s, const std::string& delimiter)
 		{
-			if (args[0].IsString() && args[1].IsString())
-			{
-				return StrSplit(args[0].StringValue(), args[1].StringValue());
-			}
-			return 0;
-		}, nspace);
-		globals->Define("split", strSplitLiteral, "global::str::");
+			return StrSplit(s, delimiter);
+		}, "global::str::");
 
 		// str::join()
-		Literal strJoinLiteral = Literal();
-		strJoinLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "join", [](const std::vector<std::string>& s, const std::string& delimiter)
 		{
-			if (args[0].IsVector() && args[0].IsVecString() && args[1].IsString())
-			{
-				return StrJoin(args[0].VecValue_S(), args[1].StringValue());
-			}
-			return 0;
-		}, nspace);
-		globals->Define("join", strJoinLiteral, "global::str::");
+			return StrJoin(s, delimiter);
+		}, "global::str::");
 
 		// str::substr()
-		Literal strSubstrLiteral = Literal();
-		strSubstrLiteral.SetCallable(3, [](LiteralList args)->Literal
+		Bind(globals, "substr", [](const std::string& input, int32_t idx, int32_t len)->Literal
 		{
-			if (args[0].IsString() && args[1].IsNumeric() && args[2].IsNumeric())
-			{
-				std::string input = args[0].StringValue();
-				int idx = args[1].IntValue();
-				int len = args[2].IntValue();
-				if (idx >= 0 && idx + len <= input.size()) {
-					return input.substr(idx, len);
-				}
+			if (idx >= 0 && len >= 0 && size_t(idx) + size_t(len) <= input.size()) {
+				return input.substr(idx, len);
 			}
 			return 0;
-		}, nspace);
-		globals->Define("substr", strSubstrLiteral, "global::str::");
+		}, "global::str::");
 
 		// str::to_upper()
-		Literal strToUpperLiteral = Literal();
-		strToUpperLiteral.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "to_upper", [](std::string input)
 		{
-			if (args[0].IsString())
-			{
-				std::string input = args[0].StringValue();
-				std::transform(input.begin(), input.end(), input.begin(), ::toupper);
-				return input;
-			}
-			return 0;
-		}, nspace);
-		globals->Define("to_upper", strToUpperLiteral, "global::str::");
+			std::transform(input.begin(), input.end(), input.begin(), ::toupper);
+			return input;
+		}, "global::str::");
 
 		// str::to_lower()
-		Literal strToLowerLiteral = Literal();
-		strToLowerLiteral.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "to_lower", [](std::string input)
 		{
-			if (args[0].IsString())
-			{
-				std::string input = args[0].StringValue();
-				std::transform(input.begin(), input.end(), input.begin(), ::tolower);
-				return input;
-			}
-			return 0;
-		}, nspace);
-		globals->Define("to_lower", strToLowerLiteral, "global::str::");
+			std::transform(input.begin(), input.end(), input.begin(), ::tolower);
+			return input;
+		}, "global::str::");
 
 		// str::ltrim()
-		Literal strLtrim = Literal();
-		strLtrim.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "ltrim", [](std::string input)
 		{
-			if (args[0].IsString())
-			{
-				std::string input = args[0].StringValue();
-				input.erase(0, input.find_first_not_of(" \t\n\r\f\v"));
-				return input;
-			}
-			return 0;
-		}, nspace);
-		globals->Define("ltrim", strLtrim, "global::str::");
+			input.erase(0, input.find_first_not_of(" \t\n\r\f\v"));
+			return input;
+		}, "global::str::");
 
 		// str::rtrim()
-		Literal strRtrim = Literal();
-		strRtrim.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "rtrim", [](std::string input)
 		{
-			if (args[0].IsString())
-			{
-				std::string input = args[0].StringValue();
-				input.erase(input.find_last_not_of(" \t\n\r\f\v") + 1);
-				return input;
-			}
-			return 0;
-		}, nspace);
-		globals->Define("rtrim", strRtrim, "global::str::");
+			input.erase(input.find_last_not_of(" \t\n\r\f\v") + 1);
+			return input;
+		}, "global::str::");
 
 		// str::trim()
-		Literal strTrim = Literal();
-		strTrim.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "trim", [](std::string input)
 		{
-			if (args[0].IsString())
-			{
-				std::string input = args[0].StringValue();
-				input.erase(0, input.find_first_not_of(" \t\n\r\f\v")); // ltrim
-				input.erase(input.find_last_not_of(" \t\n\r\f\v") + 1); // rtrim
-				return input;
-			}
-			return 0;
-		}, nspace);
-		globals->Define("trim", strTrim, "global::str::");
+			input.erase(0, input.find_first_not_of(" \t\n\r\f\v")); // ltrim
+			input.erase(input.find_last_not_of(" \t\n\r\f\v") + 1); // rtrim
+			return input;
+		}, "global::str::");
 		
 		
 		///////////////////////
@@ -353,15 +516,11 @@ public:
 		///////////////////////
 
 		// map::contains
-		Literal mapContainsLiteral = Literal();
-		mapContainsLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "contains", [](const Literal& lhs, const Literal& rhs)->Literal
 		{
-			Literal lhs = args[0];
-			Literal rhs = args[1];
-
 			if (lhs.IsMap())
 			{
-				MapLiteral mp = lhs.MapValue();
+				const MapLiteral& mp = lhs.MapRef();
 				if (rhs.GetType() == mp.keyType &&
 					(LITERAL_TYPE_INTEGER == mp.keyType ||
 					LITERAL_TYPE_STRING == mp.keyType ||
@@ -385,24 +544,18 @@ public:
 				}
 				else
 				{
-					printf("Invalid key type in map::insert\n");
+					Output::Report("Invalid key type in map::insert\n");
 				}
 			}
 		
-			printf("Error in map::insert() arguments.\n");
+			Output::Report("Error in map::insert() arguments.\n");
 			return 0;
-		}, nspace);
-		globals->Define("contains", mapContainsLiteral, "global::map::");
+		}, "global::map::");
 
 
 		// map::insert
-		Literal mapInsertLiteral = Literal();
-		mapInsertLiteral.SetCallable(3, [](LiteralList args)->Literal
+		Bind(globals, "insert", [](const Literal& lhs, const Literal& mhs, const Literal& rhs)->Literal
 		{
-			Literal lhs = args[0];
-			Literal mhs = args[1];
-			Literal rhs = args[2];
-
 			if (lhs.IsMap())
 			{
 				MapLiteral mp = lhs.MapValue();
@@ -455,31 +608,26 @@ public:
 					}
 					else
 					{
-						printf("Invalid value type in map::insert\n");
+						Output::Report("Invalid value type in map::insert\n");
 					}
 				}
 				else
 				{
-					printf("Invalid key type in map::insert\n");
+					Output::Report("Invalid key type in map::insert\n");
 				}
 			}
 
-			printf("Error in map::insert() arguments.\n");
+			Output::Report("Error in map::insert() arguments.\n");
 			return 0;
-		}, nspace);
-		globals->Define("insert", mapInsertLiteral, "global::map::");
+		}, "global::map::");
 		
 		///////////////////////
 		// Vec
 		///////////////////////
 
 		// vec::append()
-		Literal vecAppendLiteral = Literal();
-		vecAppendLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "append", [](const Literal& lhs, const Literal& rhs)->Literal
 		{
-			Literal lhs = args[0];
-			Literal rhs = args[1];
-
 			if (lhs.IsVecBool())
 			{
 				auto vals = lhs.VecValue_B();
@@ -584,16 +732,13 @@ public:
 			}
 			
 
-			printf("Error in vec::append() arguments.\n");
+			Output::Report("Error in vec::append() arguments.\n");
 			return 0;
-		}, nspace);
-		globals->Define("append", vecAppendLiteral, "global::vec::");
+		}, "global::vec::");
 
 		// vec::sort
-		Literal vecSortLiteral = Literal();
-		vecSortLiteral.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "sort", [](const Literal& vals)->Literal
 		{
-			Literal vals = args[0];
 			if (vals.IsVector())
 			{
 				if (vals.IsVecDouble())
@@ -611,17 +756,13 @@ public:
 				}
 			}
 		
-			printf("Error in vec::sort() arguments.\n");
+			Output::Report("Error in vec::sort() arguments.\n");
 			return 0;
-		}, nspace);
-		globals->Define("sort", vecSortLiteral, "global::vec::");
+		}, "global::vec::");
 
 		// vec::sort_by_key
-		Literal vecSortByKeyLiteral = Literal();
-		vecSortByKeyLiteral.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "sort_by_key", [](const Literal& vals, const Literal& keys)->Literal
 		{
-			Literal vals = args[0];
-			Literal keys = args[1];
 			if (vals.IsVector() && keys.IsVector() && (keys.IsVecDouble() || keys.IsVecInteger()))
 			{
 				std::vector<int> inc(vals.Len(), 0);
@@ -634,7 +775,7 @@ public:
 				}
 
 				Literal ret = vals;
-				for (size_t i = 0; i < ret.Len(); ++i)
+				for (int32_t i = 0; i < ret.Len(); ++i)
 				{
 					if (vals.IsVecBool())         { ret.SetValueAt(vals.VecValueAt_B(inc[i]), i); }
 					else if (vals.IsVecDouble())  { ret.SetValueAt(vals.VecValueAt_D(inc[i]), i); }
@@ -646,48 +787,30 @@ public:
 				return ret;
 			}
 		
-			printf("Error in vec::sort_by_key() arguments.\n");
+			Output::Report("Error in vec::sort_by_key() arguments.\n");
 			return 0;
-		}, nspace);
-		globals->Define("sort_by_key", vecSortByKeyLiteral, "global::vec::");
+		}, "global::vec::");
 
         
         //////////////////////////////////////////////
         // Math
 
 		// cos()
-		Literal cosLiteral = Literal();
-		cosLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return cos(args[0].DoubleValue());
-		}, nspace);
-		globals->Define("cos", cosLiteral, nspace);
+		Bind(globals, "cos", [](double x) { return cos(x); }, nspace, INTRINSIC_COS);
 
         // sin()
-		Literal sinLiteral = Literal();
-		sinLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return sin(args[0].DoubleValue());
-		}, nspace);
-		globals->Define("sin", sinLiteral, nspace);
+		Bind(globals, "sin", [](double x) { return sin(x); }, nspace, INTRINSIC_SIN);
 
         // sgn()
-		Literal sgnLiteral = Literal();
-		sgnLiteral.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "sgn", [](const Literal& value)
 		{
-            if (args[0].IsInt() && args[0].IntValue() < 0) return int32_t(-1);
-            if (args[0].IsDouble() && args[0].DoubleValue() < 0) return int32_t(-1);
+            if (value.IsInt() && value.IntValue() < 0) return int32_t(-1);
+            if (value.IsDouble() && value.DoubleValue() < 0) return int32_t(-1);
             return int32_t(1);
-		}, nspace);
-		globals->Define("sgn", sgnLiteral, nspace);
+		}, nspace, INTRINSIC_SGN);
 
         // sqrt()
-		Literal sqrtLiteral = Literal();
-		sqrtLiteral.SetCallable(1, [](LiteralList args)->Literal
-		{
-			return sqrt(args[0].DoubleValue());
-		}, nspace);
-		globals->Define("sqrt", sqrtLiteral, nspace);
+		Bind(globals, "sqrt", [](double x) { return sqrt(x); }, nspace, INTRINSIC_SQRT);
     }
 
 
@@ -701,101 +824,26 @@ public:
         std::string nspace = "ray::";
 #ifndef NO_RAYLIB
         // ray_InitWindow
-		Literal ray_InitWindow = Literal();
-		ray_InitWindow.SetCallable(3, [](LiteralList args)->Literal
+		Bind(globals, "InitWindow", [](int32_t w, int32_t h, const std::string& title)
 		{
-			int w = args[0].IntValue();
-			int h = args[1].IntValue();
-			std::string s = args[2].StringValue();
-			InitWindow(w, h, s.c_str());
-			return 0;
+			InitWindow(w, h, title.c_str());
 		}, nspace);
-		globals->Define("InitWindow", ray_InitWindow, nspace);
 
-		// ray_SetTargetFPS
-		Literal ray_SetTargetFPS = Literal();
-		ray_SetTargetFPS.SetCallable(1, [](LiteralList args)->Literal
-		{
-			int fps = args[0].IntValue();
-			SetTargetFPS(fps);
-			return 0;
-		}, nspace);
-		globals->Define("SetTargetFPS", ray_SetTargetFPS, nspace);
-
-		// ray_WindowShouldClose
-		Literal ray_WindowShouldClose = Literal();
-		ray_WindowShouldClose.SetCallable(0, [](LiteralList args)->Literal
-		{
-			return WindowShouldClose() == true;
-		}, nspace);
-		globals->Define("WindowShouldClose", ray_WindowShouldClose, nspace);
-
-		// ray_BeginDrawing
-		Literal ray_BeginDrawing = Literal();
-		ray_BeginDrawing.SetCallable(0, [](LiteralList args)->Literal
-		{
-			BeginDrawing();
-			return 0;
-		}, nspace);
-		globals->Define("BeginDrawing", ray_BeginDrawing, nspace);
-
-		// ray_ClearBackground
-		Literal ray_ClearBackground = Literal();
-		ray_ClearBackground.SetCallable(1, [](LiteralList args)->Literal
-		{
-			std::string s = args[0].EnumValue().enumValue;
-			auto d = args[0].VecValue_I();
-            if (args[0].IsEnum())
-			{
-            	ClearBackground(StringToColor(s));
-			} else if (args[0].IsVector() && 4 == d.size()) {
-				ClearBackground((Color){ d[0], d[1], d[2], d[3] });
-			}
-			return 0;
-		}, nspace);
-		globals->Define("ClearBackground", ray_ClearBackground, nspace);
+		Bind(globals, "SetTargetFPS", &SetTargetFPS, nspace);
+		Bind(globals, "WindowShouldClose", &WindowShouldClose, nspace);
+		Bind(globals, "BeginDrawing", &BeginDrawing, nspace);
+		Bind(globals, "ClearBackground", &ClearBackground, nspace);
+		Bind(globals, "EndDrawing", &EndDrawing, nspace);
+		Bind(globals, "CloseWindow", &CloseWindow, nspace);
 
-		// ray_EndDrawing
-		Literal ray_EndDrawing = Literal();
-		ray_EndDrawing.SetCallable(0, [](LiteralList args)->Literal
+		// ray_BeginBlendMode
+		Bind(globals, "BeginBlendMode", [](const EnumLiteral& mode)
 		{
-			EndDrawing();
-			return 0;
-		}, nspace);
-		globals->Define("EndDrawing", ray_EndDrawing, nspace);
-
-		// ray_CloseWindow
-		Literal ray_CloseWindow = Literal();
-		ray_CloseWindow.SetCallable(0, [](LiteralList args)->Literal
-		{
-			CloseWindow();
-			return 0;
-		}, nspace);
-		globals->Define("CloseWindow", ray_CloseWindow, nspace);
-
-
-		// ray_BeginDrawing
-		Literal ray_BeginBlendMode = Literal();
-		ray_BeginBlendMode.SetCallable(1, [](LiteralList args)->Literal
-		{
-			if (args[0].IsEnum())
-			{
-				std::string s = args[0].EnumValue().enumValue;
-				if (0 == s.compare(":BLEND_ALPHA")) BeginBlendMode(BLEND_ALPHA);
-				else if (0 == s.compare(":BLEND_ALPHA_PREMULTIPLY")) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
-			}
-			return 0;
+			if (0 == mode.enumValue.compare(":BLEND_ALPHA")) BeginBlendMode(BLEND_ALPHA);
+			else if (0 == mode.enumValue.compare(":BLEND_ALPHA_PREMULTIPLY")) BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
 		}, nspace);
-		globals->Define("BeginBlendMode", ray_BeginBlendMode, nspace);
 
-		// ray_EndDrawing
-		Literal ray_EndBlendMode = Literal();
-		ray_EndBlendMode.SetCallable(0, [](LiteralList args)->Literal
-		{
-			EndBlendMode();
-			return 0;
-		}, nspace);
-		globals->Define("EndBlendMode", ray_EndBlendMode, nspace);
+		Bind(globals, "EndBlendMode", &EndBlendMode, nspace);
 
 		
 
@@ -804,83 +852,22 @@ public:
         // Drawing Primitives
         ////////////////////////////////////////////////////////////////////////////////////////
 
-		// ray_DrawCircle
-		Literal ray_DrawCircle = Literal();
-		ray_DrawCircle.SetCallable(4, [](LiteralList args)->Literal
-		{
-			int x = args[0].IntValue();
-			int y = args[1].IntValue();
-			int sz = args[2].IntValue();
-			std::string s;
-            if (args[3].IsEnum()) s = args[3].EnumValue().enumValue;
-            
-            DrawCircle(x, y, sz, StringToColor(s));
-			return 0;
-		}, nspace);
-		globals->Define("DrawCircle", ray_DrawCircle, nspace);
-
-        // ray_DrawLine
-		Literal ray_DrawLine = Literal();
-		ray_DrawLine.SetCallable(5, [](LiteralList args)->Literal
-		{
-			int x0 = args[0].IntValue();
-			int y0 = args[1].IntValue();
-            int x1 = args[2].IntValue();
-			int y1 = args[3].IntValue();
-            std::string s;
-            if (args[4].IsEnum()) s = args[4].EnumValue().enumValue;
-            
-            DrawLine(x0, y0, x1, y1, StringToColor(s));
-			return 0;
-		}, nspace);
-		globals->Define("DrawLine", ray_DrawLine, nspace);
-
-        // ray_DrawRectangle
-		Literal ray_DrawRectangle = Literal();
-		ray_DrawRectangle.SetCallable(5, [](LiteralList args)->Literal
-		{
-			int x = args[0].IntValue();
-			int y = args[1].IntValue();
-            int w = args[2].IntValue();
-            int h = args[3].IntValue();
-			std::string s;
-            if (args[4].IsEnum()) s = args[4].EnumValue().enumValue;
-            
-            DrawRectangle(x, y, w, h, StringToColor(s));
-			return 0;
-		}, nspace);
-		globals->Define("DrawRectangle", ray_DrawRectangle, nspace);
+		Bind(globals, "DrawCircle", &DrawCircle, nspace);
+		Bind(globals, "DrawLine", &DrawLine, nspace);
+		Bind(globals, "DrawRectangle", &DrawRectangle, nspace);
 
         // ray_DrawTriangle
-		Literal ray_DrawTriangle = Literal();
-		ray_DrawTriangle.SetCallable(7, [](LiteralList args)->Literal
+		Bind(globals, "DrawTriangle", [](float x0, float y0, float x1, float y1, float x2, float y2, Color color)
 		{
-            Vector2 v0 = { args[0].DoubleValue(), args[1].DoubleValue() };
-            Vector2 v1 = { args[2].DoubleValue(), args[3].DoubleValue() };
-            Vector2 v2 = { args[4].DoubleValue(), args[5].DoubleValue() };
-            std::string s;
-            if (args[6].IsEnum()) s = args[6].EnumValue().enumValue;
-
-			DrawTriangle(v0, v1, v2, StringToColor(s));
-			return 0;
+			DrawTriangle({ x0, y0 }, { x1, y1 }, { x2, y2 }, color);
 		}, nspace);
-		globals->Define("DrawTriangle", ray_DrawTriangle, nspace);
 
 
 		// ray_DrawPixelRGBA
-		Literal ray_DrawPixelRGBA = Literal();
-		ray_DrawPixelRGBA.SetCallable(6, [](LiteralList args)->Literal
+		Bind(globals, "DrawPixelRGBA", [](int32_t x, int32_t y, int32_t r, int32_t g, int32_t b, int32_t a)
 		{
-            int32_t x = args[0].IntValue();
-			int32_t y = args[1].IntValue();
-			int32_t r = args[2].IntValue();
-			int32_t g = args[3].IntValue();
-			int32_t b = args[4].IntValue();
-			int32_t a = args[5].IntValue();
 			DrawPixel(x, y, {r, g, b, a});
-            return 0;
 		}, nspace);
-		globals->Define("DrawPixelRGBA", ray_DrawPixelRGBA, nspace);
 
 
 
@@ -888,61 +875,27 @@ public:
         // Input
         ////////////////////////////////////////////////////////////////////////////////////////
 
-        // ray_GetMouseX
-		Literal ray_GetMouseX = Literal();
-		ray_GetMouseX.SetCallable(0, [](LiteralList args)->Literal
-		{
-			return int32_t(GetMouseX());
-		}, nspace);
-		globals->Define("GetMouseX", ray_GetMouseX, nspace);
-
-        // ray_GetMouseY
-		Literal ray_GetMouseY = Literal();
-		ray_GetMouseY.SetCallable(0, [](LiteralList args)->Literal
-		{
-			return int32_t(GetMouseY());
-		}, nspace);
-		globals->Define("GetMouseY", ray_GetMouseY, nspace);
+		Bind(globals, "GetMouseX", &GetMouseX, nspace);
+		Bind(globals, "GetMouseY", &GetMouseY, nspace);
 
         // ray_IsMouseButtonReleased
-		Literal ray_IsMouseButtonReleased = Literal();
-		ray_IsMouseButtonReleased.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "IsMouseButtonReleased", [](const EnumLiteral& button)
 		{
-            if (args[0].IsEnum())
-            {
-                return IsMouseButtonReleased(StringToKey(args[0].EnumValue().enumValue));
-            }
-			return false;
-
+			return IsMouseButtonReleased(StringToKey(button.enumValue));
 		}, nspace);
-		globals->Define("IsMouseButtonReleased", ray_IsMouseButtonReleased, nspace);
 		
 
         // ray_IsKeyPressed
-		Literal ray_IsKeyPressed = Literal();
-		ray_IsKeyPressed.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "IsKeyPressed", [](const EnumLiteral& key)
 		{
-            if (args[0].IsEnum())
-            {
-                return IsKeyPressed(StringToKey(args[0].EnumValue().enumValue));
-            }
-			return false;
-
+			return IsKeyPressed(StringToKey(key.enumValue));
 		}, nspace);
-		globals->Define("IsKeyPressed", ray_IsKeyPressed, nspace);
 
         // ray_IsKeyDown
-		Literal ray_IsKeyDown = Literal();
-		ray_IsKeyDown.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "IsKeyDown", [](const EnumLiteral& key)
 		{
-            if (args[0].IsEnum())
-            {
-                return IsKeyDown(StringToKey(args[0].EnumValue().enumValue));
-            }
-			return false;
-
+			return IsKeyDown(StringToKey(key.enumValue));
 		}, nspace);
-		globals->Define("IsKeyDown", ray_IsKeyDown, nspace);
         
 
 
@@ -952,95 +905,42 @@ public:
         ////////////////////////////////////////////////////////////////////////////////////////
 
         // ray_LoadImage
-		Literal ray_LoadImage = Literal();
-		ray_LoadImage.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "LoadImage", [](const std::string& filename)
 		{
-            if (args[0].IsString())
-            {
-                return LoadImage(args[0].StringValue().c_str());
-            }
-            return 0;
+			return LoadImage(filename.c_str());
 		}, nspace);
-		globals->Define("LoadImage", ray_LoadImage, nspace);
 
-        // ray_LoadImageFromScreen
-		Literal ray_LoadImageFromScreen = Literal();
-		ray_LoadImageFromScreen.SetCallable(0, [](LiteralList args)->Literal
-		{
-            return LoadImageFromScreen();
-		}, nspace);
-		globals->Define("LoadImageFromScreen", ray_LoadImageFromScreen, nspace);
+		Bind(globals, "LoadImageFromScreen", &LoadImageFromScreen, nspace);
 
 		// ray_ExportImage
-		Literal ray_ExportImage = Literal();
-		ray_ExportImage.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "ExportImage", [](const Image& img, const std::string& filename)
 		{
-            if (args[0].IsImage() && args[1].IsString())
-            {
-                return ExportImage(args[0].ImageValue(), args[1].StringValue().c_str());
-            }
-            return 0;
+			return ExportImage(img, filename.c_str());
 		}, nspace);
-		globals->Define("ExportImage", ray_ExportImage, nspace);
 
         // ray_ImagePeek
-		Literal ray_ImagePeek = Literal();
-		ray_ImagePeek.SetCallable(4, [](LiteralList args)->Literal
+		Bind(globals, "ImagePeek", [](const Image& img, int32_t px, int32_t py, int32_t pofs)
 		{
-            if (args[0].IsImage() && args[1].IsInt() && args[2].IsInt() && args[3].IsInt())
-            {
-				// assumes 32 bpp
-				Image img = args[0].ImageValue();
-				uint8_t* raw = (uint8_t*)img.data;
-				size_t x = args[1].IntValue();
-				size_t y = args[2].IntValue();
-				size_t ofs = args[3].IntValue();
-				if (x >= 0 && y >= 0 && x < img.width && y < img.height && ofs < 4)
-				{
-					return raw[(y * img.width + x) * 4 + ofs];
-				}
-            }
-            return 0;
+			// assumes 32 bpp
+			uint8_t* raw = (uint8_t*)img.data;
+			if (px >= 0 && py >= 0 && px < img.width && py < img.height && pofs >= 0 && pofs < 4)
+			{
+				return int32_t(raw[(size_t(py) * img.width + px) * 4 + pofs]);
+			}
+			return int32_t(0);
 		}, nspace);
-		globals->Define("ImagePeek", ray_ImagePeek, nspace);
 
 		// ray_ImageResize
-		Literal ray_ImageResize = Literal();
-		ray_ImageResize.SetCallable(3, [](LiteralList args)->Literal
+		Bind(globals, "ImageResize", [](Image img, int32_t x, int32_t y)
 		{
-            if (args[0].IsImage())
-            {
-                int32_t x = args[1].IntValue();
-                int32_t y = args[2].IntValue();
-                ImageResize(&(args[0].ImageValue()), x, y);
-            }
-            return 0;
+			ImageResize(&img, x, y);
 		}, nspace);
-		globals->Define("ImageResize", ray_ImageResize, nspace);
 
         // ray_ImageWidth
-		Literal ray_ImageWidth = Literal();
-		ray_ImageWidth.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsImage())
-            {
-                return args[0].ImageValue().width;
-            }
-            return 0;
-		}, nspace);
-		globals->Define("ImageWidth", ray_ImageWidth, nspace);
+		Bind(globals, "ImageWidth", [](const Image& img) { return img.width; }, nspace);
 
         // ray_ImageHeight
-		Literal ray_ImageHeight = Literal();
-		ray_ImageHeight.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsImage())
-            {
-                return args[0].ImageValue().height;
-            }
-            return 0;
-		}, nspace);
-		globals->Define("ImageHeight", ray_ImageHeight, nspace);
+		Bind(globals, "ImageHeight", [](const Image& img) { return img.height; }, nspace);
 
 
 		////////////////////////////////////////////////////////////////////////////////////////
@@ -1048,104 +948,33 @@ public:
         ////////////////////////////////////////////////////////////////////////////////////////
 
 		// ray_LoadShader
-		Literal ray_LoadShader = Literal();
-		ray_LoadShader.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "LoadShader", [](const Literal& vs, const Literal& fs)
 		{
-			const char* vsFilename = args[0].IsString() ? args[0].StringValue().c_str() : nullptr;
-			const char* fsFilename = args[1].IsString() ? args[1].StringValue().c_str() : nullptr;
-			return LoadShader(vsFilename, fsFilename);
-		}, nspace);
-		globals->Define("LoadShader", ray_LoadShader, nspace);
-
-		// ray_LoadShader
-		Literal ray_UnloadShader = Literal();
-		ray_UnloadShader.SetCallable(1, [](LiteralList args)->Literal
-		{
-			if (args[0].IsShader()) UnloadShader(args[0].ShaderValue());
-			return 0;
-		}, nspace);
-		globals->Define("UnloadShader", ray_UnloadShader, nspace);
-
-		// ray_BeginShaderMode
-		Literal ray_BeginShaderMode = Literal();
-		ray_BeginShaderMode.SetCallable(1, [](LiteralList args)->Literal
-		{
-			if (args[0].IsShader()) BeginShaderMode(args[0].ShaderValue());
-			return 0;
+			std::string vsFilename = vs.IsString() ? vs.StringValue() : "";
+			std::string fsFilename = fs.IsString() ? fs.StringValue() : "";
+			return LoadShader(vs.IsString() ? vsFilename.c_str() : nullptr, fs.IsString() ? fsFilename.c_str() : nullptr);
 		}, nspace);
-		globals->Define("BeginShaderMode", ray_BeginShaderMode, nspace);
 
-		// ray_EndShaderMode
-		Literal ray_EndShaderMode = Literal();
-		ray_EndShaderMode.SetCallable(0, [](LiteralList args)->Literal
-		{
-			EndShaderMode();
-			return 0;
-		}, nspace);
-		globals->Define("EndShaderMode", ray_EndShaderMode, nspace);
+		Bind(globals, "UnloadShader", &UnloadShader, nspace);
+		Bind(globals, "BeginShaderMode", &BeginShaderMode, nspace);
+		Bind(globals, "EndShaderMode", &EndShaderMode, nspace);
 
         
         ////////////////////////////////////////////////////////////////////////////////////////
         // Sounds
         ////////////////////////////////////////////////////////////////////////////////////////
 
-        // ray_InitAudioDevice
-		Literal ray_InitAudioDevice = Literal();
-		ray_InitAudioDevice.SetCallable(0, [](LiteralList args)->Literal
-		{
-            InitAudioDevice();
-            return 0;
-		}, nspace);
-		globals->Define("InitAudioDevice", ray_InitAudioDevice, nspace);
-
-
-        // ray_CloseAudioDevice
-		Literal ray_CloseAudioDevice = Literal();
-		ray_CloseAudioDevice.SetCallable(0, [](LiteralList args)->Literal
-		{
-            CloseAudioDevice();
-            return 0;
-		}, nspace);
-		globals->Define("CloseAudioDevice", ray_CloseAudioDevice, nspace);
-
+		Bind(globals, "InitAudioDevice", &InitAudioDevice, nspace);
+		Bind(globals, "CloseAudioDevice", &CloseAudioDevice, nspace);
 
         // ray_LoadSound
-		Literal ray_LoadSound = Literal();
-		ray_LoadSound.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsString())
-            {
-                return LoadSound(args[0].StringValue().c_str());
-            }
-            return 0;
-		}, nspace);
-		globals->Define("LoadSound", ray_LoadSound, nspace);
-
-
-        // ray_PlaySound
-		Literal ray_PlaySound = Literal();
-		ray_PlaySound.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "LoadSound", [](const std::string& filename)
 		{
-            if (args[0].IsSound())
-            {
-                PlaySound(args[0].SoundValue());
-            }
-            return 0;
+			return LoadSound(filename.c_str());
 		}, nspace);
-		globals->Define("PlaySound", ray_PlaySound, nspace);
-
 
-        // ray_UnloadSound
-		Literal ray_UnloadSound = Literal();
-		ray_UnloadSound.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsSound())
-            {
-                UnloadSound(args[0].SoundValue());
-            }
-            return 0;
-		}, nspace);
-		globals->Define("UnloadSound", ray_UnloadSound, nspace);
+		Bind(globals, "PlaySound", &PlaySound, nspace);
+		Bind(globals, "UnloadSound", &UnloadSound, nspace);
         
         
         
@@ -1154,204 +983,75 @@ public:
         ////////////////////////////////////////////////////////////////////////////////////////
 
         // ray_LoadTexture
-		Literal ray_LoadTexture = Literal();
-		ray_LoadTexture.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsString())
-            {
-                return LoadTexture(args[0].StringValue().c_str());
-            }
-            return 0;
-		}, nspace);
-		globals->Define("LoadTexture", ray_LoadTexture, nspace);
-
-		// ray_LoadRenderTexture
-		Literal ray_LoadRenderTexture = Literal();
-		ray_LoadRenderTexture.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "LoadTexture", [](const std::string& filename)
 		{
-			return LoadRenderTexture(args[0].IntValue(), args[1].IntValue());
+			return LoadTexture(filename.c_str());
 		}, nspace);
-		globals->Define("LoadRenderTexture", ray_LoadRenderTexture, nspace);
 
-        // ray_LoadTextureFromImage
-		Literal ray_LoadTextureFromImage = Literal();
-		ray_LoadTextureFromImage.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsImage())
-            {
-                return LoadTextureFromImage(args[0].ImageValue());
-            }
-            return 0;
-		}, nspace);
-		globals->Define("LoadTextureFromImage", ray_LoadTextureFromImage, nspace);
+		Bind(globals, "LoadRenderTexture", &LoadRenderTexture, nspace);
+		Bind(globals, "LoadTextureFromImage", &LoadTextureFromImage, nspace);
 
         // ray_TextureWidth
-		Literal ray_TextureWidth = Literal();
-		ray_TextureWidth.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsTexture())
-            {
-                return args[0].TextureValue().width;
-            }
-            return 0;
-		}, nspace);
-		globals->Define("TextureWidth", ray_TextureWidth, nspace);
+		Bind(globals, "TextureWidth", [](const Texture2D& tex) { return tex.width; }, nspace);
 
         // ray_TextureHeight
-		Literal ray_TextureHeight = Literal();
-		ray_TextureHeight.SetCallable(1, [](LiteralList args)->Literal
-		{
-            if (args[0].IsTexture())
-            {
-                return args[0].TextureValue().height;
-            }
-            return 0;
-		}, nspace);
-		globals->Define("TextureHeight", ray_TextureHeight, nspace);
+		Bind(globals, "TextureHeight", [](const Texture2D& tex) { return tex.height; }, nspace);
 
-        // ray_DrawTexture
-		Literal ray_DrawTexture = Literal();
-		ray_DrawTexture.SetCallable(4, [](LiteralList args)->Literal
-		{
-            if ((args[0].IsTexture() || args[0].IsRenderTexture2D()) && args[3].IsEnum())
-            {
-				Texture tex = args[0].IsTexture() ? args[0].TextureValue() : args[0].RenderTexture2dValue().texture;
-                int32_t x = args[1].IntValue();
-                int32_t y = args[2].IntValue();
-                std::string s = args[3].EnumValue().enumValue;
-
-                DrawTexture(tex, x, y, StringToColor(s));
-            }
-            return 0;
-		}, nspace);
-		globals->Define("DrawTexture", ray_DrawTexture, nspace);
+		Bind(globals, "DrawTexture", &DrawTexture, nspace);
 
 		// ray_DrawTextureRec
-		Literal ray_DrawTextureRec = Literal();
-		ray_DrawTextureRec.SetCallable(5, [](LiteralList args)->Literal
+		Bind(globals, "DrawTextureRec", [](const Texture2D& tex, const std::vector<int32_t>& v, int32_t x, int32_t y, Color color)
 		{
-            if ((args[0].IsTexture() || args[0].IsRenderTexture2D()) && args[1].IsVecInteger() && args[4].IsEnum())
-            {
-				Texture tex = args[0].IsTexture() ? args[0].TextureValue() : args[0].RenderTexture2dValue().texture;
-				auto v = args[1].VecValue_I();
-				if (4 == v.size()) {
-					std::string s = args[4].EnumValue().enumValue;
-					DrawTextureRec(tex, { v[0], v[1], v[2], v[3] }, { args[2].IntValue(), args[3].IntValue() }, StringToColor(s));
-				}
-            }
-            return 0;
+			if (4 == v.size()) {
+				DrawTextureRec(tex, { v[0], v[1], v[2], v[3] }, { x, y }, color);
+			}
 		}, nspace);
-		globals->Define("DrawTextureRec", ray_DrawTextureRec, nspace);
 
         // ray_DrawTextureEx
-		Literal ray_DrawTextureEx = Literal();
-		ray_DrawTextureEx.SetCallable(6, [](LiteralList args)->Literal
+		Bind(globals, "DrawTextureEx", [](const Texture2D& tex, int32_t x, int32_t y, float rot, float scale, Color color)
 		{
-            if (args[0].IsTexture() && args[5].IsEnum())
-            {
-                int32_t x = args[1].IntValue();
-                int32_t y = args[2].IntValue();
-                double rot = args[3].DoubleValue();
-                double scale = args[4].DoubleValue();
-                std::string s = args[5].EnumValue().enumValue;
-
-                DrawTextureEx(args[0].TextureValue(), (Vector2){x, y}, rot, scale, StringToColor(s));
-            }
-            return 0;
+			DrawTextureEx(tex, (Vector2){x, y}, rot, scale, color);
 		}, nspace);
-		globals->Define("DrawTextureEx", ray_DrawTextureEx, nspace);
 
 		// ray_DrawTexturePro
-		Literal ray_DrawTexturePro = Literal();
-		ray_DrawTexturePro.SetCallable(7, [](LiteralList args)->Literal
+		Bind(globals, "DrawTexturePro", [](const Texture2D& tex, const std::vector<int32_t>& isrc, const std::vector<int32_t>& idst, float x, float y, float rot, Color color)
 		{
-            if ((args[0].IsTexture() || args[0].IsRenderTexture2D()) &&
-				args[1].IsVecInteger() &&
-				args[2].IsVecInteger() &&
-				args[6].IsEnum())
-            {
-				std::vector<int32_t> isrc = args[1].VecValue_I();
-				std::vector<int32_t> idst = args[2].VecValue_I();
-				if (4 == isrc.size() && 4 == idst.size())
-				{
-					Texture tex = args[0].IsTexture() ? args[0].TextureValue() : args[0].RenderTexture2dValue().texture;
-					float x = args[3].DoubleValue();
-					float y = args[4].DoubleValue();
-					double rot = args[5].DoubleValue();
-					std::string s = args[6].EnumValue().enumValue;
-
-					Rectangle src = { isrc[0], isrc[1], isrc[2], isrc[3] };
-					Rectangle dst = { idst[0], idst[1], idst[2], idst[3] };
-					Vector2 org = { x, y };
+			if (4 == isrc.size() && 4 == idst.size())
+			{
+				Rectangle src = { isrc[0], isrc[1], isrc[2], isrc[3] };
+				Rectangle dst = { idst[0], idst[1], idst[2], idst[3] };
+				Vector2 org = { x, y };
 
-					DrawTexturePro(tex, src, dst, org, rot, StringToColor(s));
-				}
-            }
-            return 0;
+				DrawTexturePro(tex, src, dst, org, rot, color);
+			}
 		}, nspace);
-		globals->Define("DrawTexturePro", ray_DrawTexturePro, nspace);
 
 		
         // ray_DrawTextureTile
-		Literal ray_DrawTextureExTile = Literal();
-		ray_DrawTextureExTile.SetCallable(9, [](LiteralList args)->Literal
+		Bind(globals, "DrawTextureExTile", [](const Texture2D& tex, double x, double y, int32_t idx, int32_t w, int32_t h, double rot, double scale, Color color)
 		{
-            if (args[0].IsTexture() && args[8].IsEnum())
-            {
-                double x = args[1].DoubleValue();
-                double y = args[2].DoubleValue();
-                int32_t idx = args[3].IntValue();
-                int32_t w = args[4].IntValue();
-                int32_t h = args[5].IntValue();
-                double rot = args[6].DoubleValue();
-                double scale = args[7].DoubleValue();
-                std::string s = args[8].EnumValue().enumValue;
-
-                Texture2D tex = args[0].TextureValue();
-
-                int32_t tw = (tex.width / w);
-                int32_t u = idx % tw;
-                int32_t v = (idx - u) / tw;
+            int32_t tw = (tex.width / w);
+            int32_t u = idx % tw;
+            int32_t v = (idx - u) / tw;
 
-                int32_t x0 = u * w;
-                int32_t y0 = v * w;
-                
-                Rectangle src = { x0, y0, w, h };
-                Rectangle dst = { int(x * w * scale), int(y * h * scale), w * scale, h * scale };
-                Vector2 org = { 0, 0 };
+            int32_t x0 = u * w;
+            int32_t y0 = v * w;
+            
+            Rectangle src = { x0, y0, w, h };
+            Rectangle dst = { int(x * w * scale), int(y * h * scale), w * scale, h * scale };
+            Vector2 org = { 0, 0 };
 
-                DrawTexturePro(tex, src, dst, org, rot, StringToColor(s));
-            }
-            return 0;
+            DrawTexturePro(tex, src, dst, org, rot, color);
 		}, nspace);
-		globals->Define("DrawTextureExTile", ray_DrawTextureExTile, nspace);
 
 
         // ray_DrawTextureTileMap
-		Literal ray_DrawTextureTileMap = Literal();
-		ray_DrawTextureTileMap.SetCallable(9, [](LiteralList args)->Literal
+		Bind(globals, "DrawTextureTileMap", [](const Texture2D& tex, int32_t xx, int32_t yy, int32_t width, int32_t w, int32_t h, double scale, const std::vector<int32_t>& tiles, const Literal& colors)
 		{
-            if (args[0].IsTexture() && args[7].IsVecInteger() && (args[8].IsVecEnum() || args[8].IsEnum()))
+            if (colors.IsEnum() || (colors.IsVector() && colors.IsVecEnum()))
             {
-                Texture2D tex = args[0].TextureValue();
-                int32_t xx = args[1].IntValue();
-                int32_t yy = args[2].IntValue();
-                int32_t width = args[3].IntValue();
-                int32_t w = args[4].IntValue();
-                int32_t h = args[5].IntValue();
-                double scale = args[6].DoubleValue();
-                std::vector<int32_t> tiles = args[7].VecValue_I();
-                std::vector<EnumLiteral> colors;
-				std::string s;
-				bool colorVec = args[8].IsVecEnum();
-				if (colorVec)
-				{
-					colors = args[8].VecValue_E();
-				}
-				else
-				{
-					s = args[8].EnumValue().enumValue;
-				}
+				bool colorVec = colors.IsVector();
+				Color color = colorVec ? MAROON : StringToColor(colors.EnumValue().enumValue);
 
                 double rot = 0;
                 int32_t height = tiles.size() / width;
@@ -1363,7 +1063,7 @@ public:
                         int32_t sprite = tiles[idx];
                         if (0 > sprite) continue;
                         
-                        if (colorVec) s = colors[idx].enumValue;
+                        if (colorVec) color = StringToColor(colors.VecValueAt_E(idx).enumValue);
 
                         int32_t u = sprite % tw;
                         int32_t v = (sprite - u) / tw;
@@ -1374,32 +1074,15 @@ public:
                         Rectangle dst = { xx + int(x * w * scale), yy + int(y * h * scale), w * scale, h * scale };
                         Vector2 org = { 0, 0 };
 
-                        DrawTexturePro(tex, src, dst, org, rot, StringToColor(s));
+                        DrawTexturePro(tex, src, dst, org, rot, color);
                     }
                 }
 
             }
-            return 0;
 		}, nspace);
-		globals->Define("DrawTextureTileMap", ray_DrawTextureTileMap, nspace);
 
-		// ray_BeginTextureMode
-		Literal ray_BeginTextureMode = Literal();
-		ray_BeginTextureMode.SetCallable(1, [](LiteralList args)->Literal
-		{
-			if (args[0].IsRenderTexture2D()) BeginTextureMode(args[0].RenderTexture2dValue());
-			return 0;
-		}, nspace);
-		globals->Define("BeginTextureMode", ray_BeginTextureMode, nspace);
-
-		// ray_EndTextureMode
-		Literal ray_EndTextureMode = Literal();
-		ray_EndTextureMode.SetCallable(0, [](LiteralList args)->Literal
-		{
-			EndTextureMode();
-			return 0;
-		}, nspace);
-		globals->Define("EndTextureMode", ray_EndTextureMode, nspace);
+		Bind(globals, "BeginTextureMode", &BeginTextureMode, nspace);
+		Bind(globals, "EndTextureMode", &EndTextureMode, nspace);
 
         
         ////////////////////////////////////////////////////////////////////////////////////////
@@ -1407,248 +1090,59 @@ public:
         ////////////////////////////////////////////////////////////////////////////////////////
 
         // ray_LoadFont
-		Literal ray_LoadFont = Literal();
-		ray_LoadFont.SetCallable(1, [](LiteralList args)->Literal
+		Bind(globals, "LoadFont", [](const std::string& filename)
 		{
-			if (args[0].IsString())
-            {
-                return LoadFont(args[0].StringValue().c_str());
-            }
-            return 0;
+			return LoadFont(filename.c_str());
 		}, nspace);
-		globals->Define("LoadFont", ray_LoadFont, nspace);
 
 
         // ray_DrawText
-		Literal ray_DrawText = Literal();
-		ray_DrawText.SetCallable(5, [](LiteralList args)->Literal
+		Bind(globals, "DrawText", [](const std::string& txt, int32_t x, int32_t y, int32_t sz, Color color)
 		{
-            if (args[0].IsString() && args[4].IsEnum())
-            {
-                std::string txt = args[0].StringValue();
-                int x = args[1].IntValue();
-                int y = args[2].IntValue();
-                int sz = args[3].IntValue();
-                std::string s = args[4].EnumValue().enumValue;
-                
-                DrawText(txt.c_str(), x, y, sz, StringToColor(s));
-            }
-			return 0;
+			DrawText(txt.c_str(), x, y, sz, color);
 		}, nspace);
-		globals->Define("DrawText", ray_DrawText, nspace);
         
-        // ray_DrawText
-		Literal ray_DrawTextEx = Literal();
-		ray_DrawTextEx.SetCallable(7, [](LiteralList args)->Literal
+        // ray_DrawTextEx
+		Bind(globals, "DrawTextEx", [](const Font& font, const std::string& txt, int32_t x, int32_t y, float sz, float spc, Color color)
 		{
-			if (args[0].IsFont() && args[1].IsString() && args[6].IsEnum())
-            {
-                std::string txt = args[1].StringValue();
-                int x = args[2].IntValue();
-                int y = args[3].IntValue();
-                double sz = args[4].DoubleValue();
-                double spc = args[5].DoubleValue();
-                std::string s = args[6].EnumValue().enumValue;
-                
-                DrawTextEx(args[0].FontValue(), txt.c_str(), (Vector2){ x, y }, sz, spc, StringToColor(s));
-            }
-			return 0;
+			DrawTextEx(font, txt.c_str(), (Vector2){ x, y }, sz, spc, color);
 		}, nspace);
-		globals->Define("DrawTextEx", ray_DrawTextEx, nspace);
 
         // ray_MeasureText
-		Literal ray_MeasureText = Literal();
-		ray_MeasureText.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "MeasureText", [](const std::string& txt, int32_t sz)
 		{
-			if (args[0].IsString())
-            {
-                std::string txt = args[0].StringValue();
-                double sz = args[1].DoubleValue();
-                return MeasureText(txt.c_str(), sz);
-            }
-			return 0;
+			return MeasureText(txt.c_str(), sz);
 		}, nspace);
-		globals->Define("MeasureText", ray_MeasureText, nspace);
 
 		// ray_MeasureTextEx
-		Literal ray_MeasureTextEx = Literal();
-		ray_MeasureTextEx.SetCallable(4, [](LiteralList args)->Literal
+		Bind(globals, "MeasureTextEx", [](const Font& font, const std::string& txt, float sz, float spc)
 		{
-			if (args[0].IsFont() && args[1].IsString())
-            {
-                std::string txt = args[1].StringValue();
-                double sz = args[2].DoubleValue();
-				double spc = args[3].DoubleValue();
-                Vector2 ret = MeasureTextEx(args[0].FontValue(), txt.c_str(), sz, spc);
-				return ret.x;
-            }
-			return 0;
+			return MeasureTextEx(font, txt.c_str(), sz, spc).x;
 		}, nspace);
-		globals->Define("MeasureTextEx", ray_MeasureTextEx, nspace);
 
 
         ////////////////////////////////////////////////////////////////////////////////////////
         // Gamepad
         ////////////////////////////////////////////////////////////////////////////////////////
 
-        // ray_IsGamepadAvailable
-		Literal ray_IsGamepadAvailable = Literal();
-		ray_IsGamepadAvailable.SetCallable(1, [](LiteralList args)->Literal
-		{
-            return IsGamepadAvailable(args[0].IntValue());
-		}, nspace);
-		globals->Define("IsGamepadAvailable", ray_IsGamepadAvailable, nspace);
-
+		Bind(globals, "IsGamepadAvailable", &IsGamepadAvailable, nspace);
 
-        // ray_IsGamepadAvailable
-		Literal ray_GetGamepadAxisMovement = Literal();
-		ray_IsGamepadAvailable.SetCallable(2, [](LiteralList args)->Literal
+        // ray_GetGamepadAxisMovement
+		Bind(globals, "GetGamepadAxisMovement", [](int32_t gamepad, const EnumLiteral& axis)
 		{
-            if (args[1].IsEnum())
-            {
-                std::string s = args[1].EnumValue().enumValue;
-                int axis = GAMEPAD_AXIS_LEFT_X;
-                if (0 == s.compare(":GAMEPAD_AXIS_LEFT_Y")) axis = GAMEPAD_AXIS_LEFT_Y;
-                
-                return GetGamepadAxisMovement(args[0].IntValue(), axis);
-            }
-            return 0;
+			return GetGamepadAxisMovement(gamepad, 0 == axis.enumValue.compare(":GAMEPAD_AXIS_LEFT_Y") ? GAMEPAD_AXIS_LEFT_Y : GAMEPAD_AXIS_LEFT_X);
 		}, nspace);
-		globals->Define("GetGamepadAxisMovement", ray_IsGamepadAvailable, nspace);
 
         // ray_IsGamepadButtonDown
-		Literal ray_IsGamepadButtonDown = Literal();
-		ray_IsGamepadAvailable.SetCallable(2, [](LiteralList args)->Literal
+		Bind(globals, "IsGamepadButtonDown", [](int32_t gamepad, const EnumLiteral& button)
 		{
-            if (args[1].IsEnum())
-            {
-                std::string s = args[1].EnumValue().enumValue;
-                return IsGamepadButtonDown(args[0].IntValue(), StringToGamepadButton(s));
-            }
-            return 0;
+			return IsGamepadButtonDown(gamepad, StringToGamepadButton(button.enumValue));
 		}, nspace);
-		globals->Define("IsGamepadButtonDown", ray_IsGamepadAvailable, nspace);
 
 #endif
 
     }
 
-private:
-
-#ifndef NO_RAYLIB
-    static Color StringToColor(const std::string& s)
-    {
-		static bool first = true;
-		static std::map<std::string, Color> enumMap;
-		if (first)
-		{
-			first = false;
-			enumMap.insert(std::make_pair(":LIGHTGRAY", LIGHTGRAY));
-			enumMap.insert(std::make_pair(":GRAY", GRAY));
-			enumMap.insert(std::make_pair(":DARKGRAY", Color { 60, 60, 60, 255 }));
-			enumMap.insert(std::make_pair(":DARKDARKGRAY", Color { 20, 20, 20, 255 }));
-			enumMap.insert(std::make_pair(":YELLOW", YELLOW));
-			enumMap.insert(std::make_pair(":GOLD", GOLD));
-			enumMap.insert(std::make_pair(":ORANGE", ORANGE));
-			enumMap.insert(std::make_pair(":PINK", PINK));
-			enumMap.insert(std::make_pair(":RED", RED));
-			enumMap.insert(std::make_pair(":DARKRED", Color { 128, 20, 25, 255 }));
-			enumMap.insert(std::make_pair(":MAROON", MAROON));
-			enumMap.insert(std::make_pair(":GREEN", GREEN));
-			enumMap.insert(std::make_pair(":LIME", LIME));
-			enumMap.insert(std::make_pair(":DARKGREEN", DARKGREEN));
-			enumMap.insert(std::make_pair(":SKYBLUE", SKYBLUE));
-			enumMap.insert(std::make_pair(":BLUE", BLUE));
-			enumMap.insert(std::make_pair(":DARKBLUE", DARKBLUE));
-			enumMap.insert(std::make_pair(":PURPLE", PURPLE));
-			enumMap.insert(std::make_pair(":VIOLET", VIOLET));
-			enumMap.insert(std::make_pair(":DARKPURPLE", DARKPURPLE));
-			enumMap.insert(std::make_pair(":BEIGE", BEIGE));
-			enumMap.insert(std::make_pair(":BROWN", BROWN));
-			enumMap.insert(std::make_pair(":DARKBROWN", DARKBROWN));
-			enumMap.insert(std::make_pair(":WHITE", WHITE));
-			enumMap.insert(std::make_pair(":BLACK", BLACK));
-			enumMap.insert(std::make_pair(":BLANK", BLANK));
-			enumMap.insert(std::make_pair(":MAGENTA", MAGENTA));
-			enumMap.insert(std::make_pair(":RAYWHITE", RAYWHITE));
-			enumMap.insert(std::make_pair(":SHARKGRAY", Color { 34, 32, 39, 255 }));
-			enumMap.insert(std::make_pair(":SLATEGRAY", Color { 140, 173, 181, 255 }));
-			enumMap.insert(std::make_pair(":DARKSLATEGRAY", Color { 67, 99, 107, 255 }));
-			
-		}
-		if (0 != enumMap.count(s)) return enumMap.at(s);
-        return MAROON;
-    }
-
-    static int StringToKey(const std::string& s)
-    {
-		static bool first = true;
-		static std::map<std::string, int> enumMap;
-		if (first)
-		{
-			first = false;
-			enumMap.insert(std::make_pair(":KEY_UP", KEY_UP));
-			enumMap.insert(std::make_pair(":KEY_DOWN", KEY_DOWN));
-			enumMap.insert(std::make_pair(":KEY_LEFT", KEY_LEFT));
-			enumMap.insert(std::make_pair(":KEY_RIGHT", KEY_RIGHT));
-			enumMap.insert(std::make_pair(":KEY_SPACE", KEY_SPACE));
-			enumMap.insert(std::make_pair(":KEY_ENTER", KEY_ENTER));
-			enumMap.insert(std::make_pair(":KEY_BACKSPACE", KEY_BACKSPACE));
-			//
-			enumMap.insert(std::make_pair(":KEY_A", KEY_A));
-			enumMap.insert(std::make_pair(":KEY_B", KEY_B));
-			enumMap.insert(std::make_pair(":KEY_C", KEY_C));
-			enumMap.insert(std::make_pair(":KEY_D", KEY_D));
-			enumMap.insert(std::make_pair(":KEY_E", KEY_E));
-			enumMap.insert(std::make_pair(":KEY_F", KEY_F));
-			enumMap.insert(std::make_pair(":KEY_G", KEY_G));
-			enumMap.insert(std::make_pair(":KEY_H", KEY_H));
-			enumMap.insert(std::make_pair(":KEY_I", KEY_I));
-			enumMap.insert(std::make_pair(":KEY_J", KEY_J));
-			enumMap.insert(std::make_pair(":KEY_K", KEY_K));
-			enumMap.insert(std::make_pair(":KEY_L", KEY_L));
-			enumMap.insert(std::make_pair(":KEY_M", KEY_M));
-			enumMap.insert(std::make_pair(":KEY_N", KEY_N));
-			enumMap.insert(std::make_pair(":KEY_O", KEY_O));
-			enumMap.insert(std::make_pair(":KEY_P", KEY_P));
-			enumMap.insert(std::make_pair(":KEY_Q", KEY_Q));
-			enumMap.insert(std::make_pair(":KEY_R", KEY_R));
-			enumMap.insert(std::make_pair(":KEY_S", KEY_S));
-			enumMap.insert(std::make_pair(":KEY_T", KEY_T));
-			enumMap.insert(std::make_pair(":KEY_U", KEY_U));
-			enumMap.insert(std::make_pair(":KEY_V", KEY_V));
-			enumMap.insert(std::make_pair(":KEY_W", KEY_W));
-			enumMap.insert(std::make_pair(":KEY_X", KEY_X));
-			enumMap.insert(std::make_pair(":KEY_Y", KEY_Y));
-			enumMap.insert(std::make_pair(":KEY_Z", KEY_Z));
-			//
-			enumMap.insert(std::make_pair(":MOUSE_BUTTON_LEFT", MOUSE_BUTTON_LEFT));
-			enumMap.insert(std::make_pair(":MOUSE_BUTTON_RIGHT", MOUSE_BUTTON_RIGHT));
-			enumMap.insert(std::make_pair(":MOUSE_BUTTON_MIDDLE", MOUSE_BUTTON_MIDDLE));
-			
-		}
-		if (0 != enumMap.count(s)) return enumMap.at(s);
-        return KEY_NULL;
-    }
-
-    static int StringToGamepadButton(const std::string& s)
-    {
-		static bool first = true;
-		static std::map<std::string, int> enumMap;
-		if (first)
-		{
-			first = false;
-			enumMap.insert(std::make_pair(":GAMEPAD_BUTTON_LEFT_FACE_UP", GAMEPAD_BUTTON_LEFT_FACE_UP));
-			enumMap.insert(std::make_pair(":GAMEPAD_BUTTON_LEFT_FACE_DOWN", GAMEPAD_BUTTON_LEFT_FACE_DOWN));
-			enumMap.insert(std::make_pair(":GAMEPAD_BUTTON_LEFT_FACE_LEFT", GAMEPAD_BUTTON_LEFT_FACE_LEFT));
-			enumMap.insert(std::make_pair(":GAMEPAD_BUTTON_LEFT_FACE_RIGHT", GAMEPAD_BUTTON_LEFT_FACE_RIGHT));
-		}
-		if (0 != enumMap.count(s)) return enumMap.at(s);
-		return KEY_NULL;
-    }
-#endif
-
 };
 
-
-#endif //EXTENSIONS_H
\ No newline at end of file
+#endif //EXTENSIONS_H
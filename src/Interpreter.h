@@ -2,6 +2,7 @@
 #define INTERPRETER_H
 
 #include <iostream>
+#include <chrono>
 
 
 #include "Literal.h"
@@ -10,6 +11,19 @@
 #include "Statements.h"
 #include "Environment.h"
 #include "Extensions.h"
+#include "Plugins.h"
+#include "ThreadPool.h"
+#include "Workers.h"
+#include "Coroutine.h"
+#include "Output.h"
+
+
+// thrown by a tail call, caught by the frame loop in Literal::Call
+struct TailCall
+{
+	Literal callee;
+	LiteralList args;
+};
 
 
 class Interpreter
@@ -21,42 +35,85 @@ public:
 		m_errorHandler = errorHandler;
 		m_globals = new Environment(errorHandler);
 		m_environment = m_globals;
+		InitState();
 
 		// built in standard library
 		Extensions::Include_Std(m_globals);
+		Workers::Include(m_globals);
 
 		// raylib support
 		Extensions::Include_Raylib(m_globals);
 
 	}
 
+	// start from a snapshot of another interpreter's globals, see Environment::Snapshot
+	// the AST is shared with the source, which may run on another thread, so a fork
+	// neither reads nor writes the inline caches and type profiles on its nodes
+	Interpreter(ErrorHandler* errorHandler, const Environment* snapshot)
+	{
+		m_errorHandler = errorHandler;
+		m_globals = snapshot->Snapshot(errorHandler);
+		m_environment = m_globals;
+		InitState();
+		m_forked = true;
+
+		// a fresh generator so forks do not replay the same random sequence
+		Token token(TOKEN_IDENTIFIER, "rand", 0, "fork");
+		bool isGlobal = false;
+		Literal* slot = m_globals->Lookup(&token, "global::", isGlobal);
+		if (slot && LITERAL_TYPE_FUNCTION == slot->GetType()) *slot = Extensions::MakeRand(m_globals, "global::");
+		Workers::Rebind(m_globals);
+		m_errorHandler->Clear();
+	}
+
+	// parallel for worker, runs loop bodies against another interpreter's scope
+	Interpreter(ErrorHandler* errorHandler, Environment* globals, Environment* scope)
+	{
+		m_errorHandler = errorHandler;
+		m_globals = globals;
+		m_environment = scope;
+		InitState();
+		m_worker = true;
+	}
+
 	~Interpreter()
 	{
-		delete m_globals;
+		delete m_pool;
+		if (!m_worker) delete m_globals;
 	}
 
 	ErrorHandler* GetErrorHandler() { return m_errorHandler; }
 	Environment* GetGlobals() { return m_globals; }
+	bool IsWorker() { return m_worker; }
+	bool IsForked() { return m_forked; }
+
+	// threads used by parallel for, including the interpreter's own
+	void SetThreads(size_t threads)
+	{
+		delete m_pool;
+		m_pool = nullptr;
+		m_threads = std::max<size_t>(1, threads);
+	}
 
 	void Interpret(StmtList stmts)
 	{
 		//try
 		//{
-			// first pass for struct & function definitions
+			// first pass for struct & function definitions and native plugins
 			for (auto& statement : stmts)
 			{
-				StatementTypeEnum stype = statement->GetType();
-				if (STATEMENT_STRUCT == stype || STATEMENT_FUNCTION == stype)
+				if (IsHoisted(statement->GetType()))
 					Execute(statement);
 			}
 
 			// second pass for everything else
 			for (auto& statement : stmts)
 			{
-				StatementTypeEnum stype = statement->GetType();
-				if (STATEMENT_STRUCT != stype && STATEMENT_FUNCTION != stype)
+				if (!IsHoisted(statement->GetType()))
 					Execute(statement);
 			}
+
+			Output::Local().Flush();
 		//}
 		/*catch (...)
 		{
@@ -64,29 +121,114 @@ public:
 		}*/
 	}
 
-	// public so it can be called by Literal::Call
-	void ExecuteBlock(StmtList* block, Environment* environment)
+	// continue a generator on this interpreter, see Generator::Resume
+	Literal Resume(Generator* generator)
+	{
+		if (generator->Running())
+		{
+			m_errorHandler->Error("", 0, "Generator is already running.");
+			return Literal();
+		}
+		if (generator->Done()) return generator->Value();
+
+		Environment* environment = m_environment;
+		Generator* outer = m_generator;
+		bool tailCalls = m_tailCalls;
+		Literal* inlineSlots = m_inlineSlots;
+		int spec = m_spec;
+		m_generator = generator;
+		generator->Switch();
+		m_generator = outer;
+		m_environment = environment;
+		m_tailCalls = tailCalls;
+		m_inlineSlots = inlineSlots;
+		m_spec = spec;
+		return generator->Value();
+	}
+
+	// run or continue a call until it returns or runs past deadline, true once it has returned
+	// the call is suspended at the next loop iteration or call after the deadline, see ScriptTask
+	bool RunSlice(Generator* task, std::chrono::steady_clock::time_point deadline)
+	{
+		if (m_slice)
+		{
+			m_errorHandler->Error("", 0, "Time sliced calls can not be nested.");
+			return false;
+		}
+
+		m_slice = task;
+		m_deadline = deadline;
+		m_sliceCountdown = SLICE_CHECK_INTERVAL;
+		Resume(task);
+		m_slice = nullptr;
+		return task->Done();
+	}
+
+	// set while a def or functor body runs, return f(...) then replaces the frame, returns the previous setting
+	bool TailCalls(bool enable)
+	{
+		bool previous = m_tailCalls;
+		m_tailCalls = enable;
+		return previous;
+	}
+
+	// specialization of the running def body, -1 for the generic one, returns the previous setting
+	int Specialization(int way)
+	{
+		int previous = m_spec;
+		m_spec = way;
+		return previous;
+	}
+
+	// ExecuteBlock for a def or functor body, a tail call at the top level of the body is
+	// handed back in call rather than thrown, returns true when it was
+	bool ExecuteFrame(StmtList* block, Environment* environment, TailCall& call)
 	{
 		Environment* previous = m_environment;
 		m_environment = environment;
 
+		bool tail = false;
 		try {
-			for (size_t i = 0; i < block->size(); ++i)
+			for (Stmt* stmt : *block)
 			{
-				Execute(block->at(i));
+				if (STATEMENT_RETURN == stmt->GetType() && ((ReturnStmt*)stmt)->IsTailCall())
+				{
+					tail = PrepareTailCall((CallExpr*)((ReturnStmt*)stmt)->GetValueExpr(), call);
+					break;
+				}
+				Execute(stmt);
 			}
 		}
-		catch (std::string label)
+		catch (...)
 		{
 			delete environment;
 			m_environment = previous;
-			throw label;
+			throw;
+		}
+
+		delete environment;
+		m_environment = previous;
+		return tail;
+	}
+
+	// public so it can be called by Literal::Call
+	void ExecuteBlock(StmtList* block, Environment* environment)
+	{
+		Environment* previous = m_environment;
+		m_environment = environment;
+
+		try {
+			for (size_t i = 0; i < block->size(); ++i)
+			{
+				Execute(block->at(i));
+			}
 		}
-		catch (Literal value)
+		catch (...)
 		{
+			// return values, break labels and tail calls
 			delete environment;
 			m_environment = previous;
-			throw value;
+			throw;
 		}
 
 		delete environment;
@@ -96,6 +238,10 @@ public:
 
 private:
 
+	bool IsHoisted(StatementTypeEnum stype)
+	{
+		return STATEMENT_STRUCT == stype || STATEMENT_FUNCTION == stype || STATEMENT_NATIVE_INCLUDE == stype;
+	}
 
 	void Execute(Stmt* statement)
 	{
@@ -116,11 +262,15 @@ private:
 		case STATEMENT_BLOCK: VisitBlockStatement((BlockStmt*)statement); break;
 		case STATEMENT_IF: VisitIfStatement((IfStmt*)statement); break;
 		case STATEMENT_WHILE: VisitWhileStatement((WhileStmt*)statement); break;
+		case STATEMENT_MATCH: VisitMatchStatement((MatchStmt*)statement); break;
 		case STATEMENT_BREAK: VisitBreakStatement((BreakStmt*)statement); break;
 		case STATEMENT_CONTINUE: VisitContinueStatement((ContinueStmt*)statement); break;
 		case STATEMENT_FUNCTION: VisitFunctionStatement((FunctionStmt*)statement); break;
 		case STATEMENT_STRUCT: VisitStructStatement((StructStmt*)statement); break;
 		case STATEMENT_RETURN: VisitReturnStatement((ReturnStmt*)statement); break;
+		case STATEMENT_YIELD: VisitYieldStatement((YieldStmt*)statement); break;
+		case STATEMENT_NATIVE_INCLUDE: VisitNativeIncludeStatement((NativeIncludeStmt*)statement); break;
+		case STATEMENT_PARALLEL_FOR: VisitParallelForStatement((ParallelForStmt*)statement); break;
 		}
 	}
 
@@ -150,13 +300,23 @@ private:
 		case EXPRESSION_GET: return VisitGet((GetExpr*)expr);
 		case EXPRESSION_SET: return VisitSet((SetExpr*)expr);
 		case EXPRESSION_FORMAT: return VisitFormat((FormatExpr*)expr);
+		case EXPRESSION_CONCAT: return VisitConcat((ConcatExpr*)expr);
 		case EXPRESSION_FUNCTOR: return VisitFunctor((FunctorExpr*)expr);
 		case EXPRESSION_PAIR: return VisitPair((PairExpr*)expr);
+		case EXPRESSION_INTRINSIC: return VisitIntrinsic((IntrinsicExpr*)expr);
+		case EXPRESSION_REF: return VisitRef((RefExpr*)expr);
+		case EXPRESSION_COMPOUND: return VisitCompound((CompoundExpr*)expr);
+		default: break;
 		}
 
 		return Literal();
 	}
 
+	void VisitNativeIncludeStatement(NativeIncludeStmt* stmt)
+	{
+		Plugins::Load(m_globals, stmt->Filename(), stmt->FQNS());
+	}
+
 	void VisitClearEnvStatement()
 	{
 		//printf("Clearing Environment.\n");
@@ -172,25 +332,50 @@ private:
 	{
 		Literal ftn = Literal();
 		ftn.SetCallable(stmt);
-		m_globals->Define(stmt->Operator()->Lexeme(), ftn, stmt->FQNS(), stmt->Internal());
+		m_globals->Define(stmt->Operator()->Lexeme(), std::move(ftn), stmt->FQNS(), stmt->Internal());
 	}
 
 	void VisitStructStatement(StructStmt* stmt)
 	{
 		Literal temp = Literal();
 		temp.SetCallable(stmt);
-		m_globals->Define(stmt->Operator()->Lexeme(), temp, stmt->FQNS(), stmt->Internal());
+		m_globals->Define(stmt->Operator()->Lexeme(), std::move(temp), stmt->FQNS(), stmt->Internal());
 	}
 
 	void VisitReturnStatement(ReturnStmt* stmt)
 	{
 		Literal value;
 		Expr* expr = stmt->GetValueExpr();
+		if (stmt->IsTailCall() && m_tailCalls) VisitTailCall((CallExpr*)expr);
 		if (expr) value = Evaluate(expr);
 
 		throw value;
 	}
 
+	void VisitYieldStatement(YieldStmt* stmt)
+	{
+		Literal value;
+		Expr* expr = stmt->GetValueExpr();
+		if (expr) value = Evaluate(expr);
+
+		if (!m_generator)
+		{
+			m_errorHandler->Error(stmt->Keyword()->Filename(), stmt->Keyword()->Line(), "yield outside of a running generator.");
+			return;
+		}
+
+		// the resumer's scope is current while suspended, put ours back
+		Environment* environment = m_environment;
+		bool tailCalls = m_tailCalls;
+		Literal* inlineSlots = m_inlineSlots;
+		int spec = m_spec;
+		if (!m_generator->Yield(value)) throw std::string("CANCEL:");
+		m_environment = environment;
+		m_tailCalls = tailCalls;
+		m_inlineSlots = inlineSlots;
+		m_spec = spec;
+	}
+
 	void VisitIfStatement(IfStmt* stmt)
 	{
 		if (IsTruthy(Evaluate(stmt->GetCondition())))
@@ -252,7 +437,7 @@ private:
 
 					if (!vtype.IsCallable())
 					{
-						printf("Invalid user defined type in variable declaration.\n");
+						Output::Report("Invalid user defined type in variable declaration.\n");
 					}
 					else
 					{
@@ -293,7 +478,7 @@ private:
 						m_errorHandler->Error("", 0, "Unable to cast between types.");
 					}
 
-					m_environment->Define(names[i]->Lexeme(), value, stmt->FQNS(), stmt->Internal());
+					m_environment->Define(names[i]->Lexeme(), std::move(value), stmt->FQNS(), stmt->Internal());
 				}
 			}
 			else
@@ -314,7 +499,6 @@ private:
 		}
 
 		// check for type casting
-		bool pass = false;
 		TokenTypeEnum varType = stmt->VarType()->GetType();
 		LiteralTypeEnum vecType = stmt->VarVecType();
 		LiteralTypeEnum mapKeyType = stmt->MapKeyType();
@@ -358,7 +542,7 @@ private:
 
 					if (!vtype.IsStructDef())
 					{
-						printf("Invalid user defined type in variable declaration.\n");
+						Output::Report("Invalid user defined type in variable declaration.\n");
 					}
 					else
 					{
@@ -382,7 +566,7 @@ private:
 				}
 			}
 
-			m_environment->Define(stmt->Operator()->Lexeme(), value, stmt->FQNS(), stmt->Internal());
+			m_environment->Define(stmt->Operator()->Lexeme(), std::move(value), stmt->FQNS(), stmt->Internal());
 		}
 		else
 		{
@@ -393,19 +577,10 @@ private:
 
 	void VisitPrintStatement(PrintStmt* stmt, bool newline = false)
 	{
-		char* nl = "";
-		if (newline) nl = "\n";
-
-		Literal literal = Evaluate(stmt->Expression());
-		if (literal.IsString())
-		{
-			printf("%s%s", literal.ToString().c_str(), nl);
-		}
-		else
-		{
-			printf("%s%s", literal.ToString().c_str(), nl);
-			//printf("Parser Error: Expected string expression.\n");
-		}
+		Literal temp;
+		const Literal& literal = EvaluateRef(stmt->Expression(), temp);
+		if (newline) Output::Local().Line(literal);
+		else Output::Local().Write(literal);
 	}
 
 
@@ -425,6 +600,15 @@ private:
 	}
 
 
+	void VisitMatchStatement(MatchStmt* stmt)
+	{
+		Literal temp;
+		int arm = stmt->Find(EvaluateRef(stmt->Subject(), temp));
+		Stmt* body = 0 <= arm ? stmt->Arms()[arm] : stmt->Fallback();
+		if (body) Execute(body);
+	}
+
+
 	void VisitWhileStatement(WhileStmt* stmt)
 	{
 		std::string scopeLabel = stmt->GetLabel();
@@ -442,27 +626,29 @@ private:
 				{
 					Execute(stmt->GetBody());
 				}
-				catch (std::string label)
+				catch (const std::string& label)
 				{
 					// throw if break
 					if (0 != label.compare(continueLabel))
 					{
-						throw label;
+						throw;
 					}
 				}
 				
 				// post operation using in for loop
 				Expr* post = stmt->GetPost();
-				if (post) Evaluate(post);
+				if (post) Discard(post);
+
+				CheckSlice();
 			}
 		}
-		catch (std::string label)
+		catch (const std::string& label)
 		{
 			//printf("caught scope: %s from inside: %s\n", label.c_str(), scopeLabel.c_str());
 			if (0 != label.compare(breakLabel))
 			{
 				m_environment = previous;
-				throw label;
+				throw;
 			}
 		}
 
@@ -471,18 +657,108 @@ private:
 	}
 
 
+	void VisitParallelForStatement(ParallelForStmt* stmt)
+	{
+		Literal first = Evaluate(stmt->Begin());
+		Literal last = Evaluate(stmt->End());
+		if (!first.IsNumeric() || !last.IsNumeric())
+		{
+			m_errorHandler->Error(stmt->Var()->Filename(), stmt->Var()->Line(), "parallel for expects an integer range.");
+			return;
+		}
+
+		int32_t begin = first.IntValue();
+		int32_t end = last.IntValue();
+		if (begin >= end) return;
+
+		// the parser only lets the body write v[i], make sure those writes land in place
+		for (auto& name : stmt->Outputs())
+		{
+			Token token(TOKEN_IDENTIFIER, name, stmt->Var()->Line(), stmt->Var()->Filename());
+			bool isGlobal = false;
+			Literal* slot = m_environment->Lookup(&token, stmt->FQNS(), isGlobal);
+			if (!slot) return;
+			if (!slot->IsVector())
+			{
+				m_errorHandler->Error(token.Filename(), token.Line(), "parallel for output '" + name + "' is not a vector.");
+				return;
+			}
+			slot->Unshare();
+		}
+
+		// the first iteration runs here, which fills the inline caches the workers only read
+		ExecuteParallelBody(stmt, begin++);
+
+		if (m_worker || 1 == m_threads || begin >= end)
+		{
+			for (int32_t i = begin; i < end; ++i) ExecuteParallelBody(stmt, i);
+			return;
+		}
+
+		if (!m_pool) m_pool = new ThreadPool(m_threads);
+
+		std::vector<std::unique_ptr<Interpreter> > workers;
+		for (size_t i = 0; i < m_pool->Size(); ++i)
+		{
+			workers.emplace_back(new Interpreter(m_errorHandler, m_globals, m_environment));
+			workers.back()->m_forked = m_forked;
+		}
+
+		// text printed before the loop goes out ahead of anything the pool threads print
+		Output::Local().Flush();
+
+		int32_t grain = std::max<int32_t>(1, (end - begin) / int32_t(16 * m_pool->Size()));
+		m_pool->ParallelFor(begin, end, grain, [&](size_t worker, int32_t b, int32_t e)
+		{
+			for (int32_t i = b; i < e; ++i) workers[worker]->ExecuteParallelBody(stmt, i);
+			Output::Local().Flush();
+		});
+	}
+
+	void ExecuteParallelBody(ParallelForStmt* stmt, int32_t i)
+	{
+		// detached so workers never touch the shared parent
+		Environment* env = new Environment(m_environment, m_errorHandler, false);
+		env->Define(stmt->Var()->Lexeme(), Literal(i), stmt->FQNS());
+
+		try
+		{
+			ExecuteBlock(stmt->GetBody(), env);
+		}
+		catch (...)
+		{
+			m_errorHandler->Error(stmt->Var()->Filename(), stmt->Var()->Line(), "Unexpected exit from a parallel for body.");
+		}
+	}
+
 	void VisitExpressionStatement(ExpressionStmt* stmt)
 	{
-		Literal literal = Evaluate(stmt->Expression());
-		//printf("%s\n", literal.ToString().c_str());
+		Discard(stmt->Expression());
 	}
 
+	// evaluate only for side effects, an assignment can then move its value into place
+	void Discard(Expr* expr)
+	{
+		if (EXPRESSION_ASSIGN == expr->GetType())
+			VisitAssign((AssignExpr*)expr, false);
+		else if (EXPRESSION_SET == expr->GetType())
+			VisitSet((SetExpr*)expr, false);
+		else if (EXPRESSION_COMPOUND == expr->GetType())
+			VisitCompound((CompoundExpr*)expr, false);
+		else
+			Evaluate(expr);
+	}
 
-	Literal VisitAssign(AssignExpr* expr)
+	Literal VisitAssign(AssignExpr* expr, bool result = true)
 	{
 		Literal value = Evaluate(expr->Right());
-		Literal idx;
-		if (expr->VecIndex()) idx = Evaluate(expr->VecIndex());
+		Literal temp;
+		const Literal& idx = expr->VecIndex() ? EvaluateRef(expr->VecIndex(), temp) : temp;
+		if (!result)
+		{
+			m_environment->Assign(expr->Operator()->Lexeme(), std::move(value), idx, expr->FQNS());
+			return Literal();
+		}
 		m_environment->Assign(expr->Operator()->Lexeme(), value, idx, expr->FQNS());
 		return value;
 	}
@@ -490,7 +766,24 @@ private:
 
 	Literal VisitBinary(BinaryExpr* expr)
 	{
-		Literal left = Evaluate(expr->Left());
+		// typed fast path of a specialized body
+		if (0 <= m_spec)
+		{
+			uint8_t spec = expr->Spec(m_spec);
+			int32_t i;
+			double d;
+			if (spec && SpecBinary(expr, spec, i, d))
+			{
+				uint8_t op = spec & BinaryExpr::OP_MASK;
+				if (SPEC_LESS <= op) return Literal(0 != i);
+				if (SpecIsInt(spec)) return Literal(i);
+				return Literal(d);
+			}
+		}
+
+		// a variable operand is read in place unless the right side could change it first
+		Literal leftTemp, rightTemp;
+		const Literal& left = IsPure(expr->Right()) ? EvaluateRef(expr->Left(), leftTemp) : (leftTemp = Evaluate(expr->Left()));
 
 		// don't evaluate right side if using explicit casting
 		if (TOKEN_AS == expr->Operator()->GetType())
@@ -504,44 +797,28 @@ private:
 					if (left.IsInt()) return left;
 					if (left.IsDouble()) return Literal(int32_t(left.DoubleValue()));
 					if (left.IsBool()) return Literal(int32_t(left.BoolValue()));
-					if (left.IsString())
-					{
-						int32_t ret = 0;
-						try
-						{
-							ret = std::stoi(left.StringValue());
-						}
-						catch (std::invalid_argument)
-						{
-						}
-						return ret;
-					}
+					if (left.IsString()) return Literal(Literal::ParseInt(left.StringRef()));
 				}
 				else if (TOKEN_VAR_F32 == new_type)
 				{
 					if (left.IsInt()) return Literal(left.DoubleValue());
 					if (left.IsDouble()) return left;
-					if (left.IsString())
-					{
-						double ret = 0;
-						try
-						{
-							ret = std::stod(left.StringValue());
-						}
-						catch (std::invalid_argument)
-						{
-						}
-						return ret;
-					}
+					if (left.IsString()) return Literal(Literal::ParseDouble(left.StringRef()));
 				}
 				else if (TOKEN_VAR_STRING == new_type)
 				{
-					if (left.IsInt()) return Literal(std::to_string(left.IntValue()));
-					if (left.IsDouble()) return Literal(std::to_string(left.DoubleValue()));
+					if (left.IsNumeric()) return Literal(left.ToString());
 					if (left.IsString()) return left;
 					if (left.IsEnum()) return Literal(left.EnumValue().enumValue);
 					if (left.IsBool()) return Literal(left.ToString());
 					if (left.IsVector()) return Literal(left.ToString());
+					if (left.IsStrbuf()) return Literal(*left.StrbufValue());
+				}
+				else if (TOKEN_VAR_VEC == new_type && left.IsVector())
+				{
+					// the element type is held as the index of vec
+					Literal ret = left.CastVec(VecType(((VariableExpr*)(expr->Right()))->VecIndex()));
+					if (!ret.IsInvalid()) return ret;
 				}
 				else if (TOKEN_VAR_ENUM == new_type && left.IsString())
 				{
@@ -555,12 +832,12 @@ private:
 					}
 				}
 			}
-			printf("Invalid explicit cast.\n");
+			Output::Report("Invalid explicit cast.\n");
 			return Literal();
 		}
 
 		// keep going
-		Literal right = Evaluate(expr->Right());
+		const Literal& right = EvaluateRef(expr->Right(), rightTemp);
 
 		switch (expr->Operator()->GetType())
 		{
@@ -611,7 +888,7 @@ private:
 					int reps = std::max(0, right.IntValue());
 					std::string lval = left.StringValue();
 					std::string ret;
-					for (size_t i = 0; i < reps; ++i)
+					for (int i = 0; i < reps; ++i)
 					{
 						ret.append(lval);
 					}
@@ -636,7 +913,24 @@ private:
 			CheckIntegerOperand(expr->Operator(), left, right);
 			if (left.IsInt() && right.IsInt())
 			{
-				return Literal(int32_t(left.IntValue() % right.IntValue()));
+				if (0 == right.IntValue())
+				{
+					m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "Modulo by zero.");
+					return Literal();
+				}
+				return Literal(int32_t(-1 == right.IntValue() ? 0 : left.IntValue() % right.IntValue()));
+			}
+			return Literal();
+
+		case TOKEN_AMPERSAND:
+		case TOKEN_PIPE:
+		case TOKEN_CARET:
+		case TOKEN_LESS_LESS:
+		case TOKEN_GREATER_GREATER:
+			CheckIntegerOperand(expr->Operator(), left, right);
+			if (left.IsInt() && right.IsInt())
+			{
+				return Literal(Bitwise(expr->Operator()->GetType(), left.IntValue(), right.IntValue()));
 			}
 			return Literal();
 
@@ -674,12 +968,122 @@ private:
 
 		case TOKEN_EQUAL_EQUAL:
 			return IsEqual(left, right);
+		default: break;
 		}
 
 		return Literal();
 	}
 
 
+	// element type of vec<type> in a cast
+	static LiteralTypeEnum VecType(Expr* type)
+	{
+		switch (type ? ((VariableExpr*)type)->Operator()->GetType() : TOKEN_END_OF_FILE)
+		{
+		case TOKEN_VAR_I32: return LITERAL_TYPE_INTEGER;
+		case TOKEN_VAR_F32: return LITERAL_TYPE_DOUBLE;
+		case TOKEN_VAR_STRING: return LITERAL_TYPE_STRING;
+		default: return LITERAL_TYPE_INVALID;
+		}
+	}
+
+	// shifts take the count modulo 32, >> keeps the sign
+	static int32_t Bitwise(TokenTypeEnum op, int32_t left, int32_t right)
+	{
+		switch (op)
+		{
+		case TOKEN_AMPERSAND: return left & right;
+		case TOKEN_PIPE: return left | right;
+		case TOKEN_CARET: return left ^ right;
+		case TOKEN_LESS_LESS: return int32_t(uint32_t(left) << (right & 31));
+		case TOKEN_GREATER_GREATER: return left >> (right & 31);
+		default: return 0;
+		}
+	}
+
+	// result of a fast path is an i32 when both operands are and it is not a division
+	static bool SpecIsInt(uint8_t spec)
+	{
+		uint8_t op = spec & BinaryExpr::OP_MASK;
+		return SPEC_DIV != op && 0 == (spec & (BinaryExpr::LEFT_DOUBLE | BinaryExpr::RIGHT_DOUBLE));
+	}
+
+	// evaluate a specialized binary without boxing its operands, i holds i32 and comparison
+	// results, d f32 ones, false when an operand no longer has the type it was specialized for
+	bool SpecBinary(BinaryExpr* expr, uint8_t spec, int32_t& i, double& d)
+	{
+		int32_t li = 0, ri = 0;
+		double ld = 0, rd = 0;
+		bool leftDouble = 0 != (spec & BinaryExpr::LEFT_DOUBLE);
+		bool rightDouble = 0 != (spec & BinaryExpr::RIGHT_DOUBLE);
+		if (!SpecOperand(expr->Left(), leftDouble, li, ld) || !SpecOperand(expr->Right(), rightDouble, ri, rd)) return false;
+
+		uint8_t op = spec & BinaryExpr::OP_MASK;
+		if (SpecIsInt(spec))
+		{
+			switch (op)
+			{
+			case SPEC_ADD: i = li + ri; return true;
+			case SPEC_SUB: i = li - ri; return true;
+			case SPEC_MUL: i = li * ri; return true;
+			case SPEC_MOD:
+				// zero and -1 go to the generic path, which reports the one and avoids INT_MIN % -1 for the other
+				if (0 == ri || -1 == ri) return false;
+				i = li % ri;
+				return true;
+			}
+		}
+
+		if (!leftDouble) ld = li;
+		if (!rightDouble) rd = ri;
+		switch (op)
+		{
+		case SPEC_ADD: d = ld + rd; return true;
+		case SPEC_SUB: d = ld - rd; return true;
+		case SPEC_MUL: d = ld * rd; return true;
+		case SPEC_DIV: d = ld / rd; return true;
+		case SPEC_LESS: i = ld < rd; return true;
+		case SPEC_LESS_EQUAL: i = ld <= rd; return true;
+		case SPEC_GREATER: i = ld > rd; return true;
+		case SPEC_GREATER_EQUAL: i = ld >= rd; return true;
+		}
+		return false;
+	}
+
+	// operand of a specialized binary, read in place and checked against its expected type
+	bool SpecOperand(Expr* expr, bool isDouble, int32_t& i, double& d)
+	{
+		const Literal* v = nullptr;
+		switch (expr->GetType())
+		{
+		case EXPRESSION_LITERAL:
+			v = &((LiteralExpr*)expr)->GetLiteral();
+			break;
+
+		case EXPRESSION_VARIABLE:
+			v = LookupVariable((VariableExpr*)expr, ((VariableExpr*)expr)->Cache());
+			break;
+
+		case EXPRESSION_GROUP:
+			return SpecOperand(((GroupExpr*)expr)->Expression(), isDouble, i, d);
+
+		case EXPRESSION_BINARY:
+		{
+			uint8_t spec = ((BinaryExpr*)expr)->Spec(m_spec);
+			return spec && SpecBinary((BinaryExpr*)expr, spec, i, d);
+		}
+
+		default:
+			return false;
+		}
+
+		if (!v || (isDouble ? !v->IsDouble() : !v->IsInt())) return false;
+		if (isDouble) d = v->DoubleValue();
+		else i = v->IntValue();
+		return true;
+	}
+
+
 	Literal VisitBracket(BracketExpr* expr)
 	{
 		
@@ -706,7 +1110,7 @@ private:
 				}
 
 				int32_t rval = rhs.IntValue();
-				for (size_t i = 0; i < rval; ++i)
+				for (int32_t i = 0; i < rval; ++i)
 				{
 					if (lhs.IsBool())
 					{
@@ -917,10 +1321,31 @@ private:
 
 	Literal VisitCall(CallExpr* expr)
 	{
-		Literal callee = Evaluate(expr->GetCallee());
+		Literal ret;
+		if (CallInline(expr, ret)) return ret;
 
-		ArgList arglist = expr->GetArguments();
 		LiteralList args;
+		std::vector<Literal*> refs;
+		Literal temp;
+		Literal* callee = ResolveCall(expr, args, refs, temp);
+		if (!callee) return Literal();
+
+		// generators and time sliced calls run on a stack of their own
+		if (Coroutine::StackLow())
+		{
+			// unwind the whole generator or call like a cancel, so nothing runs on with the invalid result
+			m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "Call stack exhausted in a generator or time sliced call.");
+			throw std::string("CANCEL:");
+		}
+
+		CheckSlice();
+		return callee->Call(this, std::move(args), refs.empty() ? nullptr : &refs);
+	}
+
+	// evaluate the arguments and find the callee, nullptr after reporting a bad call
+	Literal* ResolveCall(CallExpr* expr, LiteralList& args, std::vector<Literal*>& refs, Literal& temp)
+	{
+		const ArgList& arglist = expr->GetArguments();
 
 		if (1 == arglist.size())
 		{
@@ -929,28 +1354,248 @@ private:
 				StructExpr* argexpr = (StructExpr*)arglist[0];
 				for (Expr* arg : argexpr->GetArguments())
 				{
-					args.push_back(Evaluate(arg));
+					EvaluateArgument(arg, args, refs);
 				}
 			}
 			else
 			{
-				args.push_back(Evaluate(arglist[0]));
+				EvaluateArgument(arglist[0], args, refs);
 			}
 		}
 
-		if (!callee.IsCallable())
+		// named callees are resolved through the call site cache instead of copied out of the environment
+		Literal* callee = nullptr;
+		Expr* calleeExpr = expr->GetCallee();
+		if (EXPRESSION_VARIABLE == calleeExpr->GetType() && !((VariableExpr*)calleeExpr)->VecIndex())
 		{
-			printf("Can only call functions.\n");
-			return Literal();
+			callee = LookupVariable((VariableExpr*)calleeExpr, expr->Cache());
+		}
+		else
+		{
+			temp = Evaluate(calleeExpr);
+			callee = &temp;
 		}
 
-		if (callee.ExplicitArgs() && args.size() != callee.Arity())
+		if (!callee || !callee->IsCallable())
 		{
-			printf("Expected %d arguments for '%s', but found %d.\n", callee.Arity(), callee.ToString().c_str(), args.size());
-			return Literal();
+			Output::Report("Can only call functions.\n");
+			return nullptr;
+		}
+
+		if (callee->ExplicitArgs() && args.size() != callee->Arity())
+		{
+			Output::Report("Expected %d arguments for '%s', but found %d.\n", int(callee->Arity()), callee->ToString().c_str(), int(args.size()));
+			return nullptr;
+		}
+
+		return callee;
+	}
+
+	// a call site that has resolved to a global def function with an inline body evaluates
+	// it over slots, without an argument list, a scope or a thrown return value,
+	// false when the call has to be made normally
+	bool CallInline(CallExpr* expr, Literal& ret)
+	{
+		GlobalCache& cache = expr->Cache();
+		if (m_forked || cache.env != m_globals || cache.epoch != m_globals->Epoch()) return false;
+		InlineBody* body = cache.slot->GetInline();
+		if (!body) return false;
+
+		const ArgList* args = &expr->GetArguments();
+		if (1 == args->size() && EXPRESSION_STRUCTURE == args->at(0)->GetType()) args = &((StructExpr*)args->at(0))->GetArguments();
+		if (args->size() != body->params) return false;
+		for (Expr* arg : *args)
+		{
+			if (EXPRESSION_REF == arg->GetType()) return false;
+		}
+
+		// arguments still read the caller's slots
+		Literal slots[InlineBody::MAX_SLOTS];
+		for (size_t i = 0; i < args->size(); ++i) slots[i] = Evaluate(args->at(i));
+
+		CheckSlice();
+
+		// the body sees the globals, as it would from its own frame
+		Environment* environment = m_environment;
+		Literal* outer = m_inlineSlots;
+		m_environment = m_globals;
+		m_inlineSlots = slots;
+		try
+		{
+			for (const InlineBody::Step& step : body->steps)
+			{
+				if (0 <= step.slot)
+				{
+					slots[step.slot] = Evaluate(step.value);
+				}
+				else if (!step.cond || IsTruthy(Evaluate(step.cond)))
+				{
+					ret = Evaluate(step.value);
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			m_environment = environment;
+			m_inlineSlots = outer;
+			throw;
+		}
+
+		m_environment = environment;
+		m_inlineSlots = outer;
+		return true;
+	}
+
+	// return f(...) from a def or functor body, the caller's frame loop in Literal::Call
+	// makes the call after this frame is gone, so tail recursion runs in constant stack
+	void VisitTailCall(CallExpr* expr)
+	{
+		TailCall call;
+		if (PrepareTailCall(expr, call)) throw std::move(call);
+	}
+
+	// true when the call can replace the frame, otherwise it is made here and its value returned by throwing
+	bool PrepareTailCall(CallExpr* expr, TailCall& call)
+	{
+		LiteralList args;
+		std::vector<Literal*> refs;
+		Literal temp;
+		Literal* callee = ResolveCall(expr, args, refs, temp);
+		if (!callee) throw Literal();
+
+		CheckSlice();
+
+		// a reference argument could point into the frame being replaced
+		if (refs.empty() && callee->RunsFrame())
+		{
+			call.callee = *callee;
+			call.args = std::move(args);
+			return true;
+		}
+		throw callee->Call(this, std::move(args), refs.empty() ? nullptr : &refs);
+	}
+
+	// &name arguments pass the variable's storage, the value slot is left empty so it is not shared
+	void EvaluateArgument(Expr* arg, LiteralList& args, std::vector<Literal*>& refs)
+	{
+		if (EXPRESSION_REF != arg->GetType())
+		{
+			args.push_back(Evaluate(arg));
+			return;
+		}
+
+		VariableExpr* var = ((RefExpr*)arg)->Variable();
+		Literal* slot = LookupVariable(var, var->Cache());
+
+		refs.resize(args.size(), nullptr);
+		refs.push_back(slot);
+		args.push_back(Literal());
+	}
+
+	Literal VisitRef(RefExpr* expr)
+	{
+		m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "'&' can only be used on function call arguments.");
+		return Literal();
+	}
+
+
+	Literal VisitIntrinsic(IntrinsicExpr* expr)
+	{
+		// only take the fast path while the name still resolves to the builtin
+		CallExpr* call = expr->Call();
+		Literal* callee = LookupVariable((VariableExpr*)call->GetCallee(), call->Cache());
+		if (!callee || callee->Intrinsic() != expr->Intrinsic()) return VisitCall(call);
+
+		const ArgList& args = expr->GetArguments();
+		Literal temp;
+		// the bound function is skipped, so its argument checks are made here
+		const char* name = ((VariableExpr*)call->GetCallee())->Operator()->Lexeme().c_str();
+
+		switch (expr->Intrinsic())
+		{
+		case INTRINSIC_LEN:
+			return EvaluateRef(args[0], temp).Len();
+
+		case INTRINSIC_MIN:
+		case INTRINSIC_MAX:
+		{
+			Literal lhs = Evaluate(args[0]);
+			const Literal& rhs = EvaluateRef(args[1], temp);
+			if (!CheckArgType<double>(lhs, 0, name) || !CheckArgType<double>(rhs, 1, name)) return Literal();
+			double a = lhs.DoubleValue(), b = rhs.DoubleValue();
+			if (INTRINSIC_MIN == expr->Intrinsic()) return b < a ? b : a;
+			return b > a ? b : a;
+		}
+
+		case INTRINSIC_SQRT:
+		case INTRINSIC_SIN:
+		case INTRINSIC_COS:
+		case INTRINSIC_FLOOR:
+		case INTRINSIC_FABS:
+		{
+			const Literal& x = EvaluateRef(args[0], temp);
+			if (!CheckArgType<double>(x, 0, name)) return Literal();
+			double d = x.DoubleValue();
+			switch (expr->Intrinsic())
+			{
+			case INTRINSIC_SQRT: return sqrt(d);
+			case INTRINSIC_SIN: return sin(d);
+			case INTRINSIC_COS: return cos(d);
+			case INTRINSIC_FLOOR: return floor(d);
+			default: return fabs(d);
+			}
+		}
+
+		case INTRINSIC_SGN:
+		{
+			const Literal& x = EvaluateRef(args[0], temp);
+			if (x.IsInt() && x.IntValue() < 0) return int32_t(-1);
+			if (x.IsDouble() && x.DoubleValue() < 0) return int32_t(-1);
+			return int32_t(1);
+		}
+		default: break;
 		}
 
-		return callee.Call(this, args);
+		return VisitCall(call);
+	}
+
+	// plain variables and constants are read in place, anything else is evaluated into temp
+	const Literal& EvaluateRef(Expr* expr, Literal& temp)
+	{
+		if (EXPRESSION_LITERAL == expr->GetType()) return ((LiteralExpr*)expr)->GetLiteral();
+
+		if (EXPRESSION_VARIABLE == expr->GetType() && !((VariableExpr*)expr)->VecIndex())
+		{
+			Literal* slot = LookupVariable((VariableExpr*)expr, ((VariableExpr*)expr)->Cache());
+			if (slot) return *slot;
+			temp = Literal();
+			return temp;
+		}
+
+		temp = Evaluate(expr);
+		return temp;
+	}
+
+	// each argument is read in place unless a later one could change it
+	void EvaluateAll(const ArgList& args, std::vector<Literal>& temps, std::vector<const Literal*>& values)
+	{
+		size_t copies = 0;
+		for (size_t i = args.size(); i > 0; --i)
+		{
+			if (!IsPure(args[i - 1]))
+			{
+				copies = i - 1;
+				break;
+			}
+		}
+
+		temps.resize(args.size());
+		values.resize(args.size());
+		for (size_t i = 0; i < args.size(); ++i)
+		{
+			values[i] = i < copies ? &(temps[i] = Evaluate(args[i])) : &EvaluateRef(args[i], temps[i]);
+		}
 	}
 
 
@@ -978,7 +1623,7 @@ private:
 			}
 			else
 			{
-				printf("Can't destructure into structure members.\n");
+				Output::Report("Can't destructure into structure members.\n");
 			}
 		}
 
@@ -987,8 +1632,9 @@ private:
 
 	Literal VisitFormat(FormatExpr* expr)
 	{
-		ArgList arglist = expr->GetArguments();
+		const ArgList& arglist = expr->GetArguments();
 		if (arglist.empty()) return Literal("");
+		if (!expr->Segments().empty()) return FormatSegments(expr);
 		LiteralList args;
 
 		if (1 == arglist.size())
@@ -1056,7 +1702,7 @@ private:
 			}
 			else
 			{
-				printf("Error parsing format(%s).\n", a.c_str());
+				Output::Report("Error parsing format(%s).\n", a.c_str());
 				break;
 			}
 		}
@@ -1064,6 +1710,74 @@ private:
 		return Literal(a);
 	}
 
+	// a template split by the parser is written into one buffer sized up front
+	Literal FormatSegments(FormatExpr* expr)
+	{
+		Expr* first = expr->GetArguments()[0];
+		const ArgList& args = EXPRESSION_STRUCTURE == first->GetType() ? ((StructExpr*)first)->GetArguments() : expr->GetArguments();
+
+		std::vector<Literal> temps;
+		std::vector<const Literal*> values;
+		EvaluateAll(args, temps, values);
+
+		size_t length = expr->TextLength();
+		for (const Literal* v : values) length += v->IsString() ? v->StringRef().size() : 16;
+
+		std::string out;
+		out.reserve(length);
+		for (const FormatExpr::Segment& segment : expr->Segments())
+		{
+			out.append(segment.text);
+			if (0 <= segment.arg)
+			{
+				if (size_t(segment.arg) < values.size()) values[segment.arg]->AppendTo(out);
+			}
+			else if (segment.variable)
+			{
+				Literal* slot = LookupVariable(segment.variable, segment.variable->Cache());
+				if (slot) slot->AppendTo(out);
+				else Literal().AppendTo(out);
+			}
+		}
+		return Literal(std::move(out));
+	}
+
+	// a + b + c with strings is sized once, other operands add left to right like binary +
+	Literal VisitConcat(ConcatExpr* expr)
+	{
+		std::vector<Literal> temps;
+		std::vector<const Literal*> values;
+		EvaluateAll(expr->GetArguments(), temps, values);
+
+		size_t length = 0;
+		bool strings = true;
+		for (const Literal* v : values)
+		{
+			strings = strings && v->IsString();
+			if (strings) length += v->StringRef().size();
+		}
+
+		if (strings)
+		{
+			std::string out;
+			out.reserve(length);
+			for (const Literal* v : values) out.append(v->StringRef());
+			return Literal(std::move(out));
+		}
+
+		Literal sum = *values[0];
+		for (size_t i = 1; i < values.size(); ++i)
+		{
+			const Literal& right = *values[i];
+			CheckNumberOrStringOperand(expr->Operator(), sum, right);
+			if (sum.IsString() && right.IsString()) sum.StringEdit().append(right.StringRef());
+			else if (!sum.IsNumeric() || !right.IsNumeric()) return Literal();
+			else if (sum.IsDouble() || right.IsDouble()) sum = Literal(sum.DoubleValue() + right.DoubleValue());
+			else sum = Literal(sum.IntValue() + right.IntValue());
+		}
+		return sum;
+	}
+
 
 	Literal VisitPair(PairExpr* expr)
 	{
@@ -1083,17 +1797,17 @@ private:
 				}
 				else
 				{
-					printf("Pair key must be of type i32, string, or enum..\n");
+					Output::Report("Pair key must be of type i32, string, or enum..\n");
 				}
 			}
 			else
 			{
-				printf("Missing Value in Key-Value pair.\n");
+				Output::Report("Missing Value in Key-Value pair.\n");
 			}
 		}
 		else
 		{
-			printf("Missing Key in Key-Value pair.\n");
+			Output::Report("Missing Key in Key-Value pair.\n");
 		}
 		
 		return ret;
@@ -1187,23 +1901,53 @@ private:
 			{
 				return Literal(right.IntValue() * -1);
 			}
+
+		case TOKEN_TILDE:
+			if (right.IsInt()) return Literal(~right.IntValue());
+			m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "Operand must be an integer.");
+			return Literal();
+		default: break;
 		}
 
 		return Literal();
 	}
 
+	// resolve a variable, consulting the node's inline cache for globals
+	Literal* LookupVariable(VariableExpr* expr, GlobalCache& cache)
+	{
+		if (0 <= expr->Slot()) return m_inlineSlots + expr->Slot();
+		if (!m_forked && cache.env == m_globals && cache.epoch == m_globals->Epoch()) return cache.slot;
+
+		bool isGlobal = false;
+		Literal* slot = m_environment->Lookup(expr->Operator(), expr->FQNS(), isGlobal);
+		// workers share the AST with other threads and leave the caches to the owning interpreter
+		if (slot && isGlobal && !m_worker && !m_forked)
+		{
+			cache.env = m_globals;
+			cache.epoch = m_globals->Epoch();
+			cache.slot = slot;
+		}
+		return slot;
+	}
+
 	Literal VisitVariable(VariableExpr* expr)
 	{
-		Literal v = m_environment->Get(expr->Operator(), expr->FQNS());
+		// evaluate the index first so the variable is read in place rather than copied
+		Literal temp;
+		const Literal& x = expr->VecIndex() ? EvaluateRef(expr->VecIndex(), temp) : temp;
+
+		Literal* slot = LookupVariable(expr, expr->Cache());
+		if (!slot) return Literal();
+
+		const Literal& v = *slot;
 		if (v.IsMap())
 		{
 			if (expr->VecIndex())
 			{
-				Literal x = Evaluate(expr->VecIndex());
 				LiteralTypeEnum keyType = v.GetMapKeyType();
 				if (x.GetType() == keyType)
 				{
-					MapLiteral mp = v.MapValue();
+					const MapLiteral& mp = v.MapRef();
 					if (LITERAL_TYPE_INTEGER == keyType)
 					{
 						int idx = x.IntValue();
@@ -1252,7 +1996,6 @@ private:
 		{
 			if (expr->VecIndex())
 			{
-				Literal x = Evaluate(expr->VecIndex());
 				if (x.IsInt())
 				{
 					int32_t idx = x.IntValue();
@@ -1354,48 +2097,51 @@ private:
 
 	Literal VisitGet(GetExpr* expr)
 	{
+		// the instance and the field are read in place while the index cannot change them
 		Expr* obj = expr->Object();
-		Literal v = Evaluate(obj);
+		Literal temp;
+		const Literal& v = (!expr->VecIndex() || IsPure(expr->VecIndex())) ? EvaluateRef(obj, temp) : (temp = Evaluate(obj));
 
 		if (v.IsInstance())
 		{
-			Literal ret = v.GetParameter(expr->Name()->Lexeme());
-			if (ret.IsInvalid())
+			const Literal* field = v.FindParameter(expr->Name()->Lexeme());
+			if (!field || field->IsInvalid())
 			{
 				m_errorHandler->Error(expr->Name()->Filename(), expr->Name()->Line(), "Invalid property '" + expr->Name()->Lexeme() + "'.");
+				return Literal();
 			}
-			else
+
+			const Literal& ret = *field;
+
+			if (ret.IsVector() || ret.IsString())
 			{
-				if (ret.IsVector() || ret.IsString())
+				int idx = -1;
+				if (expr->VecIndex()) idx = Evaluate(expr->VecIndex()).IntValue();
+				if (idx != -1)
 				{
-					int idx = -1;
-					if (expr->VecIndex()) idx = Evaluate(expr->VecIndex()).IntValue();
-					if (idx != -1)
+					if (ret.IsVector())
 					{
-						if (ret.IsVector())
-						{
-							if (ret.IsVecBool()) return ret.VecValueAt_B(idx);
-							if (ret.IsVecInteger()) return ret.VecValueAt_I(idx);
-							if (ret.IsVecDouble()) return ret.VecValueAt_D(idx);
-							if (ret.IsVecString()) return ret.VecValueAt_S(idx);
-							if (ret.IsVecEnum()) return ret.VecValueAt_E(idx);
-							if (ret.IsVecStruct()) return ret.VecValueAt_U(idx);
-						}
-						else if (ret.IsString())
-						{
-							return ret.StringValue().substr(idx, 1);
-						}
+						if (ret.IsVecBool()) return ret.VecValueAt_B(idx);
+						if (ret.IsVecInteger()) return ret.VecValueAt_I(idx);
+						if (ret.IsVecDouble()) return ret.VecValueAt_D(idx);
+						if (ret.IsVecString()) return ret.VecValueAt_S(idx);
+						if (ret.IsVecEnum()) return ret.VecValueAt_E(idx);
+						if (ret.IsVecStruct()) return ret.VecValueAt_U(idx);
 					}
-				}
-				else if (ret.IsMap())
-				{
-					if (expr->VecIndex())
+					else if (ret.IsString())
 					{
-						Literal idx = Evaluate(expr->VecIndex());
-						printf("attempting to access map with idx: %s\n", idx.ToString());
+						return ret.StringValue().substr(idx, 1);
 					}
 				}
 			}
+			else if (ret.IsMap())
+			{
+				if (expr->VecIndex())
+				{
+					Literal idx = Evaluate(expr->VecIndex());
+					Output::Report("attempting to access map with idx: %s\n", idx.ToString().c_str());
+				}
+			}
 			return ret;
 		}
 
@@ -1403,20 +2149,31 @@ private:
 		return v;
 	}
 
-	Literal VisitSet(SetExpr* expr)
+	Literal VisitSet(SetExpr* expr, bool result = true)
 	{
-		Literal v = Evaluate(expr->Object());
-		if (v.IsInstance())
+		// a plain variable is updated in place, anything else is set on a copy that is written back
+		Expr* object = expr->Object();
+		bool inPlace = EXPRESSION_VARIABLE == object->GetType() && !((VariableExpr*)object)->VecIndex();
+
+		Literal temp;
+		Literal* v = inPlace ? LookupVariable((VariableExpr*)object, ((VariableExpr*)object)->Cache()) : nullptr;
+		if (!v)
+		{
+			if (!inPlace) temp = Evaluate(object);
+			v = &temp;
+		}
+
+		if (v->IsInstance())
 		{
 			Literal value = Evaluate(expr->Value());
 
-			Literal ret = v.GetParameter(expr->Name()->Lexeme());
-			if (!ret.IsInvalid())
+			const Literal* field = v->FindParameter(expr->Name()->Lexeme());
+			if (field && !field->IsInvalid())
 			{
 				int idx = -1;
 				if (expr->VecIndex()) idx = Evaluate(expr->VecIndex()).IntValue();
 
-				if (!v.SetParameter(expr->Name()->Lexeme(), value, idx))
+				if (!v->SetParameter(expr->Name()->Lexeme(), std::move(value), idx))
 				{
 					m_errorHandler->Error(expr->Name()->Filename(), expr->Name()->Line(), "Cannot cast to type of property '" + expr->Name()->Lexeme() + "'.");
 				}
@@ -1426,21 +2183,184 @@ private:
 				m_errorHandler->Error(expr->Name()->Filename(), expr->Name()->Line(), "Invalid property '" + expr->Name()->Lexeme() + "'.");
 			}
 
-			if (EXPRESSION_VARIABLE == expr->Object()->GetType())
+			if (!inPlace && EXPRESSION_VARIABLE == object->GetType())
 			{
 				int idx = -1;
-				VariableExpr* obj = (VariableExpr*)expr->Object();
+				VariableExpr* obj = (VariableExpr*)object;
 				if (obj->VecIndex()) idx = Evaluate(obj->VecIndex()).IntValue();
 
-				m_environment->Assign(obj->Operator()->Lexeme(), v, idx, obj->FQNS());
+				if (result)
+					m_environment->Assign(obj->Operator()->Lexeme(), *v, idx, obj->FQNS());
+				else
+					m_environment->Assign(obj->Operator()->Lexeme(), std::move(*v), idx, obj->FQNS());
 			}
-			return v;
+			return result ? *v : Literal();
 		}
 
 		m_errorHandler->Error(expr->Name()->Filename(), expr->Name()->Line(), "Only instances have properties.");
 		return Literal();
 	}
 
+	Literal VisitCompound(CompoundExpr* expr, bool result = true)
+	{
+		// resolve the variable, or the field of one, before evaluating anything
+		Expr* target = expr->Target();
+		GetExpr* get = EXPRESSION_GET == target->GetType() ? (GetExpr*)target : nullptr;
+		Expr* object = get ? get->Object() : target;
+		Expr* index = get ? get->VecIndex() : ((VariableExpr*)target)->VecIndex();
+
+		Literal* slot = nullptr;
+		const Literal* current = nullptr;
+		if (EXPRESSION_VARIABLE == object->GetType() && !(get && ((VariableExpr*)object)->VecIndex()))
+		{
+			VariableExpr* var = (VariableExpr*)object;
+			if (std::string::npos == var->Operator()->Lexeme().find("::")) slot = LookupVariable(var, var->Cache());
+			current = slot;
+			if (slot && get) current = slot->IsInstance() ? slot->FindParameter(get->Name()->Lexeme()) : nullptr;
+		}
+
+		TokenTypeEnum op = expr->Operator()->GetType();
+		bool inPlace = current && (index ? current->IsVector() && (current->IsVecInteger() || current->IsVecDouble())
+			: expr->Appends() ? current->IsString() : current->IsNumeric() || (current->IsString() && TOKEN_PLUS == op));
+
+		if (!inPlace)
+		{
+			// map values, characters, fields of vector elements and so on take the plain assignment,
+			// the read and the store share the slots of the indices that have side effects
+			std::vector<Literal> slots;
+			for (Expr* e : expr->Once()) slots.push_back(Evaluate(e));
+
+			Literal* outer = m_inlineSlots;
+			if (!slots.empty()) m_inlineSlots = slots.data();
+			Literal old;
+			try
+			{
+				if (!result) Discard(expr->Fallback());
+				else
+				{
+					if (expr->Postfix()) old = Evaluate(expr->Read());
+					Evaluate(expr->Fallback());
+					if (!expr->Postfix()) old = Evaluate(expr->Read());
+				}
+			}
+			catch (...)
+			{
+				m_inlineSlots = outer;
+				throw;
+			}
+			m_inlineSlots = outer;
+			return old;
+		}
+
+		Literal valueTemp, indexTemp;
+		const Literal& value = EvaluateRef(expr->Value(), valueTemp);
+		const Literal& idx = index ? EvaluateRef(index, indexTemp) : indexTemp;
+
+		// the value could have replaced the instance, so the field is looked up again
+		Literal* v = get ? slot->EditParameter(get->Name()->Lexeme()) : slot;
+		if (!v) return Literal();
+
+		if (!index)
+		{
+			if (v->IsString())
+			{
+				CheckNumberOrStringOperand(expr->Operator(), *v, value);
+				if (!value.IsString()) return Literal();
+				v->StringEdit().append(value.StringRef());
+				return result ? *v : Literal();
+			}
+
+			bool isInt = v->IsInt();
+			int32_t i = v->IntValue();
+			double d = v->DoubleValue();
+			if (!UpdateNumber(expr->Operator(), isInt, i, d, value)) return Literal();
+
+			Literal old = result && expr->Postfix() ? *v : Literal();
+			if (isInt) v->SetInt(i);
+			else v->SetDouble(d);
+			return !result ? Literal() : expr->Postfix() ? old : *v;
+		}
+
+		if (!idx.IsInt())
+		{
+			m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "Invalid vector index provided.");
+			return Literal();
+		}
+
+		int32_t n = idx.IntValue();
+		if (n < 0 || n >= v->Len())
+		{
+			m_errorHandler->Error(expr->Operator()->Filename(), expr->Operator()->Line(), "Vector index [" + std::to_string(n) + "] out of bounds during assignment (Size: " + std::to_string(v->Len()) + ").");
+			return Literal();
+		}
+
+		bool isInt = v->IsVecInteger();
+		int32_t i = isInt ? v->VecValueAt_I(n) : 0;
+		double d = isInt ? 0.0 : v->VecValueAt_D(n);
+		Literal old = !result || !expr->Postfix() ? Literal() : isInt ? Literal(i) : Literal(d);
+		if (!UpdateNumber(expr->Operator(), isInt, i, d, value)) return Literal();
+
+		if (isInt) v->SetValueAt(i, size_t(n));
+		else v->SetValueAt(d, size_t(n));
+		return !result ? Literal() : expr->Postfix() ? old : isInt ? Literal(i) : Literal(d);
+	}
+
+	// i or d op= value, an i32 stays one and truncates like a plain assignment, false after an error
+	bool UpdateNumber(Token* op, bool isInt, int32_t& i, double& d, const Literal& value)
+	{
+		if (!value.IsNumeric())
+		{
+			CheckNumberOperand(op, value);
+			return false;
+		}
+
+		if (isInt && value.IsInt() && TOKEN_SLASH != op->GetType())
+		{
+			int32_t y = value.IntValue();
+			switch (op->GetType())
+			{
+			case TOKEN_PLUS: i += y; return true;
+			case TOKEN_MINUS: i -= y; return true;
+			case TOKEN_STAR: i *= y; return true;
+			case TOKEN_PERCENT:
+				if (0 == y)
+				{
+					m_errorHandler->Error(op->Filename(), op->Line(), "Modulo by zero.");
+					return false;
+				}
+				i = -1 == y ? 0 : i % y;
+				return true;
+			default: return false;
+			}
+		}
+
+		double x = isInt ? double(i) : d;
+		double y = value.DoubleValue();
+		switch (op->GetType())
+		{
+		case TOKEN_PLUS: x += y; break;
+		case TOKEN_MINUS: x -= y; break;
+		case TOKEN_STAR: x *= y; break;
+		case TOKEN_SLASH:
+			// an i32 can not hold the infinity or NaN that would come out
+			if (isInt && 0 == y)
+			{
+				m_errorHandler->Error(op->Filename(), op->Line(), "Division by zero.");
+				return false;
+			}
+			x /= y;
+			break;
+		default:
+			m_errorHandler->Error(op->Filename(), op->Line(), "Operands must be integers.");
+			return false;
+		}
+
+		// converting an out of range double is undefined, like CastVec those become 0
+		if (isInt) i = x > -2147483649.0 && x < 2147483648.0 ? int32_t(x) : 0;
+		else d = x;
+		return true;
+	}
+
 	void CheckNumberOperand(Token* token, const Literal& left)
 	{
 		if (left.IsNumeric()) return;
@@ -1492,10 +2412,90 @@ private:
 
 private:
 
+	// back edges and calls between clock reads in a time sliced call
+	static const int SLICE_CHECK_INTERVAL = 32;
+
+	// a single branch unless a time sliced call is running
+	void CheckSlice()
+	{
+		if (m_slice && 0 == --m_sliceCountdown) SliceExpired();
+	}
+
+	void SliceExpired()
+	{
+		m_sliceCountdown = SLICE_CHECK_INTERVAL;
+		if (std::chrono::steady_clock::now() < m_deadline) return;
+
+		// suspend the whole call, RunSlice returns and the next one continues from here
+		Environment* environment = m_environment;
+		Generator* generator = m_generator;
+		bool tailCalls = m_tailCalls;
+		Literal* inlineSlots = m_inlineSlots;
+		int spec = m_spec;
+		if (!m_slice->Yield(Literal())) throw std::string("CANCEL:");
+		m_environment = environment;
+		m_generator = generator;
+		m_tailCalls = tailCalls;
+		m_inlineSlots = inlineSlots;
+		m_spec = spec;
+	}
+
+	// defaults shared by every constructor
+	void InitState()
+	{
+		m_worker = false;
+		m_forked = false;
+		m_threads = std::max(1u, std::thread::hardware_concurrency());
+		m_pool = nullptr;
+		m_generator = nullptr;
+		m_slice = nullptr;
+		m_sliceCountdown = 0;
+		m_tailCalls = false;
+		m_inlineSlots = nullptr;
+		m_spec = -1;
+	}
+
 	ErrorHandler* m_errorHandler;
 	Environment* m_environment;
 	Environment* m_globals;
+	bool m_worker;
+	bool m_forked;			// runs the AST of another interpreter, see the snapshot constructor
+	size_t m_threads;
+	ThreadPool* m_pool;
+	Generator* m_generator;
+	Generator* m_slice;
+	int m_sliceCountdown;
+	std::chrono::steady_clock::time_point m_deadline;
+	bool m_tailCalls;
+	Literal* m_inlineSlots;	// slots of the inline body being evaluated, see CallInline
+	int m_spec;				// specialization of the running def body, see TypeProfile
+
+};
+
 
+// enables or disables tail calls for a scope, see Interpreter::TailCalls
+class TailCallScope
+{
+public:
+	TailCallScope(Interpreter* interpreter, bool enable) : m_interpreter(interpreter), m_previous(interpreter->TailCalls(enable)) {}
+	~TailCallScope() { m_interpreter->TailCalls(m_previous); }
+
+private:
+	Interpreter* m_interpreter;
+	bool m_previous;
+};
+
+
+// restores the specialization of the calling frame, see Interpreter::Specialization
+class SpecializationScope
+{
+public:
+	SpecializationScope(Interpreter* interpreter) : m_interpreter(interpreter), m_previous(interpreter->Specialization(-1)) {}
+	~SpecializationScope() { m_interpreter->Specialization(m_previous); }
+
+private:
+	Interpreter* m_interpreter;
+	int m_previous;
 };
 
 
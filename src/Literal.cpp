@@ -1,10 +1,25 @@
+#include <charconv>
+
 #include "Literal.h"
 #include "Statements.h"
 #include "Expressions.h"
 #include "Environment.h"
 #include "Interpreter.h"
+#include "Memo.h"
+#include "TypeProfile.h"
+#include "NativeCode.h"
+#include "Output.h"
+
+static std::atomic<bool> s_shortest(false);
+
+Literal Literal::Call(Interpreter* interpreter, const LiteralList& args, const std::vector<Literal*>* refs)
+{
+	// natives read the arguments in place, anything else takes its own copy
+	if (LITERAL_TYPE_FUNCTION == m_type && !refs) return m_ftn(args);
+	return Call(interpreter, LiteralList(args), refs);
+}
 
-Literal Literal::Call(Interpreter* interpreter, LiteralList args)
+Literal Literal::Call(Interpreter* interpreter, LiteralList&& args, const std::vector<Literal*>* refs)
 {
 	if (m_type != LITERAL_TYPE_FUNCTION &&
 		m_type != LITERAL_TYPE_TT_FUNCTION &&
@@ -12,6 +27,12 @@ Literal Literal::Call(Interpreter* interpreter, LiteralList args)
 		m_type != LITERAL_TYPE_FUNCTOR)
 		return Literal();
 
+	if (refs && (LITERAL_TYPE_TT_FUNCTION != m_type || m_ftnStmt->IsGenerator()))
+	{
+		Output::Report("'%s' does not take arguments by reference.\n", ToString().c_str());
+		return Literal();
+	}
+
 	if (LITERAL_TYPE_FUNCTION == m_type)
 	{
 		return m_ftn(args);
@@ -72,7 +93,7 @@ Literal Literal::Call(Interpreter* interpreter, LiteralList args)
 
 					if (!vtype.IsCallable())
 					{
-						printf("Invalid user defined type in variable declaration.\n");
+						Output::Report("Invalid user defined type in variable declaration.\n");
 					}
 					else
 					{
@@ -80,75 +101,213 @@ Literal Literal::Call(Interpreter* interpreter, LiteralList args)
 					}
 				}
 
-				ret.m_parameters.insert(std::make_pair(stmt->Operator()->Lexeme(), value));
+				ret.m_parameters.Edit().insert(std::make_pair(stmt->Operator()->Lexeme(), value));
 			}
 		}
 		
 		return ret;
 	}
-	else if (LITERAL_TYPE_FUNCTOR == m_type)
+	else if (LITERAL_TYPE_TT_FUNCTION == m_type && m_ftnStmt->IsGenerator())
 	{
-		Environment* env = new Environment(interpreter->GetGlobals(), interpreter->GetErrorHandler());
+		// the body only starts on the first resume
+		FunctionStmt* stmt = m_ftnStmt;
+		std::string fqns = m_fqns;
+		return Literal(std::make_shared<Generator>(interpreter, [interpreter, stmt, fqns, args = std::move(args)]() mutable
+		{
+			Environment* env = new Environment(interpreter->GetGlobals(), interpreter->GetErrorHandler(), false);
+
+			const TokenList& params = stmt->GetParams();
+			for (size_t i = 0; i < args.size(); ++i)
+			{
+				env->Define(params.at(i).Lexeme(), std::move(args[i]), fqns);
+			}
 
-		auto params = m_functorExpr->GetParams();
+			// a tail call would leave the generator
+			TailCallScope scope(interpreter, false);
+			SpecializationScope spec(interpreter);
+			Literal ret = Literal(true);
+			try
+			{
+				interpreter->ExecuteBlock(stmt->GetBody(), env);
+			}
+			catch (Literal& value)
+			{
+				if (!value.IsInvalid()) ret = std::move(value);
+			}
+			return ret;
+		}));
+	}
 
-		for (size_t i = 0; i < args.size(); ++i)
+	// pure functions answer repeated arguments from their memo
+	Memo* memo = GetMemo();
+	std::string key;
+	if (memo && Memo::Key(args, key))
+	{
+		Literal ret;
+		if (memo->Find(key, ret)) return ret;
+		ret = RunFrames(interpreter, args, refs);
+		memo->Insert(std::move(key), ret);
+		return ret;
+	}
+
+	return RunFrames(interpreter, args, refs);
+}
+
+Literal Literal::RunFrames(Interpreter* interpreter, LiteralList& args, const std::vector<Literal*>* refs) const
+{
+	// def functions and functors, a tail call from the body replaces the frame and loops here,
+	// a tail call into a pure function skips its memo
+	TailCallScope scope(interpreter, true);
+	SpecializationScope spec(interpreter);
+	const Literal* callee = this;
+	Literal next;
+	for (;;)
+	{
+		// def native runs compiled code for the argument types it was built for
+		NativeCode* native = callee->GetNative();
+		if (native && !refs)
 		{
-			env->Define(params.at(i).Lexeme(), args.at(i), m_fqns);
+			Literal ret;
+			if (native->Run(interpreter->GetGlobals(), args, ret)) return ret;
 		}
 
-		Literal ret;
+		// hot argument types run a specialized body, workers and forks share the AST and leave the profiles alone
+		TypeProfile* profile = LITERAL_TYPE_TT_FUNCTION == callee->m_type ? callee->m_ftnStmt->GetProfile() : nullptr;
+		interpreter->Specialization(profile && !interpreter->IsWorker() && !interpreter->IsForked() ? profile->Way(args) : -1);
+
+		// ExecuteBlock always deletes the call scope, so it does not need to be tracked by the globals
+		Environment* env = new Environment(interpreter->GetGlobals(), interpreter->GetErrorHandler(), false);
+		if (!callee->BindParameters(env, args, refs))
+		{
+			delete env;
+			return Literal();
+		}
+
+		StmtList* body = LITERAL_TYPE_FUNCTOR == callee->m_type ? (StmtList*)callee->m_functorExpr->GetBody() : callee->m_ftnStmt->GetBody();
+		TailCall call;
 		try
 		{
-			interpreter->ExecuteBlock((StmtList*)m_functorExpr->GetBody(), env);
+			if (!interpreter->ExecuteFrame(body, env, call)) return Literal();
 		}
-		catch (Literal value)
+		catch (Literal& value)
 		{
-			ret = value;
+			return std::move(value);
+		}
+		catch (TailCall& thrown)
+		{
+			// from inside a nested block
+			call = std::move(thrown);
 		}
 
-		return ret;
+		next = std::move(call.callee);
+		args = std::move(call.args);
+		refs = nullptr;
+		callee = &next;
 	}
-	else
-	{
-		Environment* env = new Environment(interpreter->GetGlobals(), interpreter->GetErrorHandler());
-
-		auto params = m_ftnStmt->GetParams();
+}
 
+bool Literal::BindParameters(Environment* env, LiteralList& args, const std::vector<Literal*>* refs) const
+{
+	if (LITERAL_TYPE_FUNCTOR == m_type)
+	{
+		const TokenList& params = m_functorExpr->GetParams();
 		for (size_t i = 0; i < args.size(); ++i)
 		{
-			env->Define(params.at(i).Lexeme(), args.at(i), m_fqns);
+			env->Define(params.at(i).Lexeme(), std::move(args[i]), m_fqns);
 		}
+		return true;
+	}
 
-		Literal ret;
-		try
-		{
-			interpreter->ExecuteBlock(m_ftnStmt->GetBody(), env);
-		}
-		catch (Literal value)
+	const TokenList& params = m_ftnStmt->GetParams();
+	for (size_t i = 0; i < args.size(); ++i)
+	{
+		Literal* ref = (refs && i < refs->size()) ? refs->at(i) : nullptr;
+		if (m_ftnStmt->IsRef(i) != (nullptr != ref))
 		{
-			ret = value;
+			if (ref)
+				Output::Report("Parameter '%s' of '%s' does not take a reference.\n", params.at(i).Lexeme().c_str(), m_ftnStmt->Operator()->Lexeme().c_str());
+			else
+				Output::Report("Parameter '%s' of '%s' is a reference, pass a variable with '&'.\n", params.at(i).Lexeme().c_str(), m_ftnStmt->Operator()->Lexeme().c_str());
+			return false;
 		}
 
-		return ret;
+		if (ref)
+			env->DefineRef(params.at(i).Lexeme(), ref);
+		else
+			env->Define(params.at(i).Lexeme(), std::move(args[i]), m_fqns);
+	}
+	return true;
+}
+
+Memo* Literal::GetMemo() const
+{
+	return LITERAL_TYPE_TT_FUNCTION == m_type ? m_ftnStmt->GetMemo() : nullptr;
+}
+
+InlineBody* Literal::GetInline() const
+{
+	return LITERAL_TYPE_TT_FUNCTION == m_type ? m_ftnStmt->GetInline() : nullptr;
+}
+
+NativeCode* Literal::GetNative() const
+{
+	return LITERAL_TYPE_TT_FUNCTION == m_type ? m_ftnStmt->GetNative() : nullptr;
+}
+
+bool Literal::RunsFrame() const
+{
+	if (LITERAL_TYPE_FUNCTOR == m_type) return nullptr != m_functorExpr;
+	return LITERAL_TYPE_TT_FUNCTION == m_type && !m_ftnStmt->IsGenerator();
+}
+
+Generator::~Generator()
+{
+	if (m_coroutine.Started() && !m_coroutine.Done() && !m_coroutine.Running())
+	{
+		m_cancel = true;
+		m_interpreter->Resume(this);
 	}
 }
 
+Literal Generator::Resume()
+{
+	return m_interpreter->Resume(this);
+}
+
+
+std::string Literal::StructName() const
+{
+	if (LITERAL_TYPE_TT_STRUCT != m_type) return "";
+	return m_stuctStmt->Operator()->Lexeme();
+}
+
 Literal Literal::GetParameter(const std::string& name)
 {
-	if (0 != m_parameters.count(name)) return m_parameters.at(name);
+	if (0 != m_parameters.Get().count(name)) return m_parameters.Get().at(name);
 	return Literal();
 }
 
+const Literal* Literal::FindParameter(const std::string& name) const
+{
+	auto it = m_parameters.Get().find(name);
+	return it != m_parameters.Get().end() ? &it->second : nullptr;
+}
+
+Literal* Literal::EditParameter(const std::string& name)
+{
+	if (0 == m_parameters.Get().count(name)) return nullptr;
+	return &m_parameters.Edit().at(name);
+}
+
 bool Literal::SetParameter(const std::string& name, Literal value, size_t index)
 {
-	if (0 == m_parameters.count(name)) return false;
-	Literal& v = m_parameters.at(name);
+	if (0 == m_parameters.Get().count(name)) return false;
+	Literal& v = m_parameters.Edit().at(name);
 
 	// check type casting -- DUPLICATE CODE from Environment->Assign()
 	if (v.IsRange())
 	{
-		printf("Unable to assign range.\n");
+		Output::Report("Unable to assign range.\n");
 	}
 	else
 	{
@@ -156,11 +315,11 @@ bool Literal::SetParameter(const std::string& name, Literal value, size_t index)
 		if (v.IsDouble() && value.IsInt()) value = Literal(double(value.IntValue()));
 		if (v.GetType() == value.GetType())
 		{
-			v = value;
+			v = std::move(value);
 		}
 		else if (v.IsVector())
 		{
-			if (index < v.Len() && index != -1)
+			if (index < size_t(v.Len()) && index != size_t(-1))
 			{
 				if (v.IsVecBool())
 					v.SetValueAt(value.BoolValue(), index);
@@ -175,18 +334,18 @@ bool Literal::SetParameter(const std::string& name, Literal value, size_t index)
 				else if (v.IsVecStruct())
 					v.SetValueAt(value, index);
 			}
-			else if (-1 == index)
+			else if (size_t(-1) == index)
 			{
-				printf("No vector index provided.\n");
+				Output::Report("No vector index provided.\n");
 			}
 			else
 			{
-				printf("%s\n", ("Vector index [" + std::to_string(index) + "] out of bounds during assignment (Size: " + std::to_string(v.Len()) + ").").c_str());
+				Output::Report("%s\n", ("Vector index [" + std::to_string(index) + "] out of bounds during assignment (Size: " + std::to_string(v.Len()) + ").").c_str());
 			}
 		}
 		else
 		{
-			printf("%s\n", ("Unable to cast between types during assignment (" + v.ToString() + ", " + value.ToString() + ").\n").c_str());
+			Output::Report("%s\n", ("Unable to cast between types during assignment (" + v.ToString() + ", " + value.ToString() + ").\n").c_str());
 		}
 	}
 
@@ -199,6 +358,7 @@ void Literal::SetCallable(FunctionStmt* stmt)
 {
 	m_ftnStmt = stmt;
 	m_arity = stmt->GetParams().size();
+	m_explicitArgs = true;
 	m_type = LITERAL_TYPE_TT_FUNCTION;
 	m_fqns = stmt->FQNS();
 }
@@ -208,6 +368,7 @@ void Literal::SetCallable(StructStmt* stmt)
 {
 	m_stuctStmt = stmt;
 	m_arity = 0;
+	m_explicitArgs = true;
 	m_type = LITERAL_TYPE_TT_STRUCT;
 	m_fqns = stmt->FQNS();
 }
@@ -216,11 +377,159 @@ void Literal::SetCallable(FunctorExpr* expr)
 {
 	m_functorExpr = expr;
 	m_arity = expr->GetParams().size();
+	m_explicitArgs = true;
 	m_type = LITERAL_TYPE_FUNCTOR;
 	m_fqns = expr->FQNS();
 }
 
 
+void Literal::AppendTo(std::string& out) const
+{
+	char buf[24];
+	switch (m_type)
+	{
+	case LITERAL_TYPE_INTEGER:
+		out.append(buf, std::to_chars(buf, buf + sizeof(buf), m_intValue).ptr);
+		return;
+
+	case LITERAL_TYPE_DOUBLE:
+		AppendDouble(out, m_doubleValue);
+		return;
+
+	case LITERAL_TYPE_STRING:
+		out.append(m_stringValue);
+		return;
+
+	case LITERAL_TYPE_BOOL:
+		out.append(m_boolValue ? "true" : "false");
+		return;
+
+	case LITERAL_TYPE_STRBUF:
+		out.append(*m_strbuf);
+		return;
+
+	case LITERAL_TYPE_VEC:
+		// numbers go straight into out
+		if (LITERAL_TYPE_INTEGER == m_vecType || LITERAL_TYPE_DOUBLE == m_vecType)
+		{
+			bool isInt = LITERAL_TYPE_INTEGER == m_vecType;
+			size_t n = isInt ? m_vecValue_i.Get().size() : m_vecValue_d.Get().size();
+			out.append(isInt ? "<Vec,i32,Size:" : "<Vec,f32,Size:");
+			out.append(buf, std::to_chars(buf, buf + sizeof(buf), n).ptr);
+			out.append(">[");
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (0 != i) out.append(", ");
+				if (isInt) out.append(buf, std::to_chars(buf, buf + sizeof(buf), m_vecValue_i.Get()[i]).ptr);
+				else AppendDouble(out, m_vecValue_d.Get()[i]);
+			}
+			out.push_back(']');
+			return;
+		}
+		out.append(ToString());
+		return;
+
+	default:
+		out.append(ToString());
+		return;
+	}
+}
+
+void Literal::SetShortest(bool shortest)
+{
+	s_shortest = shortest;
+}
+
+void Literal::AppendDouble(std::string& out, double value)
+{
+	// wide enough for any f32 in fixed notation
+	char buf[400];
+	if (s_shortest.load(std::memory_order_relaxed)) out.append(buf, std::to_chars(buf, buf + sizeof(buf), value).ptr);
+	else out.append(buf, std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 6).ptr); // like std::to_string
+}
+
+// where a number starts, past leading spaces and a + sign
+static const char* NumberStart(const std::string& text)
+{
+	const char* p = text.c_str();
+	while (isspace((unsigned char)*p)) ++p;
+	if ('+' == *p && '-' != p[1]) ++p;
+	return p;
+}
+
+int32_t Literal::ParseInt(const std::string& text)
+{
+	int32_t value = 0;
+	std::from_chars(NumberStart(text), text.c_str() + text.size(), value);
+	return value;
+}
+
+double Literal::ParseDouble(const std::string& text)
+{
+	double value = 0;
+	std::from_chars(NumberStart(text), text.c_str() + text.size(), value);
+	return value;
+}
+
+Literal Literal::CastVec(LiteralTypeEnum vecType) const
+{
+	if (LITERAL_TYPE_VEC != m_type) return Literal();
+	if (vecType == m_vecType) return *this;
+
+	if (LITERAL_TYPE_STRING == m_vecType && (LITERAL_TYPE_INTEGER == vecType || LITERAL_TYPE_DOUBLE == vecType))
+	{
+		const std::vector<std::string>& from = m_vecValue_s.Get();
+		if (LITERAL_TYPE_INTEGER == vecType)
+		{
+			std::vector<int32_t> to(from.size());
+			for (size_t i = 0; i < from.size(); ++i) to[i] = ParseInt(from[i]);
+			return Literal(std::move(to));
+		}
+		std::vector<double> to(from.size());
+		for (size_t i = 0; i < from.size(); ++i) to[i] = ParseDouble(from[i]);
+		return Literal(std::move(to));
+	}
+
+	if (LITERAL_TYPE_INTEGER == m_vecType || LITERAL_TYPE_DOUBLE == m_vecType)
+	{
+		const std::vector<int32_t>& ints = m_vecValue_i.Get();
+		const std::vector<double>& doubles = m_vecValue_d.Get();
+		bool isInt = LITERAL_TYPE_INTEGER == m_vecType;
+		size_t n = isInt ? ints.size() : doubles.size();
+
+		switch (vecType)
+		{
+		case LITERAL_TYPE_STRING:
+		{
+			std::vector<std::string> to(n);
+			char buf[16];
+			for (size_t i = 0; i < n; ++i)
+			{
+				if (isInt) to[i].assign(buf, std::to_chars(buf, buf + sizeof(buf), ints[i]).ptr);
+				else AppendDouble(to[i], doubles[i]);
+			}
+			return Literal(std::move(to));
+		}
+		case LITERAL_TYPE_INTEGER:
+		{
+			// converting an out of range double is undefined, NaN fails both tests
+			std::vector<int32_t> to(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				double d = doubles[i];
+				to[i] = d > -2147483649.0 && d < 2147483648.0 ? int32_t(d) : 0;
+			}
+			return Literal(std::move(to));
+		}
+		case LITERAL_TYPE_DOUBLE:
+			return Literal(std::vector<double>(ints.begin(), ints.end()));
+		default:
+			break;
+		}
+	}
+	return Literal();
+}
+
 std::string Literal::ToString() const
 {
 	switch (m_type)
@@ -238,7 +547,7 @@ std::string Literal::ToString() const
 	{
 		// destructure the structure
 		std::string ret = "<struct " + m_stuctStmt->Operator()->Lexeme() + "\n";
-		for (auto& value : m_parameters)
+		for (auto& value : m_parameters.Get())
 		{
 			ret.append("  param: " + value.first + " = " + value.second.ToString() + ",\n");
 		}
@@ -255,15 +564,26 @@ std::string Literal::ToString() const
 	case LITERAL_TYPE_FUNCTOR:
 		if (m_functorExpr) return "<anonymous ftn, arity=" + std::to_string(m_functorExpr->GetParams().size()) + ">";
 		return "<anonymous ftn, not assigned>";
+
+	case LITERAL_TYPE_CHANNEL:
+		return "<channel>";
+
+	case LITERAL_TYPE_GENERATOR:
+		return "<generator>";
+
+	case LITERAL_TYPE_STRBUF:
+		return "<strbuf>";
 	
 	case LITERAL_TYPE_BOOL:
 		return m_boolValue ? "true" : "false";
 
 	case LITERAL_TYPE_DOUBLE:
-		return std::to_string(m_doubleValue);
-
 	case LITERAL_TYPE_INTEGER:
-		return std::to_string(m_intValue);
+	{
+		std::string ret;
+		AppendTo(ret);
+		return ret;
+	}
 
 	case LITERAL_TYPE_RANGE:
 		return "<Range [" + std::to_string(m_leftValue) + ", " + std::to_string(m_rightValue) + ")>";
@@ -271,96 +591,75 @@ std::string Literal::ToString() const
 	case LITERAL_TYPE_VEC:
 	{
 		std::string ret;
+		if (LITERAL_TYPE_INTEGER == m_vecType || LITERAL_TYPE_DOUBLE == m_vecType)
+		{
+			AppendTo(ret);
+			return ret;
+		}
+
 		switch (m_vecType)
 		{
 		case LITERAL_TYPE_BOOL:
-			ret = "<Vec,bool,Size:" + std::to_string(m_vecValue_b.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_b.size(); ++i)
+			ret = "<Vec,bool,Size:" + std::to_string(m_vecValue_b.Get().size()) + ">[";
+			for (size_t i = 0; i < m_vecValue_b.Get().size(); ++i)
 			{
 				if (0 == i)
 				{
 					std::string s = "false";
-					if (m_vecValue_b[i]) s = "true";
+					if (m_vecValue_b.Get()[i]) s = "true";
 					ret.append(s);
 				}
 				else
 				{
 					std::string s = "false";
-					if (m_vecValue_b[i]) s = "true";
+					if (m_vecValue_b.Get()[i]) s = "true";
 					ret.append(", " + s);
 				}
 			}
 			break;
-		case LITERAL_TYPE_INTEGER:
-			ret = "<Vec,i32,Size:" + std::to_string(m_vecValue_i.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_i.size(); ++i)
-			{
-				if (0 == i)
-				{
-					ret.append(std::to_string(m_vecValue_i[i]));
-				}
-				else
-				{
-					ret.append(", " + std::to_string(m_vecValue_i[i]));
-				}
-			}
-			break;
-		case LITERAL_TYPE_DOUBLE:
-			ret = "<Vec,f32,Size:" + std::to_string(m_vecValue_d.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_d.size(); ++i)
-			{
-				if (0 == i)
-				{
-					ret.append(std::to_string(m_vecValue_d[i]));
-				}
-				else
-				{
-					ret.append(", " + std::to_string(m_vecValue_d[i]));
-				}
-			}
-			break;
 		case LITERAL_TYPE_STRING:
-			ret = "<Vec,string,Size:" + std::to_string(m_vecValue_s.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_s.size(); ++i)
+			ret = "<Vec,string,Size:" + std::to_string(m_vecValue_s.Get().size()) + ">[";
+			for (size_t i = 0; i < m_vecValue_s.Get().size(); ++i)
 			{
 				if (0 == i)
 				{
-					ret.append(m_vecValue_s[i]);
+					ret.append(m_vecValue_s.Get()[i]);
 				}
 				else
 				{
-					ret.append(", " + m_vecValue_s[i]);
+					ret.append(", " + m_vecValue_s.Get()[i]);
 				}
 			}
 			break;
 		case LITERAL_TYPE_ENUM:
-			ret = "<Vec,enum,Size:" + std::to_string(m_vecValue_e.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_e.size(); ++i)
+			ret = "<Vec,enum,Size:" + std::to_string(m_vecValue_e.Get().size()) + ">[";
+			for (size_t i = 0; i < m_vecValue_e.Get().size(); ++i)
 			{
 				if (0 == i)
 				{
-					ret.append(m_vecValue_e[i].enumValue);
+					ret.append(m_vecValue_e.Get()[i].enumValue);
 				}
 				else
 				{
-					ret.append(", " + m_vecValue_e[i].enumValue);
+					ret.append(", " + m_vecValue_e.Get()[i].enumValue);
 				}
 			}
 			break;
 		case LITERAL_TYPE_TT_STRUCT:
-			ret = "<Vec,struct,Size:" + std::to_string(m_vecValue_u.size()) + ">[";
-			for (size_t i = 0; i < m_vecValue_u.size(); ++i)
+			ret = "<Vec,struct,Size:" + std::to_string(m_vecValue_u.Get().size()) + ">[";
+			for (size_t i = 0; i < m_vecValue_u.Get().size(); ++i)
 			{
 				if (0 == i)
 				{
-					ret.append(m_vecValue_u[i].ToString());
+					ret.append(m_vecValue_u.Get()[i].ToString());
 				}
 				else
 				{
-					ret.append(", " + m_vecValue_u[i].ToString());
+					ret.append(", " + m_vecValue_u.Get()[i].ToString());
 				}
 			}
 			break;
+		default: break;
 		};
 		
 		return ret + "]";
@@ -370,8 +669,8 @@ std::string Literal::ToString() const
 	{
 		std::string ret = "<Map,";
 
-		LiteralTypeEnum keyType = m_mapValue.keyType;
-		LiteralTypeEnum valueType = m_mapValue.valueType;
+		LiteralTypeEnum keyType = m_mapValue.Get().keyType;
+		LiteralTypeEnum valueType = m_mapValue.Get().valueType;
 
 		if (LITERAL_TYPE_INTEGER == keyType) ret.append("i32");
 		else if (LITERAL_TYPE_STRING == keyType) ret.append("string");
@@ -395,7 +694,7 @@ std::string Literal::ToString() const
 		if (LITERAL_TYPE_INTEGER == keyType)
 		{
 			int i = 0;
-			for (auto& v : m_mapValue.intMap)
+			for (auto& v : m_mapValue.Get().intMap)
 			{
 				if (0 == i)
 				{
@@ -411,7 +710,7 @@ std::string Literal::ToString() const
 		else if (LITERAL_TYPE_STRING == keyType)
 		{
 			int i = 0;
-			for (auto& v : m_mapValue.stringMap)
+			for (auto& v : m_mapValue.Get().stringMap)
 			{
 				if (0 == i)
 				{
@@ -427,7 +726,7 @@ std::string Literal::ToString() const
 		else if (LITERAL_TYPE_ENUM == keyType)
 		{
 			int i = 0;
-			for (auto& v : m_mapValue.enumMap)
+			for (auto& v : m_mapValue.Get().enumMap)
 			{
 				if (0 == i)
 				{
@@ -450,7 +749,7 @@ std::string Literal::ToString() const
 	case LITERAL_TYPE_FONT:
 		return "<raylib Font>";
 
-	case TOKEN_VAR_IMAGE:
+	case LITERAL_TYPE_IMAGE:
 		return "<raylib Image>";
 
 	case LITERAL_TYPE_TEXTURE:
@@ -10,6 +10,8 @@
 #include <cmath>
 #include <memory>
 
+#include "Enums.h"
+
 #ifndef NO_RAYLIB
 #include <raylib.h>
 #endif
@@ -18,10 +20,19 @@ class FunctionStmt;
 class StructStmt;
 class FunctorExpr;
 class Interpreter;
+class Environment;
+class Channel;
+class Generator;
+class Memo;
+struct InlineBody;
+class NativeCode;
 class Literal;
 
 typedef std::vector<Literal> LiteralList;
 
+// native callables read their arguments in place from the caller's list
+typedef std::function<Literal(const LiteralList& args)> NativeFunction;
+
 enum LiteralTypeEnum
 {
 	LITERAL_TYPE_INVALID,
@@ -39,6 +50,9 @@ enum LiteralTypeEnum
 	LITERAL_TYPE_TT_FUNCTION,
 	LITERAL_TYPE_TT_STRUCT,
 	LITERAL_TYPE_FUNCTOR,
+	LITERAL_TYPE_CHANNEL,
+	LITERAL_TYPE_GENERATOR,
+	LITERAL_TYPE_STRBUF,
 
 	// raylib custom
 	LITERAL_TYPE_FONT,
@@ -73,6 +87,49 @@ struct FunctorLiteral
 {
 };
 
+// copy on write storage for the larger payloads, copies share one buffer until
+// one of them is written, so copying a vector, map or struct instance is O(1)
+template <typename T>
+class Shared
+{
+public:
+	Shared() {}
+	Shared(T value) : m_ptr(std::make_shared<T>(std::move(value))) {}
+
+	const T& Get() const
+	{
+		static const T empty;
+		return m_ptr ? *m_ptr : empty;
+	}
+
+	// unique buffer for writing
+	T& Edit()
+	{
+		if (!m_ptr) m_ptr = std::make_shared<T>();
+		else if (1 != m_ptr.use_count()) m_ptr = std::make_shared<T>(*m_ptr);
+		return *m_ptr;
+	}
+
+private:
+	std::shared_ptr<T> m_ptr;
+};
+
+#ifdef LITERAL_COUNT_COPIES
+#include <atomic>
+
+// build with -DLITERAL_COUNT_COPIES to count Literal copies, moves are not counted
+struct CopyCounter
+{
+	static std::atomic<uint64_t>& Count() { static std::atomic<uint64_t> n(0); return n; }
+
+	CopyCounter() {}
+	CopyCounter(const CopyCounter&) { Count().fetch_add(1, std::memory_order_relaxed); }
+	CopyCounter(CopyCounter&&) noexcept {}
+	CopyCounter& operator=(const CopyCounter&) { Count().fetch_add(1, std::memory_order_relaxed); return *this; }
+	CopyCounter& operator=(CopyCounter&&) noexcept { return *this; }
+};
+#endif
+
 class Literal
 {
 public:
@@ -84,6 +141,13 @@ public:
 		m_isInstance = false;
 	}
 
+	// moves leave the source holding empty payloads, the interpreter moves values
+	// through returns, definitions and assignments instead of copying them
+	Literal(const Literal&) = default;
+	Literal(Literal&&) noexcept = default;
+	Literal& operator=(const Literal&) = default;
+	Literal& operator=(Literal&&) noexcept = default;
+
 	Literal(double val)
 	{
 		m_doubleValue = val;
@@ -100,32 +164,32 @@ public:
 
 	Literal(std::string val)
 	{
-		m_stringValue = val;
+		m_stringValue = std::move(val);
 		m_type = LITERAL_TYPE_STRING;
 	}
 
 	Literal(EnumLiteral val)
 	{
-		m_enumValue = val;
+		m_enumValue = std::move(val);
 		m_type = LITERAL_TYPE_ENUM;
 	}
 
 	Literal(MapLiteral val)
 	{
-		m_mapValue = val;
+		m_mapValue = std::move(val);
 		m_type = LITERAL_TYPE_MAP;
 	}
 
 	Literal(Literal key, Literal value)
 	{
-		m_pairKey = std::make_shared<Literal>(key);
-		m_pairValue = std::make_shared<Literal>(value);
+		m_pairKey = std::make_shared<Literal>(std::move(key));
+		m_pairValue = std::make_shared<Literal>(std::move(value));
 		m_type = LITERAL_TYPE_PAIR;
 	}
 
 	Literal(FunctorLiteral val)
 	{
-		m_functorValue = val;
+		m_functorValue = std::move(val);
 		m_type = LITERAL_TYPE_FUNCTOR;
 		m_functorExpr = nullptr;
 	}
@@ -136,6 +200,25 @@ public:
 		m_type = LITERAL_TYPE_BOOL;
 	}
 
+	Literal(std::shared_ptr<Channel> val)
+	{
+		m_channel = std::move(val);
+		m_type = LITERAL_TYPE_CHANNEL;
+	}
+
+	Literal(std::shared_ptr<Generator> val)
+	{
+		m_generator = std::move(val);
+		m_type = LITERAL_TYPE_GENERATOR;
+	}
+
+	// strbuf, copies share the buffer
+	Literal(std::shared_ptr<std::string> val)
+	{
+		m_strbuf = std::move(val);
+		m_type = LITERAL_TYPE_STRBUF;
+	}
+
 	Literal(int32_t lval, int32_t rval)
 	{
 		m_leftValue = lval;
@@ -147,37 +230,37 @@ public:
 
 	Literal(std::vector<bool> val)
 	{
-		m_vecValue_b = val;
+		m_vecValue_b = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = LITERAL_TYPE_BOOL;
 	}
 	Literal(std::vector<int32_t> val)
 	{
-		m_vecValue_i = val;
+		m_vecValue_i = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = LITERAL_TYPE_INTEGER;
 	}
 	Literal(std::vector<double> val)
 	{
-		m_vecValue_d = val;
+		m_vecValue_d = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = LITERAL_TYPE_DOUBLE;
 	}
 	Literal(std::vector<std::string> val)
 	{
-		m_vecValue_s = val;
+		m_vecValue_s = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = LITERAL_TYPE_STRING;
 	}
 	Literal(std::vector<EnumLiteral> val)
 	{
-		m_vecValue_e = val;
+		m_vecValue_e = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = LITERAL_TYPE_ENUM;
 	}
 	Literal(std::vector<Literal> val, LiteralTypeEnum vecType)
 	{
-		m_vecValue_u = val;
+		m_vecValue_u = std::move(val);
 		m_type = LITERAL_TYPE_VEC;
 		m_vecType = vecType;
 	}
@@ -217,10 +300,28 @@ public:
 	}
 #endif
 
-	Literal Call(Interpreter* interpreter, LiteralList args);
+	// refs holds the caller's storage for arguments passed as &name, nullptr for the others
+	Literal Call(Interpreter* interpreter, const LiteralList& args, const std::vector<Literal*>* refs = nullptr);
+	// the arguments are moved into the parameters
+	Literal Call(Interpreter* interpreter, LiteralList&& args, const std::vector<Literal*>* refs = nullptr);
 
 	size_t Arity() { return m_arity; }
 
+	IntrinsicTypeEnum Intrinsic() const { return LITERAL_TYPE_FUNCTION == m_type ? m_intrinsic : INTRINSIC_NONE; }
+	void SetIntrinsic(IntrinsicTypeEnum intrinsic) { m_intrinsic = intrinsic; }
+
+	// def functions and functors, the calls that run a script body in a new frame
+	bool RunsFrame() const;
+
+	// results of a def pure function, nullptr for everything else
+	Memo* GetMemo() const;
+
+	// body of a def function that can be evaluated at the call site, nullptr for everything else
+	InlineBody* GetInline() const;
+
+	// compiled body of a def native function, nullptr for everything else
+	NativeCode* GetNative() const;
+
 	bool IsCallable() const { return m_type == LITERAL_TYPE_FUNCTION || m_type == LITERAL_TYPE_TT_FUNCTION || m_type == LITERAL_TYPE_TT_STRUCT || m_type == LITERAL_TYPE_FUNCTOR; }
 	bool ExplicitArgs() const { return m_explicitArgs; }
 	
@@ -236,6 +337,9 @@ public:
 	bool IsInvalid() const { return m_type == LITERAL_TYPE_INVALID; }
 	bool IsVector() const { return m_type == LITERAL_TYPE_VEC; }
 	bool IsMap() const { return m_type == LITERAL_TYPE_MAP; }
+	bool IsChannel() const { return m_type == LITERAL_TYPE_CHANNEL; }
+	bool IsGenerator() const { return m_type == LITERAL_TYPE_GENERATOR; }
+	bool IsStrbuf() const { return m_type == LITERAL_TYPE_STRBUF; }
 	bool IsInstance() const {
 		return (m_type == LITERAL_TYPE_TT_STRUCT && m_isInstance);
 	}
@@ -255,12 +359,12 @@ public:
 		switch (m_type)
 		{
 		case LITERAL_TYPE_VEC:
-			if (LITERAL_TYPE_BOOL == m_vecType) return m_vecValue_b.size();
-			if (LITERAL_TYPE_INTEGER == m_vecType) return m_vecValue_i.size();
-			if (LITERAL_TYPE_DOUBLE == m_vecType) return m_vecValue_d.size();
-			if (LITERAL_TYPE_STRING == m_vecType) return m_vecValue_s.size();
-			if (LITERAL_TYPE_ENUM == m_vecType) return m_vecValue_e.size();
-			if (LITERAL_TYPE_TT_STRUCT == m_vecType) return m_vecValue_u.size();
+			if (LITERAL_TYPE_BOOL == m_vecType) return m_vecValue_b.Get().size();
+			if (LITERAL_TYPE_INTEGER == m_vecType) return m_vecValue_i.Get().size();
+			if (LITERAL_TYPE_DOUBLE == m_vecType) return m_vecValue_d.Get().size();
+			if (LITERAL_TYPE_STRING == m_vecType) return m_vecValue_s.Get().size();
+			if (LITERAL_TYPE_ENUM == m_vecType) return m_vecValue_e.Get().size();
+			if (LITERAL_TYPE_TT_STRUCT == m_vecType) return m_vecValue_u.Get().size();
 			break;
 
 		case LITERAL_TYPE_STRING:
@@ -271,6 +375,7 @@ public:
 		case LITERAL_TYPE_INTEGER:
 			return 1;
 
+		default: break;
 		}
 		return 0;
 	}
@@ -282,10 +387,13 @@ public:
 	EnumLiteral EnumValue() const { return m_enumValue; }
 	double DoubleValue() const{ return m_doubleValue; }
 	int32_t IntValue() const{ return m_intValue; }
-	MapLiteral MapValue() const { return m_mapValue; }
+	MapLiteral MapValue() const { return m_mapValue.Get(); }
 	int32_t LeftValue() const{ return m_leftValue; }
 	int32_t RightValue() const{ return m_rightValue; }
 	std::pair<Literal, Literal> PairValue() const { return std::make_pair(*m_pairKey, *m_pairValue); }
+	const std::shared_ptr<Channel>& ChannelValue() const { return m_channel; }
+	const std::shared_ptr<Generator>& GeneratorValue() const { return m_generator; }
+	const std::shared_ptr<std::string>& StrbufValue() const { return m_strbuf; }
 
 #ifndef NO_RAYLIB
 	// ralylib custom
@@ -295,20 +403,29 @@ public:
 	const Sound& SoundValue() const { return m_sound; }
 	const Shader& ShaderValue() const { return m_shader; }
 	Image& ImageValue() { return m_image; }
+	const Image& ImageValue() const { return m_image; }
 #endif
 	
-	std::vector<bool> VecValue_B() const { return m_vecValue_b; }
-	bool VecValueAt_B(size_t i) const { return m_vecValue_b[i]; }
-	std::vector<int32_t> VecValue_I() const { return m_vecValue_i; }
-	int32_t VecValueAt_I(size_t i) const { return m_vecValue_i[i]; }
-	std::vector<double> VecValue_D() const { return m_vecValue_d; }
-	double VecValueAt_D(size_t i) const { return m_vecValue_d[i]; }
-	std::vector<std::string> VecValue_S() const { return m_vecValue_s; }
-	std::string VecValueAt_S(size_t i) const { return m_vecValue_s[i]; }
-	std::vector<EnumLiteral> VecValue_E() const { return m_vecValue_e; }
-	EnumLiteral VecValueAt_E(size_t i) const { return m_vecValue_e[i]; }
-	std::vector<Literal> VecValue_U() const { return m_vecValue_u; }
-	Literal VecValueAt_U(size_t i) const { return m_vecValue_u[i]; }
+	// in place access for native code that must not copy
+	const std::string& StringRef() const { return m_stringValue; }
+	const std::string& EnumRef() const { return m_enumValue.enumValue; }
+	const std::vector<int32_t>& VecRef_I() const { return m_vecValue_i.Get(); }
+	const std::vector<double>& VecRef_D() const { return m_vecValue_d.Get(); }
+	const std::vector<std::string>& VecRef_S() const { return m_vecValue_s.Get(); }
+	const MapLiteral& MapRef() const { return m_mapValue.Get(); }
+
+	std::vector<bool> VecValue_B() const { return m_vecValue_b.Get(); }
+	bool VecValueAt_B(size_t i) const { return m_vecValue_b.Get()[i]; }
+	std::vector<int32_t> VecValue_I() const { return m_vecValue_i.Get(); }
+	int32_t VecValueAt_I(size_t i) const { return m_vecValue_i.Get()[i]; }
+	std::vector<double> VecValue_D() const { return m_vecValue_d.Get(); }
+	double VecValueAt_D(size_t i) const { return m_vecValue_d.Get()[i]; }
+	std::vector<std::string> VecValue_S() const { return m_vecValue_s.Get(); }
+	std::string VecValueAt_S(size_t i) const { return m_vecValue_s.Get()[i]; }
+	std::vector<EnumLiteral> VecValue_E() const { return m_vecValue_e.Get(); }
+	EnumLiteral VecValueAt_E(size_t i) const { return m_vecValue_e.Get()[i]; }
+	std::vector<Literal> VecValue_U() const { return m_vecValue_u.Get(); }
+	Literal VecValueAt_U(size_t i) const { return m_vecValue_u.Get()[i]; }
 	
 	LiteralTypeEnum GetVecType() const { return m_vecType; }
 	bool IsVecBool() const { return LITERAL_TYPE_BOOL == m_vecType; }
@@ -319,68 +436,116 @@ public:
 	bool IsVecStruct() const { return LITERAL_TYPE_TT_STRUCT == m_vecType; }
 	bool IsVecAnonymous() const { return LITERAL_TYPE_ANONYMOUS == m_vecType; }
 
-	LiteralTypeEnum GetMapKeyType() const { return m_mapValue.keyType; }
-	LiteralTypeEnum GetMapValueType() const { return m_mapValue.valueType; }
+	LiteralTypeEnum GetMapKeyType() const { return m_mapValue.Get().keyType; }
+	LiteralTypeEnum GetMapValueType() const { return m_mapValue.Get().valueType; }
 	
 
 	Literal GetParameter(const std::string& name);
+	// read in place, nullptr when there is no such field
+	const Literal* FindParameter(const std::string& name) const;
+	// written in place, detaches the fields from any copies of the instance
+	Literal* EditParameter(const std::string& name);
 	bool SetParameter(const std::string& name, Literal value, size_t index);
 
+	// struct instances by field, for rebuilding them in another interpreter
+	std::string StructName() const;
+	const std::string& FQNS() const { return m_fqns; }
+	const std::map<std::string, Literal>& Parameters() const { return m_parameters.Get(); }
+	Literal Instance(std::map<std::string, Literal> parameters) const
+	{
+		Literal ret = Literal(*this);
+		ret.m_isInstance = true;
+		ret.m_parameters = Shared<std::map<std::string, Literal> >(std::move(parameters));
+		return ret;
+	}
+
 	void SetCallable(FunctionStmt* stmt);
 	void SetCallable(StructStmt* stmt);
 	void SetCallable(FunctorExpr* expr);
 
-	void SetCallable(int nArgs, std::function<Literal(LiteralList args)> ftn, std::string fqns, bool explicitArgs = true)
+	void SetCallable(int nArgs, NativeFunction ftn, std::string fqns, bool explicitArgs = true)
 	{
 		m_explicitArgs = explicitArgs;
 		m_arity = nArgs;
 		m_ftn = ftn;
 		m_type = LITERAL_TYPE_FUNCTION;
 		m_fqns = fqns;
+		m_intrinsic = INTRINSIC_NONE;
 	}
 
 	// set values in maps
 	void SetMapValueAt_I(std::shared_ptr<Literal> value, int idx)
 	{
-		m_mapValue.intMap[idx] = value;
+		m_mapValue.Edit().intMap[idx] = value;
 	}
 	void SetMapValueAt_S(std::shared_ptr<Literal> value, std::string idx)
 	{
-		m_mapValue.stringMap[idx] = value;
+		m_mapValue.Edit().stringMap[idx] = value;
 	}
 	void SetMapValueAt_E(std::shared_ptr<Literal> value, std::string idx)
 	{
-		m_mapValue.enumMap[idx] = value;
+		m_mapValue.Edit().enumMap[idx] = value;
+	}
+
+	// give a vector its own buffer up front, after that SetValueAt writes in place as long as the value is not copied
+	void Unshare()
+	{
+		if (LITERAL_TYPE_BOOL == m_vecType) m_vecValue_b.Edit();
+		else if (LITERAL_TYPE_INTEGER == m_vecType) m_vecValue_i.Edit();
+		else if (LITERAL_TYPE_DOUBLE == m_vecType) m_vecValue_d.Edit();
+		else if (LITERAL_TYPE_STRING == m_vecType) m_vecValue_s.Edit();
+		else if (LITERAL_TYPE_ENUM == m_vecType) m_vecValue_e.Edit();
+		else if (LITERAL_TYPE_TT_STRUCT == m_vecType) m_vecValue_u.Edit();
 	}
 
 	// set values in arrays
 	void SetValueAt(bool value, size_t index)
 	{
-		m_vecValue_b[index] = value;
+		m_vecValue_b.Edit()[index] = value;
 	}
 	void SetValueAt(int32_t value, size_t index)
 	{
-		m_vecValue_i[index] = value;
+		m_vecValue_i.Edit()[index] = value;
 	}
 	void SetValueAt(double value, size_t index)
 	{
-		m_vecValue_d[index] = value;
+		m_vecValue_d.Edit()[index] = value;
 	}
 	void SetValueAt(std::string value, size_t index)
 	{
-		m_vecValue_s[index] = value;
+		m_vecValue_s.Edit()[index] = value;
 	}
 	void SetValueAt(EnumLiteral value, size_t index)
 	{
-		m_vecValue_e[index] = value;
+		m_vecValue_e.Edit()[index] = value;
 	}
 	void SetValueAt(Literal value, size_t index)
 	{
-		m_vecValue_u[index] = value;
+		m_vecValue_u.Edit()[index] = value;
 	}
 
+	// update a number or string in place, the type stays the same
+	void SetInt(int32_t val) { m_intValue = val; m_doubleValue = double(val); }
+	void SetDouble(double val) { m_doubleValue = val; m_intValue = int32_t(val); }
+	std::string& StringEdit() { return m_stringValue; }
+
 
 	std::string ToString() const;
+	// the same text appended to out, numbers and strings without a temporary
+	void AppendTo(std::string& out) const;
+
+	// f32 text with the fewest digits that read back the same value instead of six decimals, for every thread
+	static void SetShortest(bool shortest);
+	static void AppendDouble(std::string& out, double value);
+
+	// text to numbers like stoi and stod, leading spaces and a + are skipped and the number ends
+	// at the first character that can not continue it, 0 when there is none or it does not fit
+	static int32_t ParseInt(const std::string& text);
+	static double ParseDouble(const std::string& text);
+
+	// vec<string>, vec<i32> and vec<f32> converted element by element, invalid for other types.
+	// f32 to i32 truncates, and like ParseInt gives 0 for NaN and values that do not fit
+	Literal CastVec(LiteralTypeEnum vecType) const;
 
 	bool Equals(const Literal& val) const
 	{
@@ -440,22 +605,31 @@ public:
 
 private:
 
+	// define the parameters of a def function or functor in its call scope
+	bool BindParameters(Environment* env, LiteralList& args, const std::vector<Literal*>* refs) const;
+
+	// run a def function or functor body, following tail calls
+	Literal RunFrames(Interpreter* interpreter, LiteralList& args, const std::vector<Literal*>* refs) const;
+
 	double m_doubleValue;
 	int32_t m_intValue;
 	int32_t m_leftValue;
 	int32_t m_rightValue;
 	std::string m_stringValue;
 	EnumLiteral m_enumValue;
-	MapLiteral m_mapValue;
+	Shared<MapLiteral> m_mapValue;
 	std::shared_ptr<Literal> m_pairKey;
 	std::shared_ptr<Literal> m_pairValue;
+	std::shared_ptr<Channel> m_channel;
+	std::shared_ptr<Generator> m_generator;
+	std::shared_ptr<std::string> m_strbuf;
 	FunctorLiteral m_functorValue;
-	std::vector<bool> m_vecValue_b;
-	std::vector<int32_t> m_vecValue_i;
-	std::vector<double> m_vecValue_d;
-	std::vector<std::string> m_vecValue_s;
-	std::vector<EnumLiteral> m_vecValue_e;
-	std::vector<Literal> m_vecValue_u;
+	Shared<std::vector<bool> > m_vecValue_b;
+	Shared<std::vector<int32_t> > m_vecValue_i;
+	Shared<std::vector<double> > m_vecValue_d;
+	Shared<std::vector<std::string> > m_vecValue_s;
+	Shared<std::vector<EnumLiteral> > m_vecValue_e;
+	Shared<std::vector<Literal> > m_vecValue_u;
 	bool m_boolValue;
 	bool m_explicitArgs;
 	LiteralTypeEnum m_type;
@@ -463,12 +637,13 @@ private:
 	bool m_isInstance;
 
 	int m_arity;
-	std::function<Literal(LiteralList args)> m_ftn;
+	NativeFunction m_ftn;
+	IntrinsicTypeEnum m_intrinsic = INTRINSIC_NONE;
 	FunctionStmt* m_ftnStmt;
 	FunctorExpr* m_functorExpr;
 	
 	StructStmt* m_stuctStmt;
-	std::map<std::string, Literal> m_parameters;
+	Shared<std::map<std::string, Literal> > m_parameters;
 
 	std::string m_fqns;
 	
@@ -483,6 +658,9 @@ private:
 	Shader m_shader;
 #endif
 
+#ifdef LITERAL_COUNT_COPIES
+	CopyCounter m_copies;
+#endif
 };
 
 typedef std::pair<Literal, Literal> PairLiteral;
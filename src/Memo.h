@@ -0,0 +1,145 @@
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <string.h>
+#include <stdint.h>
+
+#include "Literal.h"
+
+
+// Results of a pure function by argument values. The least recently used
+// entry is dropped once the memo is full. Shared by every thread running
+// the function, parallel for bodies included.
+class Memo
+{
+public:
+
+	static const size_t CAPACITY = 1024;
+
+	// longest vector argument that is still worth hashing
+	static const size_t MAX_VEC = 64;
+
+	// flatten the arguments into a key, false when one of them can not be compared by value
+	static bool Key(const LiteralList& args, std::string& key)
+	{
+		for (const Literal& arg : args)
+		{
+			if (!Put(arg, key)) return false;
+		}
+		return true;
+	}
+
+	// copies the cached result into value on a hit
+	bool Find(const std::string& key, Literal& value)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		auto it = m_index.find(key);
+		if (m_index.end() == it)
+		{
+			m_misses++;
+			return false;
+		}
+
+		m_hits++;
+		m_order.splice(m_order.begin(), m_order, it->second);
+		value = it->second->second;
+		return true;
+	}
+
+	void Insert(std::string key, const Literal& value)
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		auto it = m_index.find(key);
+		if (m_index.end() != it)
+		{
+			// another thread got there first
+			it->second->second = value;
+			return;
+		}
+
+		if (m_order.size() >= CAPACITY)
+		{
+			m_index.erase(m_order.back().first);
+			m_order.pop_back();
+		}
+
+		m_order.emplace_front(std::move(key), value);
+		m_index.emplace(m_order.front().first, m_order.begin());
+	}
+
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_lock);
+		m_index.clear();
+		m_order.clear();
+		m_hits = 0;
+		m_misses = 0;
+	}
+
+	size_t Hits() { std::lock_guard<std::mutex> lock(m_lock); return m_hits; }
+	size_t Misses() { std::lock_guard<std::mutex> lock(m_lock); return m_misses; }
+	size_t Size() { std::lock_guard<std::mutex> lock(m_lock); return m_order.size(); }
+
+private:
+
+	static void PutBytes(std::string& out, const void* p, size_t n) { out.append((const char*)p, n); }
+
+	static void PutString(std::string& out, const std::string& s)
+	{
+		uint32_t n = uint32_t(s.size());
+		PutBytes(out, &n, sizeof(n));
+		out.append(s);
+	}
+
+	static bool Put(const Literal& value, std::string& out)
+	{
+		LiteralTypeEnum type = value.GetType();
+		out.push_back(char(type));
+
+		switch (type)
+		{
+		case LITERAL_TYPE_DOUBLE: { double d = value.DoubleValue(); PutBytes(out, &d, sizeof(d)); return true; }
+		case LITERAL_TYPE_INTEGER: { int32_t i = value.IntValue(); PutBytes(out, &i, sizeof(i)); return true; }
+		case LITERAL_TYPE_BOOL: out.push_back(char(value.BoolValue())); return true;
+		case LITERAL_TYPE_STRING: PutString(out, value.StringRef()); return true;
+		case LITERAL_TYPE_ENUM: PutString(out, value.EnumRef()); return true;
+		case LITERAL_TYPE_VEC:
+		{
+			LiteralTypeEnum vecType = value.GetVecType();
+			uint32_t n = uint32_t(value.Len());
+			if (n > MAX_VEC) return false;
+			out.push_back(char(vecType));
+			PutBytes(out, &n, sizeof(n));
+
+			if (LITERAL_TYPE_INTEGER == vecType) PutBytes(out, value.VecRef_I().data(), n * sizeof(int32_t));
+			else if (LITERAL_TYPE_DOUBLE == vecType) PutBytes(out, value.VecRef_D().data(), n * sizeof(double));
+			else
+			{
+				for (uint32_t i = 0; i < n; ++i)
+				{
+					if (LITERAL_TYPE_BOOL == vecType) out.push_back(char(value.VecValueAt_B(i)));
+					else if (LITERAL_TYPE_STRING == vecType) PutString(out, value.VecValueAt_S(i));
+					else if (LITERAL_TYPE_ENUM == vecType) PutString(out, value.VecValueAt_E(i).enumValue);
+					else return false;
+				}
+			}
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	std::mutex m_lock;
+	std::list<std::pair<std::string, Literal> > m_order;
+	std::unordered_map<std::string, std::list<std::pair<std::string, Literal> >::iterator> m_index;
+	size_t m_hits = 0;
+	size_t m_misses = 0;
+};
+
+#endif // MEMO_H
@@ -0,0 +1,786 @@
+#ifndef NATIVE_CODE_H
+#define NATIVE_CODE_H
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Environment.h"
+#include "Expressions.h"
+#include "Statements.h"
+
+
+// Body of a def native function translated to C, built with the system
+// compiler and loaded as a shared object. Every signature of i32, f32,
+// vec<i32> and vec<f32> arguments is compiled on its first call, objects are
+// kept on disk by a hash of the generated source so later runs only load
+// them. Bodies outside the numeric subset stay interpreted, as do calls whose
+// compiled code hits an out of bounds index or a modulo by zero, those are
+// run again by the interpreter so its errors are the ones reported.
+// The cache is per user, objects in it are only loaded when the directory and
+// the file belong to the current user and nobody else can write to them.
+// The first call with a signature waits for the compiler while holding the
+// function's lock, other threads calling the function wait with it.
+class NativeCode
+{
+public:
+
+	static const size_t MAX_ARGS = 16;
+
+	NativeCode(FunctionStmt* stmt) : m_stmt(stmt), m_compiled(0) {}
+
+	// run the compiled body, false when these arguments have to be interpreted
+	bool Run(Environment* globals, const LiteralList& args, Literal& ret)
+	{
+		if (args.size() > MAX_ARGS || args.size() != m_stmt->GetParams().size()) return false;
+
+		std::string signature;
+		for (const Literal& arg : args)
+		{
+			if (arg.IsInt()) signature.push_back('i');
+			else if (arg.IsDouble()) signature.push_back('d');
+			else if (arg.IsVector() && arg.IsVecInteger()) signature.push_back('I');
+			else if (arg.IsVector() && arg.IsVecDouble()) signature.push_back('D');
+			else return false;
+		}
+
+		EntryFn entry = nullptr;
+		{
+			// compiled under the lock, parallel for bodies and other callers wait for the first build
+			std::lock_guard<std::mutex> lock(m_lock);
+			auto it = m_entries.find(signature);
+			if (m_entries.end() == it)
+			{
+				entry = Build(globals, signature);
+				if (entry) m_compiled++;
+				m_entries[signature] = entry;
+			}
+			else
+			{
+				entry = it->second;
+			}
+		}
+		if (!entry) return false;
+
+		Arg a[MAX_ARGS];
+		for (size_t i = 0; i < args.size(); ++i)
+		{
+			switch (signature[i])
+			{
+			case 'i': a[i].i = args[i].IntValue(); break;
+			case 'd': a[i].d = args[i].DoubleValue(); break;
+			case 'I': a[i].p = args[i].VecRef_I().data(); a[i].n = int32_t(args[i].Len()); break;
+			case 'D': a[i].p = args[i].VecRef_D().data(); a[i].n = int32_t(args[i].Len()); break;
+			}
+		}
+
+		Arg r;
+		int kind = entry(a, &r);
+		if (0 == kind) return false;
+		ret = 1 == kind ? Literal(r.i) : Literal(r.d);
+		return true;
+	}
+
+	// argument signatures running compiled code
+	size_t Compiled() { std::lock_guard<std::mutex> lock(m_lock); return m_compiled; }
+
+private:
+
+	// layout shared with the generated tt_arg
+	struct Arg
+	{
+		int32_t i;
+		double d;
+		const void* p;
+		int32_t n;
+	};
+
+	// 0 when the interpreter has to take over, 1 for an i32 result in r->i, 2 for f32 in r->d
+	typedef int (*EntryFn)(const Arg* a, Arg* r);
+
+	enum Kind { KIND_NONE, KIND_INT, KIND_DOUBLE, KIND_BOOL, KIND_VEC_INT, KIND_VEC_DOUBLE };
+
+	struct Translation
+	{
+		Environment* globals;
+		std::string signature;
+		Kind ret;
+		std::vector<std::unordered_map<std::string, Kind> > scopes;
+		int loops;
+		bool fallible; // an expression since the last check can raise the error flag
+		std::string out;
+	};
+
+	static const char* Preamble()
+	{
+		return
+			"#include <stdint.h>\n"
+			"#include <float.h>\n"
+			"#include <math.h>\n"
+			"#ifdef _WIN32\n"
+			"#define TT_EXPORT __declspec(dllexport)\n"
+			"#else\n"
+			"#define TT_EXPORT\n"
+			"#endif\n"
+			"typedef struct { int32_t i; double d; const void* p; int32_t n; } tt_arg;\n"
+			"static int32_t tt_at_i(const int32_t* p, int32_t n, int32_t i, int* e) { if (i < 0 || i >= n) { *e = 1; return 0; } return p[i]; }\n"
+			"static double tt_at_d(const double* p, int32_t n, int32_t i, int* e) { if (i < 0 || i >= n) { *e = 1; return 0; } return p[i]; }\n"
+			"static int32_t tt_mod(int32_t l, int32_t r, int* e) { if (0 == r) { *e = 1; return 0; } return -1 == r ? 0 : l % r; }\n"
+			"static int tt_eq(double l, double r) { return !(fabs(l - r) > DBL_MIN); }\n"
+			"static double tt_min(double l, double r) { return r < l ? r : l; }\n"
+			"static double tt_max(double l, double r) { return r > l ? r : l; }\n";
+	}
+
+	EntryFn Build(Environment* globals, const std::string& signature)
+	{
+		// the return type is whichever one every return statement agrees on
+		std::string source;
+		if (!Translate(globals, signature, KIND_INT, source) && !Translate(globals, signature, KIND_DOUBLE, source)) return nullptr;
+		return Load(source);
+	}
+
+	bool Translate(Environment* globals, const std::string& signature, Kind ret, std::string& source)
+	{
+		Translation t;
+		t.globals = globals;
+		t.signature = signature;
+		t.ret = ret;
+		t.loops = 0;
+		t.fallible = false;
+		t.scopes.emplace_back();
+
+		const char* retType = KIND_INT == ret ? "int32_t" : "double";
+		std::string params = "int* e";
+		std::string args = "&e";
+		const TokenList& names = m_stmt->GetParams();
+		for (size_t i = 0; i < names.size(); ++i)
+		{
+			std::string name = Name(names[i].Lexeme());
+			std::string ai = "a[" + std::to_string(i) + "]";
+			if (name.empty()) return false;
+			switch (signature[i])
+			{
+			case 'i': params += ", int32_t " + name; args += ", " + ai + ".i"; t.scopes[0][names[i].Lexeme()] = KIND_INT; break;
+			case 'd': params += ", double " + name; args += ", " + ai + ".d"; t.scopes[0][names[i].Lexeme()] = KIND_DOUBLE; break;
+			case 'I': params += ", const int32_t* " + name + ", int32_t " + Len(name); args += ", (const int32_t*)" + ai + ".p, " + ai + ".n"; t.scopes[0][names[i].Lexeme()] = KIND_VEC_INT; break;
+			case 'D': params += ", const double* " + name + ", int32_t " + Len(name); args += ", (const double*)" + ai + ".p, " + ai + ".n"; t.scopes[0][names[i].Lexeme()] = KIND_VEC_DOUBLE; break;
+			}
+		}
+
+		// the body shares its C scope with the parameters
+		t.out = std::string("static ") + retType + " tt_f(" + params + ")\n{\n";
+		for (Stmt* s : *m_stmt->GetBody())
+		{
+			if (!Statement(t, s)) return false;
+		}
+
+		// falling off the end returns nothing, which only the interpreter can do
+		t.out += "*e = 1;\nreturn 0;\n}\n\n";
+
+		source = Preamble();
+		source += "\n" + t.out;
+		source += "TT_EXPORT int tt_entry(const tt_arg* a, tt_arg* r)\n{\n";
+		source += "int e = 0;\n";
+		source += std::string(retType) + " x = tt_f(" + args + ");\n";
+		source += "if (e) return 0;\n";
+		source += KIND_INT == ret ? "r->i = x;\nreturn 1;\n}\n" : "r->d = x;\nreturn 2;\n}\n";
+		return true;
+	}
+
+	// script names are prefixed so they can not collide with C
+	static std::string Name(const std::string& name)
+	{
+		for (char c : name)
+		{
+			if (!isalnum((unsigned char)c) && '_' != c) return "";
+		}
+		return "v_" + name;
+	}
+
+	static std::string Len(const std::string& name) { return "n" + name; }
+
+	static Kind Find(Translation& t, const std::string& name)
+	{
+		for (auto it = t.scopes.rbegin(); it != t.scopes.rend(); ++it)
+		{
+			auto found = it->find(name);
+			if (it->end() != found) return found->second;
+		}
+		return KIND_NONE;
+	}
+
+	static bool IsNumber(Kind k) { return KIND_INT == k || KIND_DOUBLE == k; }
+
+	static std::string AsDouble(const std::string& s) { return "((double)" + s + ")"; }
+
+	// leave once the statement has run if it raised the error flag
+	static void Check(Translation& t)
+	{
+		if (t.fallible) t.out += "if (*e) return 0;\n";
+		t.fallible = false;
+	}
+
+	bool Statement(Translation& t, Stmt* stmt)
+	{
+		switch (stmt->GetType())
+		{
+		case STATEMENT_BLOCK:
+		{
+			t.out += "{\n";
+			t.scopes.emplace_back();
+			for (Stmt* s : *((BlockStmt*)stmt)->GetBlock())
+			{
+				if (!Statement(t, s)) return false;
+			}
+			t.scopes.pop_back();
+			t.out += "}\n";
+			return true;
+		}
+
+		case STATEMENT_VAR:
+		{
+			VarStmt* v = (VarStmt*)stmt;
+			const std::string& lexeme = v->Operator()->Lexeme();
+			std::string name = Name(lexeme);
+			TokenTypeEnum type = v->VarType()->GetType();
+			if (name.empty() || t.scopes.back().count(lexeme)) return false;
+
+			std::string value = "0";
+			Kind kind = KIND_INT;
+			if (v->Expression())
+			{
+				kind = Expression(t, v->Expression(), value);
+				if (!IsNumber(kind)) return false;
+			}
+			else if (TOKEN_DEF == type)
+			{
+				return false;
+			}
+
+			if (TOKEN_VAR_I32 == type) kind = KIND_INT;
+			else if (TOKEN_VAR_F32 == type) kind = KIND_DOUBLE;
+			else if (TOKEN_DEF != type) return false;
+
+			t.out += KIND_INT == kind ? "int32_t " + name + " = (int32_t)" : "double " + name + " = (double)";
+			t.out += value + ";\n";
+			t.scopes.back()[lexeme] = kind;
+			Check(t);
+			return true;
+		}
+
+		case STATEMENT_EXPRESSION:
+		{
+			Expr* expr = Plain(stmt->Expression());
+			std::string assign;
+			if (EXPRESSION_ASSIGN != expr->GetType() || !Assign(t, (AssignExpr*)expr, assign)) return false;
+			t.out += assign + ";\n";
+			Check(t);
+			return true;
+		}
+
+		case STATEMENT_IF:
+		{
+			IfStmt* s = (IfStmt*)stmt;
+			std::string cond;
+			if (!Condition(t, s->GetCondition(), cond)) return false;
+
+			bool fallible = t.fallible;
+			t.fallible = false;
+			if (fallible) t.out += "{\nint tt_c = " + cond + ";\nif (*e) return 0;\nif (tt_c)\n";
+			else t.out += "if (" + cond + ")\n";
+			if (!Branch(t, s->GetThenBranch())) return false;
+			if (s->GetElseBranch())
+			{
+				t.out += "else\n";
+				if (!Branch(t, s->GetElseBranch())) return false;
+			}
+			if (fallible) t.out += "}\n";
+			return true;
+		}
+
+		case STATEMENT_WHILE:
+		{
+			WhileStmt* s = (WhileStmt*)stmt;
+			std::string cond, post;
+			if (!Condition(t, s->GetCondition(), cond)) return false;
+			Expr* step = s->GetPost() ? Plain(s->GetPost()) : nullptr;
+			if (step && (EXPRESSION_ASSIGN != step->GetType() || !Assign(t, (AssignExpr*)step, post))) return false;
+
+			// continue runs the post expression, as it does in the interpreter
+			if (t.fallible) t.out += "for (;; " + post + ")\n{\nint tt_c = " + cond + ";\nif (*e) return 0;\nif (!tt_c) break;\n";
+			else t.out += "for (; " + cond + "; " + post + ")\n{\n";
+			t.fallible = false;
+
+			t.loops++;
+			bool ok = Branch(t, s->GetBody());
+			t.loops--;
+			t.out += "}\n";
+			return ok;
+		}
+
+		case STATEMENT_BREAK:
+			if (0 == t.loops) return false;
+			t.out += "break;\n";
+			return true;
+
+		case STATEMENT_CONTINUE:
+			if (0 == t.loops) return false;
+			t.out += "continue;\n";
+			return true;
+
+		case STATEMENT_RETURN:
+		{
+			ReturnStmt* r = (ReturnStmt*)stmt;
+			std::string value;
+			if (!r->GetValueExpr() || t.ret != Expression(t, r->GetValueExpr(), value)) return false;
+			t.out += "return " + value + ";\n";
+			t.fallible = false;
+			return true;
+		}
+
+		default:
+			return false;
+		}
+	}
+
+	// if and loop bodies get their own scope even without braces
+	bool Branch(Translation& t, Stmt* stmt)
+	{
+		t.out += "{\n";
+		t.scopes.emplace_back();
+		bool ok = Statement(t, stmt);
+		t.scopes.pop_back();
+		t.out += "}\n";
+		return ok;
+	}
+
+	// a compound assignment as a statement is the assignment it stands for
+	static Expr* Plain(Expr* expr)
+	{
+		return EXPRESSION_COMPOUND == expr->GetType() ? ((CompoundExpr*)expr)->Fallback() : expr;
+	}
+
+	// whole number assignment, the value is cast to the variable's type like Environment::Assign does
+	bool Assign(Translation& t, AssignExpr* expr, std::string& out)
+	{
+		const std::string& lexeme = expr->Operator()->Lexeme();
+		Kind target = Find(t, lexeme);
+		if (expr->VecIndex() || !IsNumber(target)) return false;
+
+		std::string value;
+		if (!IsNumber(Expression(t, expr->Right(), value))) return false;
+		out = Name(lexeme) + (KIND_INT == target ? " = (int32_t)" : " = (double)") + value;
+		return true;
+	}
+
+	// truthiness as IsTruthy sees it, f32 is always true there so it is left to the interpreter
+	bool Condition(Translation& t, Expr* expr, std::string& out)
+	{
+		std::string value;
+		Kind kind = Expression(t, expr, value);
+		if (KIND_BOOL == kind) out = value;
+		else if (KIND_INT == kind) out = "(" + value + " != 0)";
+		else return false;
+		return true;
+	}
+
+	// translate expr into out, KIND_NONE when it can not be compiled
+	Kind Expression(Translation& t, Expr* expr, std::string& out)
+	{
+		switch (expr->GetType())
+		{
+		case EXPRESSION_LITERAL:
+		{
+			const Literal& v = ((LiteralExpr*)expr)->GetLiteral();
+			if (v.IsInt())
+			{
+				out = INT32_MIN == v.IntValue() ? "(-2147483647 - 1)" : "((int32_t)" + std::to_string(v.IntValue()) + ")";
+				return KIND_INT;
+			}
+			if (v.IsDouble())
+			{
+				if (!std::isfinite(v.DoubleValue())) return KIND_NONE;
+				char buffer[64];
+				snprintf(buffer, sizeof(buffer), "%.17g", v.DoubleValue());
+				out = buffer;
+				if (std::string::npos == out.find_first_of(".e")) out += ".0";
+				out = "(" + out + ")";
+				return KIND_DOUBLE;
+			}
+			if (v.IsBool())
+			{
+				out = v.BoolValue() ? "1" : "0";
+				return KIND_BOOL;
+			}
+			return KIND_NONE;
+		}
+
+		case EXPRESSION_VARIABLE:
+		{
+			VariableExpr* v = (VariableExpr*)expr;
+			const std::string& lexeme = v->Operator()->Lexeme();
+			Kind kind = Find(t, lexeme);
+			if (KIND_NONE == kind) return KIND_NONE;
+
+			std::string name = Name(lexeme);
+			if (!v->VecIndex())
+			{
+				// vectors are only read through an index, len() or a self call
+				if (!IsNumber(kind)) return KIND_NONE;
+				out = name;
+				return kind;
+			}
+
+			std::string index;
+			if ((KIND_VEC_INT != kind && KIND_VEC_DOUBLE != kind) || KIND_INT != Expression(t, v->VecIndex(), index)) return KIND_NONE;
+			out = (KIND_VEC_INT == kind ? "tt_at_i(" : "tt_at_d(") + name + ", " + Len(name) + ", " + index + ", e)";
+			t.fallible = true;
+			return KIND_VEC_INT == kind ? KIND_INT : KIND_DOUBLE;
+		}
+
+		case EXPRESSION_GROUP:
+		{
+			Kind kind = Expression(t, ((GroupExpr*)expr)->Expression(), out);
+			out = "(" + out + ")";
+			return kind;
+		}
+
+		case EXPRESSION_UNARY:
+		{
+			UnaryExpr* u = (UnaryExpr*)expr;
+			std::string right;
+			if (TOKEN_BANG == u->Operator()->GetType())
+			{
+				if (!Condition(t, u->Right(), right)) return KIND_NONE;
+				out = "(!" + right + ")";
+				return KIND_BOOL;
+			}
+
+			Kind kind = Expression(t, u->Right(), right);
+			if (TOKEN_TILDE == u->Operator()->GetType())
+			{
+				if (KIND_INT != kind) return KIND_NONE;
+				out = "(~" + right + ")";
+				return KIND_INT;
+			}
+			if (TOKEN_MINUS != u->Operator()->GetType() || !IsNumber(kind)) return KIND_NONE;
+			out = "(-" + right + ")";
+			return kind;
+		}
+
+		case EXPRESSION_LOGICAL:
+		{
+			LogicalExpr* l = (LogicalExpr*)expr;
+			std::string left, right;
+			if (!Condition(t, l->Left(), left) || !Condition(t, l->Right(), right)) return KIND_NONE;
+			out = "(" + left + (TOKEN_OR == l->Operator()->GetType() ? " || " : " && ") + right + ")";
+			return KIND_BOOL;
+		}
+
+		case EXPRESSION_BINARY:
+			return Binary(t, (BinaryExpr*)expr, out);
+
+		case EXPRESSION_CALL:
+			return SelfCall(t, (CallExpr*)expr, out);
+
+		case EXPRESSION_INTRINSIC:
+			return Intrinsic(t, (IntrinsicExpr*)expr, out);
+
+		default:
+			return KIND_NONE;
+		}
+	}
+
+	// same promotions as Interpreter::VisitBinary, i32 unless a side is f32 or it is a division
+	Kind Binary(Translation& t, BinaryExpr* b, std::string& out)
+	{
+		TokenTypeEnum op = b->Operator()->GetType();
+		std::string left, right;
+		Kind lk = Expression(t, b->Left(), left);
+
+		if (TOKEN_AS == op)
+		{
+			TokenTypeEnum type = EXPRESSION_VARIABLE == b->Right()->GetType() ? ((VariableExpr*)b->Right())->Operator()->GetType() : TOKEN_END_OF_FILE;
+			if (!IsNumber(lk) || (TOKEN_VAR_I32 != type && TOKEN_VAR_F32 != type)) return KIND_NONE;
+			out = (TOKEN_VAR_I32 == type ? "((int32_t)" : "((double)") + left + ")";
+			return TOKEN_VAR_I32 == type ? KIND_INT : KIND_DOUBLE;
+		}
+
+		Kind rk = Expression(t, b->Right(), right);
+		bool ints = KIND_INT == lk && KIND_INT == rk;
+
+		if (TOKEN_EQUAL_EQUAL == op || TOKEN_BANG_EQUAL == op)
+		{
+			const char* cmp = TOKEN_EQUAL_EQUAL == op ? " == " : " != ";
+			if (ints || (KIND_BOOL == lk && KIND_BOOL == rk)) out = "(" + left + cmp + right + ")";
+			else if (IsNumber(lk) && IsNumber(rk)) out = std::string(TOKEN_EQUAL_EQUAL == op ? "" : "!") + "tt_eq(" + left + ", " + right + ")";
+			else return KIND_NONE;
+			return KIND_BOOL;
+		}
+
+		if (!IsNumber(lk) || !IsNumber(rk)) return KIND_NONE;
+		if (!ints)
+		{
+			left = AsDouble(left);
+			right = AsDouble(right);
+		}
+
+		switch (op)
+		{
+		case TOKEN_PLUS: out = "(" + left + " + " + right + ")"; return ints ? KIND_INT : KIND_DOUBLE;
+		case TOKEN_MINUS: out = "(" + left + " - " + right + ")"; return ints ? KIND_INT : KIND_DOUBLE;
+		case TOKEN_STAR: out = "(" + left + " * " + right + ")"; return ints ? KIND_INT : KIND_DOUBLE;
+		case TOKEN_SLASH: out = "(" + AsDouble(left) + " / " + AsDouble(right) + ")"; return KIND_DOUBLE;
+		case TOKEN_LESS: out = "(" + left + " < " + right + ")"; return KIND_BOOL;
+		case TOKEN_LESS_EQUAL: out = "(" + left + " <= " + right + ")"; return KIND_BOOL;
+		case TOKEN_GREATER: out = "(" + left + " > " + right + ")"; return KIND_BOOL;
+		case TOKEN_GREATER_EQUAL: out = "(" + left + " >= " + right + ")"; return KIND_BOOL;
+
+		case TOKEN_AMPERSAND:
+		case TOKEN_PIPE:
+		case TOKEN_CARET:
+		{
+			if (!ints) return KIND_NONE;
+			const char* bit = TOKEN_AMPERSAND == op ? " & " : TOKEN_PIPE == op ? " | " : " ^ ";
+			out = "(" + left + bit + right + ")";
+			return KIND_INT;
+		}
+
+		case TOKEN_LESS_LESS:
+			if (!ints) return KIND_NONE;
+			out = "((int32_t)((uint32_t)" + left + " << (" + right + " & 31)))";
+			return KIND_INT;
+
+		case TOKEN_GREATER_GREATER:
+			if (!ints) return KIND_NONE;
+			out = "(" + left + " >> (" + right + " & 31))";
+			return KIND_INT;
+
+		case TOKEN_PERCENT:
+			if (!ints) return KIND_NONE;
+			out = "tt_mod(" + left + ", " + right + ", e)";
+			t.fallible = true;
+			return KIND_INT;
+
+		default:
+			return KIND_NONE;
+		}
+	}
+
+	// recursion with the same signature calls the compiled body directly
+	Kind SelfCall(Translation& t, CallExpr* call, std::string& out)
+	{
+		if (EXPRESSION_VARIABLE != call->GetCallee()->GetType()) return KIND_NONE;
+		VariableExpr* callee = (VariableExpr*)call->GetCallee();
+		const std::string& lexeme = callee->Operator()->Lexeme();
+		const ArgList& args = call->GetArguments();
+		if (callee->VecIndex() || lexeme != m_stmt->Operator()->Lexeme() || KIND_NONE != Find(t, lexeme)) return KIND_NONE;
+		if (args.size() != t.signature.size()) return KIND_NONE;
+
+		out = "tt_f(e";
+		for (size_t i = 0; i < args.size(); ++i)
+		{
+			char expected = t.signature[i];
+			if ('I' == expected || 'D' == expected)
+			{
+				// vectors are passed on as they came in
+				if (EXPRESSION_VARIABLE != args[i]->GetType() || ((VariableExpr*)args[i])->VecIndex()) return KIND_NONE;
+				const std::string& name = ((VariableExpr*)args[i])->Operator()->Lexeme();
+				if (('I' == expected ? KIND_VEC_INT : KIND_VEC_DOUBLE) != Find(t, name)) return KIND_NONE;
+				out += ", " + Name(name) + ", " + Len(Name(name));
+				continue;
+			}
+
+			std::string arg;
+			if (('i' == expected ? KIND_INT : KIND_DOUBLE) != Expression(t, args[i], arg)) return KIND_NONE;
+			out += ", " + arg;
+		}
+		out += ")";
+		t.fallible = true;
+		return t.ret;
+	}
+
+	// builtins compile while the name still resolves to them, see Interpreter::VisitIntrinsic
+	Kind Intrinsic(Translation& t, IntrinsicExpr* expr, std::string& out)
+	{
+		VariableExpr* callee = (VariableExpr*)expr->Call()->GetCallee();
+		if (KIND_NONE != Find(t, callee->Operator()->Lexeme())) return KIND_NONE;
+		bool isGlobal = false;
+		Literal* builtin = t.globals->Lookup(callee->Operator(), callee->FQNS(), isGlobal);
+		if (!builtin || builtin->Intrinsic() != expr->Intrinsic()) return KIND_NONE;
+
+		const ArgList& args = expr->GetArguments();
+		if (INTRINSIC_LEN == expr->Intrinsic())
+		{
+			if (1 != args.size() || EXPRESSION_VARIABLE != args[0]->GetType() || ((VariableExpr*)args[0])->VecIndex()) return KIND_NONE;
+			const std::string& name = ((VariableExpr*)args[0])->Operator()->Lexeme();
+			Kind kind = Find(t, name);
+			if (KIND_VEC_INT != kind && KIND_VEC_DOUBLE != kind) return KIND_NONE;
+			out = Len(Name(name));
+			return KIND_INT;
+		}
+
+		std::vector<std::string> values(args.size());
+		for (size_t i = 0; i < args.size(); ++i)
+		{
+			if (!IsNumber(Expression(t, args[i], values[i]))) return KIND_NONE;
+		}
+
+		size_t arity = INTRINSIC_MIN == expr->Intrinsic() || INTRINSIC_MAX == expr->Intrinsic() ? 2 : 1;
+		if (arity != values.size()) return KIND_NONE;
+
+		switch (expr->Intrinsic())
+		{
+		case INTRINSIC_MIN: out = "tt_min(" + AsDouble(values[0]) + ", " + AsDouble(values[1]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_MAX: out = "tt_max(" + AsDouble(values[0]) + ", " + AsDouble(values[1]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_SQRT: out = "sqrt(" + AsDouble(values[0]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_SIN: out = "sin(" + AsDouble(values[0]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_COS: out = "cos(" + AsDouble(values[0]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_FLOOR: out = "floor(" + AsDouble(values[0]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_FABS: out = "fabs(" + AsDouble(values[0]) + ")"; return KIND_DOUBLE;
+		case INTRINSIC_SGN: out = "(" + values[0] + " < 0 ? (int32_t)-1 : (int32_t)1)"; return KIND_INT;
+		default: return KIND_NONE;
+		}
+	}
+
+	///////////////////////
+
+	// FNV-1a
+	static uint64_t Hash(const std::string& s)
+	{
+		uint64_t h = 14695981039346656037ull;
+		for (unsigned char c : s)
+		{
+			h ^= c;
+			h *= 1099511628211ull;
+		}
+		return h;
+	}
+
+	// owned by this user and not writable by anyone else, on Windows the per user directory's ACL is relied on
+	static bool Trusted(const std::string& path, bool directory)
+	{
+#ifdef _WIN32
+		std::error_code ec;
+		return directory ? std::filesystem::is_directory(path, ec) : std::filesystem::is_regular_file(path, ec);
+#else
+		// a planted symlink is refused, the directory itself may be reached through one
+		struct stat st;
+		if (0 != (directory ? stat(path.c_str(), &st) : lstat(path.c_str(), &st))) return false;
+		if (directory ? !S_ISDIR(st.st_mode) : !S_ISREG(st.st_mode)) return false;
+		return st.st_uid == geteuid() && 0 == (st.st_mode & (S_IWGRP | S_IWOTH));
+#endif
+	}
+
+	// TT_NATIVE_CACHE or tentacode-native in the user's cache directory, empty when it can not be trusted
+	static std::string CacheDir()
+	{
+		std::filesystem::path dir;
+		const char* env = getenv("TT_NATIVE_CACHE");
+		if (env && *env) dir = env;
+		else
+		{
+#ifdef _WIN32
+			const char* base = getenv("LOCALAPPDATA");
+			if (!base || !*base) return "";
+			dir = std::filesystem::path(base) / "tentacode-native";
+#else
+			const char* xdg = getenv("XDG_CACHE_HOME");
+			const char* home = getenv("HOME");
+			if (xdg && *xdg) dir = std::filesystem::path(xdg) / "tentacode-native";
+			else if (home && *home) dir = std::filesystem::path(home) / ".cache" / "tentacode-native";
+			else return "";
+#endif
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(dir.parent_path(), ec);
+#ifdef _WIN32
+		std::filesystem::create_directory(dir, ec);
+#else
+		mkdir(dir.c_str(), 0700);
+#endif
+		return Trusted(dir.string(), true) ? dir.string() : "";
+	}
+
+	// the shared object for source, compiled unless an earlier run left it in the cache
+	static EntryFn Load(const std::string& source)
+	{
+		std::string dir = CacheDir();
+		if (dir.empty()) return nullptr;
+
+		const char* cc = getenv("CC");
+		std::string compiler = (cc && *cc) ? cc : "cc";
+#ifdef _WIN32
+		const char* suffix = ".dll";
+		const char* quiet = " >NUL 2>&1";
+#else
+		const char* suffix = ".so";
+		const char* quiet = " >/dev/null 2>&1";
+#endif
+
+		char name[32];
+		snprintf(name, sizeof(name), "tt_%016llx", (unsigned long long)Hash(compiler + "\n" + source));
+		std::string lib = dir + "/" + name + suffix;
+
+		std::error_code ec;
+		if (!std::filesystem::exists(lib, ec))
+		{
+			// built under a name of its own and renamed, another process may be compiling the same body
+			std::string stem = dir + "/" + name + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+			{
+				std::ofstream file(stem + ".c");
+				file << source;
+				if (!file) return nullptr;
+			}
+
+			std::string command = compiler + " -O2 -shared -fPIC -fwrapv -w -o \"" + stem + suffix + "\" \"" + stem + ".c\" -lm" + quiet;
+			int status = system(command.c_str());
+			std::filesystem::remove(stem + ".c", ec);
+			if (0 == status)
+			{
+				// whatever the umask, only this user may write it
+				std::filesystem::permissions(stem + suffix, std::filesystem::perms::owner_all, ec);
+				std::filesystem::rename(stem + suffix, lib, ec);
+			}
+			std::filesystem::remove(stem + suffix, ec);
+			if (!std::filesystem::exists(lib, ec)) return nullptr;
+		}
+
+		if (!Trusted(lib, false)) return nullptr;
+
+		// never unloaded, the function keeps its entry for the life of the process
+#ifdef _WIN32
+		HMODULE handle = LoadLibraryA(lib.c_str());
+		return handle ? (EntryFn)GetProcAddress(handle, "tt_entry") : nullptr;
+#else
+		void* handle = dlopen(lib.c_str(), RTLD_NOW | RTLD_LOCAL);
+		return handle ? (EntryFn)dlsym(handle, "tt_entry") : nullptr;
+#endif
+	}
+
+	FunctionStmt* m_stmt;
+	std::mutex m_lock;
+	std::unordered_map<std::string, EntryFn> m_entries; // nullptr for signatures left to the interpreter
+	size_t m_compiled;
+};
+
+#endif // NATIVE_CODE_H
@@ -0,0 +1,99 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <atomic>
+#include <string>
+#include <stdio.h>
+#include <stdarg.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define OUTPUT_ISATTY() _isatty(_fileno(stdout))
+#else
+#include <unistd.h>
+#define OUTPUT_ISATTY() isatty(fileno(stdout))
+#endif
+
+#include "Literal.h"
+
+
+// Text from print, println and cprintln on its way to stdout. Every thread
+// has its own buffer, so printing takes no lock and parallel for bodies or
+// workers only ever write whole chunks. The buffer is written out once it
+// holds Capacity() bytes, at each newline when Lines() is set (the default
+// for a terminal), on flush(), before errors are printed and before anything
+// that waits on the user or hands work to another thread: input(), parallel
+// for, worker::spawn and channel sends and receives. Warnings and errors go
+// through Report, so they come out after the text printed before them.
+class Output
+{
+public:
+
+	static const size_t DEFAULT_CAPACITY = 64 * 1024;
+
+	static Output& Local()
+	{
+		thread_local Output output;
+		return output;
+	}
+
+	// shared by all threads, 0 writes every print straight away
+	static std::atomic<size_t>& Capacity()
+	{
+		static std::atomic<size_t> capacity(DEFAULT_CAPACITY);
+		return capacity;
+	}
+
+	static std::atomic<bool>& Lines()
+	{
+		static std::atomic<bool> lines(0 != OUTPUT_ISATTY());
+		return lines;
+	}
+
+	~Output() { Flush(); }
+
+	void Write(const Literal& value)
+	{
+		value.AppendTo(m_buffer);
+		if (m_buffer.size() >= Capacity()) Flush();
+	}
+
+	void Write(const char* text)
+	{
+		m_buffer.append(text);
+		if (m_buffer.size() >= Capacity()) Flush();
+	}
+
+	void Line(const Literal& value)
+	{
+		value.AppendTo(m_buffer);
+		m_buffer.push_back('\n');
+		if (Lines() || m_buffer.size() >= Capacity()) Flush();
+	}
+
+	// printf for a diagnostic, written after what this thread still holds
+	static void Report(const char* format, ...)
+	{
+		Local().Flush();
+		va_list args;
+		va_start(args, format);
+		vprintf(format, args);
+		va_end(args);
+	}
+
+	void Flush()
+	{
+		if (m_buffer.empty()) return;
+		fwrite(m_buffer.data(), 1, m_buffer.size(), stdout);
+		fflush(stdout);
+		m_buffer.clear();
+	}
+
+private:
+
+	Output() { m_buffer.reserve(DEFAULT_CAPACITY); }
+
+	std::string m_buffer;
+};
+
+#endif // OUTPUT_H
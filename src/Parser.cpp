@@ -1,8 +1,6 @@
 #include "Parser.h"
 #include "Scanner.h"
 
-std::set<std::string> Parser::m_includes;
-
 Token Parser::Advance()
 {
 	if (!IsAtEnd()) m_current++;
@@ -18,7 +16,7 @@ bool Parser::Check(TokenTypeEnum tokenType)
 bool Parser::CheckNext(TokenTypeEnum tokenType)
 {
 	if (IsAtEnd()) return false;
-	if (m_current + 1 == m_tokenList.size()) return false;
+	if (size_t(m_current + 1) == m_tokenList.size()) return false;
 	TokenTypeEnum next = m_tokenList.at(m_current + 1).GetType();
 	if (TOKEN_END_OF_FILE == next) return false;
 	return next == tokenType;
@@ -27,13 +25,21 @@ bool Parser::CheckNext(TokenTypeEnum tokenType)
 bool Parser::CheckNextNext(TokenTypeEnum tokenType)
 {
 	if (IsAtEnd()) return false;
-	if (m_current + 1 == m_tokenList.size()) return false;
-	if (m_current + 2 == m_tokenList.size()) return false;
+	if (size_t(m_current + 1) == m_tokenList.size()) return false;
+	if (size_t(m_current + 2) == m_tokenList.size()) return false;
 	TokenTypeEnum next = m_tokenList.at(m_current + 2).GetType();
 	if (TOKEN_END_OF_FILE == next) return false;
 	return next == tokenType;
 }
 
+bool Parser::CheckModifier(size_t offset)
+{
+	if (m_current + offset + 1 >= m_tokenList.size()) return false;
+	Token& modifier = m_tokenList.at(m_current + offset);
+	if (TOKEN_IDENTIFIER != modifier.GetType() || ("pure" != modifier.Lexeme() && "inline" != modifier.Lexeme() && "native" != modifier.Lexeme())) return false;
+	return TOKEN_IDENTIFIER == m_tokenList.at(m_current + offset + 1).GetType();
+}
+
 bool Parser::Consume(TokenTypeEnum tokenType, std::string err)
 {
 	if (Check(tokenType))
@@ -125,6 +131,27 @@ void Parser::Include()
 	}
 }
 
+Stmt* Parser::NativeInclude()
+{
+	Advance(); // native
+
+	if (!Consume(TOKEN_STRING, "Expected library filename after include native.")) return nullptr;
+
+	std::string filename = Previous().StringValue();
+
+	std::string fqns = m_fqns;
+
+	if (Match(1, TOKEN_AS))
+	{
+		if (!Consume(TOKEN_IDENTIFIER, "Expected identifier after as.")) return nullptr;
+		fqns.append(Previous().Lexeme() + "::");
+	}
+
+	if (!Consume(TOKEN_SEMICOLON, "Expected ';' after include.")) return nullptr;
+
+	return new NativeIncludeStmt(filename, fqns);
+}
+
 bool Parser::IsAtEnd()
 {
 	return Peek().GetType() == TOKEN_END_OF_FILE;
@@ -134,7 +161,7 @@ bool Parser::Match(int count, ...)
 {
 	std::va_list args;
 	va_start(args, count);
-	for (size_t i = 0; i < count; ++i)
+	for (int i = 0; i < count; ++i)
 	{
 		TokenTypeEnum t = (TokenTypeEnum)(va_arg(args, int));
 		
@@ -158,4 +185,857 @@ Token Parser::Peek()
 Token Parser::Previous()
 {
 	return m_tokenList.at(m_current - 1);
-}
\ No newline at end of file
+}
+Stmt* Parser::ParallelForStatement()
+{
+	Advance(); // parallel
+	Advance(); // for
+
+	VarStmt* initializer = (VarStmt*)VarDeclarationForInRange();
+	if (!initializer)
+	{
+		Error(Previous(), "Expected initializer after parallel for.");
+		return nullptr;
+	}
+
+	if (!Consume(TOKEN_LEFT_BRACE, "Expected '{' after initializer.")) return nullptr;
+	StmtList* body = BlockStatement();
+
+	// iterations run at the same time, so the body may only write its own variables and v[i] of output vectors
+	ParallelScope scope;
+	scope.var = initializer->Operator()->Lexeme();
+	for (Stmt* stmt : *body) CheckParallel(stmt, scope);
+
+	for (auto& read : scope.shared)
+	{
+		std::string name = read.first->Lexeme();
+		if (!read.second && 0 != scope.outputs.count(name))
+		{
+			ParallelError(read.first, "Output '" + name + "' can only be used as " + name + "[" + scope.var + "] in a parallel for.");
+		}
+	}
+
+	if (!scope.calls.empty()) m_parallels.push_back(scope);
+
+	// ..= has already been turned into .. by VarDeclarationForInRange
+	RangeExpr* range = (RangeExpr*)initializer->Expression();
+	std::vector<std::string> outputs(scope.outputs.begin(), scope.outputs.end());
+	return new ParallelForStmt(initializer->Operator(), range->Left(), range->Right(), body, outputs, m_fqns);
+}
+
+Stmt* Parser::MatchStatement()
+{
+	Token* keyword = new Token(Previous());
+	Expr* subject = Expression();
+	if (!Consume(TOKEN_LEFT_BRACE, "Expected '{' after match value.")) return nullptr;
+
+	MatchStmt* stmt = new MatchStmt(keyword, subject);
+	while (!Check(TOKEN_RIGHT_BRACE) && !IsAtEnd())
+	{
+		if (stmt->Fallback())
+		{
+			Error(Peek(), "The '_' arm must be the last one in a match.");
+			return nullptr;
+		}
+
+		int32_t lo = 0, hi = 0;
+		bool fallback = false;
+		if (Check(TOKEN_IDENTIFIER) && "_" == Peek().Lexeme())
+		{
+			Advance();
+			fallback = true;
+		}
+		else if (Match(1, TOKEN_ENUM))
+		{
+			stmt->AddEnum(Previous().EnumValue().enumValue);
+		}
+		else if (Match(1, TOKEN_STRING))
+		{
+			stmt->AddString(Previous().StringValue());
+		}
+		else if (MatchInteger(lo))
+		{
+			hi = lo;
+			if (Match(2, TOKEN_DOT_DOT, TOKEN_DOT_DOT_EQUAL))
+			{
+				bool inclusive = TOKEN_DOT_DOT_EQUAL == Previous().GetType();
+				if (!MatchInteger(hi))
+				{
+					Error(Peek(), "Expected an integer after '..' in match pattern.");
+					return nullptr;
+				}
+				if (!inclusive) hi--;
+			}
+			if (hi < lo)
+			{
+				Error(Previous(), "Empty range in match pattern.");
+				return nullptr;
+			}
+			stmt->AddRange(lo, hi);
+		}
+		else
+		{
+			Error(Peek(), "Expected an enum, integer, range, string or '_' pattern in match.");
+			return nullptr;
+		}
+
+		if (!Consume(TOKEN_ARROW, "Expected '=>' after match pattern.")) return nullptr;
+		if (!Consume(TOKEN_LEFT_BRACE, "Expected '{' before match arm.")) return nullptr;
+		Stmt* body = new BlockStmt(BlockStatement());
+		if (fallback) stmt->SetFallback(body);
+		else stmt->AddArm(body);
+
+		Match(1, TOKEN_COMMA);
+	}
+
+	if (!Consume(TOKEN_RIGHT_BRACE, "Expected '}' after match arms.")) return nullptr;
+	stmt->Finish();
+	return stmt;
+}
+
+bool Parser::MatchInteger(int32_t& value)
+{
+	if (Check(TOKEN_MINUS) && CheckNext(TOKEN_INTEGER))
+	{
+		Advance();
+		value = -Advance().IntValue();
+		return true;
+	}
+
+	if (!Match(1, TOKEN_INTEGER)) return false;
+	value = Previous().IntValue();
+	return true;
+}
+
+void Parser::CheckParallel(Stmt* stmt, ParallelScope& scope)
+{
+	if (!stmt) return;
+
+	switch (stmt->GetType())
+	{
+	case STATEMENT_BLOCK:
+	{
+		std::set<std::string> outer = scope.locals;
+		for (Stmt* s : *((BlockStmt*)stmt)->GetBlock()) CheckParallel(s, scope);
+		scope.locals = outer;
+		break;
+	}
+
+	case STATEMENT_EXPRESSION:
+	case STATEMENT_PRINT:
+	case STATEMENT_PRINTLN:
+		CheckParallel(stmt->Expression(), scope);
+		break;
+
+	case STATEMENT_VAR:
+		CheckParallel(stmt->Expression(), scope);
+		scope.locals.insert(((VarStmt*)stmt)->Operator()->Lexeme());
+		break;
+
+	case STATEMENT_DESTRUCT:
+		CheckParallel(stmt->Expression(), scope);
+		for (Token* t : ((DestructStmt*)stmt)->Operators()) scope.locals.insert(t->Lexeme());
+		break;
+
+	case STATEMENT_IF:
+	{
+		IfStmt* s = (IfStmt*)stmt;
+		CheckParallel(s->GetCondition(), scope);
+		CheckParallel(s->GetThenBranch(), scope);
+		CheckParallel(s->GetElseBranch(), scope);
+		break;
+	}
+
+	case STATEMENT_WHILE:
+	{
+		WhileStmt* s = (WhileStmt*)stmt;
+		CheckParallel(s->GetCondition(), scope);
+		CheckParallel(s->GetPost(), scope);
+		scope.loops++;
+		CheckParallel(s->GetBody(), scope);
+		scope.loops--;
+		break;
+	}
+
+	case STATEMENT_MATCH:
+	{
+		MatchStmt* s = (MatchStmt*)stmt;
+		CheckParallel(s->Subject(), scope);
+		for (Stmt* arm : s->Arms()) CheckParallel(arm, scope);
+		CheckParallel(s->Fallback(), scope);
+		break;
+	}
+
+	case STATEMENT_BREAK:
+		if (0 == scope.loops) ParallelError(((BreakStmt*)stmt)->Keyword(), "Cannot break out of a parallel for.");
+		break;
+
+	case STATEMENT_CONTINUE:
+		if (0 == scope.loops) ParallelError(((ContinueStmt*)stmt)->Keyword(), "Cannot continue a parallel for, the iterations are independent.");
+		break;
+
+	case STATEMENT_RETURN:
+		if (0 == scope.functors) ParallelError(((ReturnStmt*)stmt)->Keyword(), "Cannot return from inside a parallel for.");
+		CheckParallel(((ReturnStmt*)stmt)->GetValueExpr(), scope);
+		break;
+
+	case STATEMENT_YIELD:
+		// a generator called from the body runs its yields on the iteration's thread
+		if (!m_quiet) ParallelError(((YieldStmt*)stmt)->Keyword(), "Cannot yield from inside a parallel for.");
+		CheckParallel(((YieldStmt*)stmt)->GetValueExpr(), scope);
+		break;
+
+	default:
+		ParallelError(nullptr, "Definitions, CLEARENV and nested parallel loops are not allowed in a parallel for.");
+		break;
+	}
+}
+
+void Parser::CheckParallel(Expr* expr, ParallelScope& scope)
+{
+	if (!expr) return;
+
+	// v[i] with i the loop variable, the only index that is known to be disjoint across iterations
+	auto isLoopIndex = [&scope](Expr* index)
+	{
+		if (!index || EXPRESSION_VARIABLE != index->GetType()) return false;
+		VariableExpr* v = (VariableExpr*)index;
+		return !v->VecIndex() && scope.var == v->Operator()->Lexeme() && 0 == scope.locals.count(scope.var);
+	};
+
+	switch (expr->GetType())
+	{
+	case EXPRESSION_ASSIGN:
+	{
+		AssignExpr* a = (AssignExpr*)expr;
+		CheckParallel(a->Right(), scope);
+		CheckParallel(a->VecIndex(), scope);
+
+		std::string name = a->Operator()->Lexeme();
+		if (0 != scope.locals.count(name)) break;
+
+		if (m_quiet)
+			ParallelError(a->Operator(), "It assigns '" + name + "', which other iterations may be using.");
+		else if (scope.var == name)
+			ParallelError(a->Operator(), "Cannot assign the parallel for variable '" + name + "'.");
+		else if (isLoopIndex(a->VecIndex()))
+			scope.outputs.insert(name);
+		else
+			ParallelError(a->Operator(), "A parallel for can only assign its own variables or output[" + scope.var + "], found '" + name + "'.");
+		break;
+	}
+
+	case EXPRESSION_SET:
+	{
+		SetExpr* s = (SetExpr*)expr;
+		CheckParallel(s->Object(), scope);
+		CheckParallel(s->VecIndex(), scope);
+		CheckParallel(s->Value(), scope);
+
+		Expr* root = s->Object();
+		while (EXPRESSION_GET == root->GetType()) root = ((GetExpr*)root)->Object();
+		if (EXPRESSION_VARIABLE != root->GetType() || 0 == scope.locals.count(((VariableExpr*)root)->Operator()->Lexeme()))
+		{
+			ParallelError(s->Name(), "A parallel for can only set fields of its own variables.");
+		}
+		break;
+	}
+
+	case EXPRESSION_COMPOUND:
+		// checked as the assignment it stands for, with the indices it evaluates once
+		for (Expr* e : ((CompoundExpr*)expr)->Once()) CheckParallel(e, scope);
+		CheckParallel(((CompoundExpr*)expr)->Fallback(), scope);
+		break;
+
+	case EXPRESSION_DESTRUCTURE:
+	{
+		DestructExpr* d = (DestructExpr*)expr;
+		for (Expr* e : d->GetRhsArguments()) CheckParallel(e, scope);
+		for (Expr* e : d->GetLhsArguments())
+		{
+			if (EXPRESSION_VARIABLE != e->GetType() || 0 == scope.locals.count(((VariableExpr*)e)->Operator()->Lexeme()))
+			{
+				ParallelError(d->Operator(), "A parallel for can only assign its own variables.");
+			}
+		}
+		break;
+	}
+
+	case EXPRESSION_VARIABLE:
+	{
+		VariableExpr* v = (VariableExpr*)expr;
+		CheckParallel(v->VecIndex(), scope);
+		if (0 > v->Slot() && 0 == scope.locals.count(v->Operator()->Lexeme()))
+		{
+			scope.shared.push_back(std::make_pair(v->Operator(), isLoopIndex(v->VecIndex())));
+		}
+		break;
+	}
+
+	case EXPRESSION_BINARY:
+		CheckParallel(((BinaryExpr*)expr)->Left(), scope);
+		CheckParallel(((BinaryExpr*)expr)->Right(), scope);
+		break;
+
+	case EXPRESSION_LOGICAL:
+		CheckParallel(((LogicalExpr*)expr)->Left(), scope);
+		CheckParallel(((LogicalExpr*)expr)->Right(), scope);
+		break;
+
+	case EXPRESSION_RANGE:
+		CheckParallel(((RangeExpr*)expr)->Left(), scope);
+		CheckParallel(((RangeExpr*)expr)->Right(), scope);
+		break;
+
+	case EXPRESSION_REPLICATE:
+		CheckParallel(((ReplicateExpr*)expr)->Left(), scope);
+		CheckParallel(((ReplicateExpr*)expr)->Right(), scope);
+		break;
+
+	case EXPRESSION_PAIR:
+		CheckParallel(((PairExpr*)expr)->GetKey(), scope);
+		CheckParallel(((PairExpr*)expr)->GetValue(), scope);
+		break;
+
+	case EXPRESSION_GROUP:
+		CheckParallel(((GroupExpr*)expr)->Expression(), scope);
+		break;
+
+	case EXPRESSION_UNARY:
+		CheckParallel(((UnaryExpr*)expr)->Right(), scope);
+		break;
+
+	case EXPRESSION_REF:
+	{
+		VariableExpr* v = ((RefExpr*)expr)->Variable();
+		if (0 == scope.locals.count(v->Operator()->Lexeme()))
+		{
+			ParallelError(v->Operator(), "A parallel for can only pass its own variables by reference.");
+		}
+		break;
+	}
+
+	case EXPRESSION_GET:
+		CheckParallel(((GetExpr*)expr)->Object(), scope);
+		CheckParallel(((GetExpr*)expr)->VecIndex(), scope);
+		break;
+
+	case EXPRESSION_CALL:
+	{
+		Expr* callee = ((CallExpr*)expr)->GetCallee();
+		if (EXPRESSION_VARIABLE == callee->GetType() && !((VariableExpr*)callee)->VecIndex())
+		{
+			scope.calls.push_back(((VariableExpr*)callee)->Operator());
+		}
+		CheckParallel(callee, scope);
+		for (Expr* e : ((CallExpr*)expr)->GetArguments()) CheckParallel(e, scope);
+		break;
+	}
+
+	case EXPRESSION_INTRINSIC:
+		CheckParallel(((IntrinsicExpr*)expr)->Call(), scope);
+		break;
+
+	case EXPRESSION_FORMAT:
+		for (Expr* e : ((FormatExpr*)expr)->GetArguments()) CheckParallel(e, scope);
+		break;
+
+	case EXPRESSION_CONCAT:
+		for (Expr* e : ((ConcatExpr*)expr)->GetArguments()) CheckParallel(e, scope);
+		break;
+
+	case EXPRESSION_BRACKET:
+		for (Expr* e : ((BracketExpr*)expr)->GetArguments()) CheckParallel(e, scope);
+		break;
+
+	case EXPRESSION_STRUCTURE:
+		for (Expr* e : ((StructExpr*)expr)->GetArguments()) CheckParallel(e, scope);
+		break;
+
+	case EXPRESSION_FUNCTOR:
+	{
+		// a function object body is checked like the loop body, with its parameters as locals
+		FunctorExpr* f = (FunctorExpr*)expr;
+		std::set<std::string> outer = scope.locals;
+		int loops = scope.loops;
+		for (auto& p : f->GetParams()) scope.locals.insert(p.Lexeme());
+		scope.loops = 0;
+		scope.functors++;
+		for (Stmt* s : *(StmtList*)f->GetBody()) CheckParallel(s, scope);
+		scope.functors--;
+		scope.loops = loops;
+		scope.locals = outer;
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void Parser::ParallelError(Token* token, const std::string& err)
+{
+	if (m_quiet)
+	{
+		if (m_quietError.empty()) m_quietError = err;
+		return;
+	}
+	if (token)
+		m_errorHandler->Error(token->Filename(), token->Line(), "at '" + token->Lexeme() + "'", "Parser Error: " + err);
+	else
+		Error(Previous(), "Parser Error: " + err);
+}
+
+// a def called from the body runs on several threads at once, so it may not write anything but its own
+// variables, nor read an output that other iterations write
+void Parser::CheckParallelCalls()
+{
+	m_quiet = true;
+	for (ParallelScope& loop : m_parallels)
+	{
+		std::set<FunctionStmt*> seen;
+		std::vector<std::pair<Token*, Token*> > pending;	// call site in the loop, callee
+		for (Token* call : loop.calls) pending.push_back(std::make_pair(call, call));
+
+		while (!pending.empty())
+		{
+			Token* site = pending.back().first;
+			Token* callee = pending.back().second;
+			pending.pop_back();
+
+			auto defs = m_defs.find(ShortName(callee->Lexeme()));
+			if (m_defs.end() == defs) continue;	// a native or a function object
+
+			for (FunctionStmt* def : defs->second)
+			{
+				if (!seen.insert(def).second) continue;
+
+				ParallelScope scope;
+				for (auto& p : def->GetParams()) scope.locals.insert(p.Lexeme());
+				scope.functors = 1;
+				m_quietError.clear();
+				for (Stmt* s : *def->GetBody()) CheckParallel(s, scope);
+
+				for (auto& read : scope.shared)
+				{
+					std::string name = read.first->Lexeme();
+					if (0 != loop.outputs.count(name) && m_quietError.empty()) m_quietError = "It uses output '" + name + "'.";
+				}
+
+				if (!m_quietError.empty())
+				{
+					m_quiet = false;
+					ParallelError(site, "A parallel for can not call '" + def->Operator()->Lexeme() + "'. " + m_quietError);
+					m_quiet = true;
+				}
+				for (Token* call : scope.calls) pending.push_back(std::make_pair(site, call));
+			}
+		}
+	}
+	m_quiet = false;
+	m_parallels.clear();
+}
+
+// largest body inlined without def inline
+static const size_t INLINE_STATEMENTS = 4;
+static const size_t INLINE_NODES = 24;
+
+InlineBody* Parser::Inline(FunctionStmt* stmt, bool force)
+{
+	InlineScope scope;
+	scope.self = stmt->Operator()->Lexeme();
+	const TokenList& params = stmt->GetParams();
+	for (size_t i = 0; i < params.size(); ++i) scope.slots[params[i].Lexeme()] = int(i);
+
+	// def locals, if cond { return a; } guards and a final return
+	StmtList* body = stmt->GetBody();
+	if (body->empty() || STATEMENT_RETURN != body->back()->GetType()) return nullptr;
+	if (!force && body->size() > INLINE_STATEMENTS) return nullptr;
+
+	std::vector<InlineBody::Step> steps;
+	for (Stmt* s : *body)
+	{
+		InlineBody::Step step = { nullptr, nullptr, -1 };
+
+		if (STATEMENT_RETURN == s->GetType())
+		{
+			step.value = InlineReturn(s, scope);
+		}
+		else if (STATEMENT_IF == s->GetType())
+		{
+			IfStmt* f = (IfStmt*)s;
+			if (f->GetElseBranch()) return nullptr;
+
+			Stmt* then = f->GetThenBranch();
+			if (STATEMENT_BLOCK == then->GetType())
+			{
+				StmtList* block = ((BlockStmt*)then)->GetBlock();
+				if (1 != block->size()) return nullptr;
+				then = block->at(0);
+			}
+
+			step.cond = CloneInline(f->GetCondition(), scope);
+			if (!step.cond) return nullptr;
+			step.value = InlineReturn(then, scope);
+		}
+		else if (STATEMENT_VAR == s->GetType())
+		{
+			// only untyped locals, typed ones convert their value
+			VarStmt* v = (VarStmt*)s;
+			std::string name = v->Operator()->Lexeme();
+			if (TOKEN_DEF != v->VarType()->GetType() || !v->Expression() || 0 != scope.slots.count(name)) return nullptr;
+
+			step.value = CloneInline(v->Expression(), scope);
+			step.slot = int(scope.slots.size());
+			scope.slots[name] = step.slot;
+		}
+
+		if (!step.value) return nullptr;
+		steps.push_back(step);
+	}
+
+	if (scope.slots.size() > InlineBody::MAX_SLOTS || (!force && scope.nodes > INLINE_NODES)) return nullptr;
+
+	InlineBody* inl = new InlineBody();
+	inl->params = params.size();
+	inl->steps = steps;
+	return inl;
+}
+
+// value of a return statement, a tail call is left to the frame loop so it keeps running in constant stack
+Expr* Parser::InlineReturn(Stmt* stmt, InlineScope& scope)
+{
+	if (STATEMENT_RETURN != stmt->GetType()) return nullptr;
+	ReturnStmt* r = (ReturnStmt*)stmt;
+	if (!r->GetValueExpr() || r->IsTailCall()) return nullptr;
+	return CloneInline(r->GetValueExpr(), scope);
+}
+
+// copy of an expression from a function body with its parameters and locals read from slots,
+// nullptr for anything that needs the function's own scope
+Expr* Parser::CloneInline(Expr* expr, InlineScope& scope)
+{
+	scope.nodes++;
+
+	switch (expr->GetType())
+	{
+	case EXPRESSION_LITERAL:
+		return expr;
+
+	case EXPRESSION_VARIABLE:
+	{
+		VariableExpr* v = (VariableExpr*)expr;
+		Expr* index = v->VecIndex() ? CloneInline(v->VecIndex(), scope) : nullptr;
+		if (v->VecIndex() && !index) return nullptr;
+
+		auto it = scope.slots.find(v->Operator()->Lexeme());
+		if (scope.slots.end() != it) return new VariableExpr(v->Operator(), index, v->FQNS(), it->second);
+		return index ? new VariableExpr(v->Operator(), index, v->FQNS()) : expr;
+	}
+
+	case EXPRESSION_GROUP:
+	{
+		Expr* e = CloneInline(((GroupExpr*)expr)->Expression(), scope);
+		return e ? new GroupExpr(e) : nullptr;
+	}
+
+	case EXPRESSION_UNARY:
+	{
+		UnaryExpr* u = (UnaryExpr*)expr;
+		Expr* right = CloneInline(u->Right(), scope);
+		return right ? new UnaryExpr(u->Operator(), right) : nullptr;
+	}
+
+	case EXPRESSION_BINARY:
+	{
+		BinaryExpr* b = (BinaryExpr*)expr;
+		Expr* left = CloneInline(b->Left(), scope);
+		Expr* right = left ? CloneInline(b->Right(), scope) : nullptr;
+		return right ? new BinaryExpr(left, b->Operator(), right) : nullptr;
+	}
+
+	case EXPRESSION_LOGICAL:
+	{
+		LogicalExpr* l = (LogicalExpr*)expr;
+		Expr* left = CloneInline(l->Left(), scope);
+		Expr* right = left ? CloneInline(l->Right(), scope) : nullptr;
+		return right ? new LogicalExpr(left, l->Operator(), right) : nullptr;
+	}
+
+	case EXPRESSION_GET:
+	{
+		GetExpr* g = (GetExpr*)expr;
+		Expr* object = CloneInline(g->Object(), scope);
+		Expr* index = g->VecIndex() ? CloneInline(g->VecIndex(), scope) : nullptr;
+		if (!object || (g->VecIndex() && !index)) return nullptr;
+		return new GetExpr(object, g->Name(), index);
+	}
+
+	case EXPRESSION_STRUCTURE:
+	{
+		StructExpr* st = (StructExpr*)expr;
+		ArgList args;
+		for (Expr* e : st->GetArguments())
+		{
+			args.push_back(CloneInline(e, scope));
+			if (!args.back()) return nullptr;
+		}
+		return new StructExpr(args, st->Operator());
+	}
+
+	case EXPRESSION_CONCAT:
+	{
+		ConcatExpr* c = (ConcatExpr*)expr;
+		ArgList args;
+		for (Expr* e : c->GetArguments())
+		{
+			args.push_back(CloneInline(e, scope));
+			if (!args.back()) return nullptr;
+		}
+		return new ConcatExpr(c->Operator(), args);
+	}
+
+	case EXPRESSION_CALL:
+	{
+		// calls out to other functions by name, a call to itself is recursion
+		CallExpr* c = (CallExpr*)expr;
+		Expr* callee = c->GetCallee();
+		if (EXPRESSION_VARIABLE != callee->GetType() || ((VariableExpr*)callee)->VecIndex()) return nullptr;
+		std::string name = ((VariableExpr*)callee)->Operator()->Lexeme();
+		if (scope.self == name || 0 != scope.slots.count(name)) return nullptr;
+
+		ArgList args;
+		for (Expr* e : c->GetArguments())
+		{
+			args.push_back(CloneInline(e, scope));
+			if (!args.back()) return nullptr;
+		}
+		return new CallExpr(callee, c->Operator(), args);
+	}
+
+	case EXPRESSION_INTRINSIC:
+	{
+		IntrinsicExpr* in = (IntrinsicExpr*)expr;
+		Expr* call = CloneInline(in->Call(), scope);
+		if (!call) return nullptr;
+
+		ArgList args;
+		for (Expr* e : in->GetArguments())
+		{
+			args.push_back(CloneInline(e, scope));
+			if (!args.back()) return nullptr;
+		}
+		return new IntrinsicExpr(in->Intrinsic(), (CallExpr*)call, args);
+	}
+
+	default:
+		return nullptr;
+	}
+}
+
+// nested def and functor bodies run in their own frames and are left to their own profiles
+void Parser::CollectBinaries(Stmt* stmt, std::vector<BinaryExpr*>& binaries)
+{
+	if (!stmt) return;
+
+	switch (stmt->GetType())
+	{
+	case STATEMENT_BLOCK:
+		for (Stmt* s : *((BlockStmt*)stmt)->GetBlock()) CollectBinaries(s, binaries);
+		break;
+
+	case STATEMENT_EXPRESSION:
+	case STATEMENT_PRINT:
+	case STATEMENT_PRINTLN:
+	case STATEMENT_VAR:
+	case STATEMENT_DESTRUCT:
+		CollectBinaries(stmt->Expression(), binaries);
+		break;
+
+	case STATEMENT_IF:
+	{
+		IfStmt* s = (IfStmt*)stmt;
+		CollectBinaries(s->GetCondition(), binaries);
+		CollectBinaries(s->GetThenBranch(), binaries);
+		CollectBinaries(s->GetElseBranch(), binaries);
+		break;
+	}
+
+	case STATEMENT_WHILE:
+	{
+		WhileStmt* s = (WhileStmt*)stmt;
+		CollectBinaries(s->GetCondition(), binaries);
+		CollectBinaries(s->GetPost(), binaries);
+		CollectBinaries(s->GetBody(), binaries);
+		break;
+	}
+
+	case STATEMENT_MATCH:
+	{
+		MatchStmt* s = (MatchStmt*)stmt;
+		CollectBinaries(s->Subject(), binaries);
+		for (Stmt* arm : s->Arms()) CollectBinaries(arm, binaries);
+		CollectBinaries(s->Fallback(), binaries);
+		break;
+	}
+
+	case STATEMENT_PARALLEL_FOR:
+	{
+		ParallelForStmt* s = (ParallelForStmt*)stmt;
+		CollectBinaries(s->Begin(), binaries);
+		CollectBinaries(s->End(), binaries);
+		for (Stmt* b : *s->GetBody()) CollectBinaries(b, binaries);
+		break;
+	}
+
+	case STATEMENT_RETURN:
+		CollectBinaries(((ReturnStmt*)stmt)->GetValueExpr(), binaries);
+		break;
+
+	case STATEMENT_YIELD:
+		CollectBinaries(((YieldStmt*)stmt)->GetValueExpr(), binaries);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void Parser::CollectBinaries(Expr* expr, std::vector<BinaryExpr*>& binaries)
+{
+	if (!expr) return;
+
+	switch (expr->GetType())
+	{
+	case EXPRESSION_BINARY:
+		binaries.push_back((BinaryExpr*)expr);
+		CollectBinaries(((BinaryExpr*)expr)->Left(), binaries);
+		CollectBinaries(((BinaryExpr*)expr)->Right(), binaries);
+		break;
+
+	case EXPRESSION_ASSIGN:
+		CollectBinaries(((AssignExpr*)expr)->Right(), binaries);
+		CollectBinaries(((AssignExpr*)expr)->VecIndex(), binaries);
+		break;
+
+	case EXPRESSION_SET:
+		CollectBinaries(((SetExpr*)expr)->Object(), binaries);
+		CollectBinaries(((SetExpr*)expr)->VecIndex(), binaries);
+		CollectBinaries(((SetExpr*)expr)->Value(), binaries);
+		break;
+
+	case EXPRESSION_COMPOUND:
+		for (Expr* e : ((CompoundExpr*)expr)->Once()) CollectBinaries(e, binaries);
+		CollectBinaries(((CompoundExpr*)expr)->Fallback(), binaries);
+		break;
+
+	case EXPRESSION_LOGICAL:
+		CollectBinaries(((LogicalExpr*)expr)->Left(), binaries);
+		CollectBinaries(((LogicalExpr*)expr)->Right(), binaries);
+		break;
+
+	case EXPRESSION_RANGE:
+		CollectBinaries(((RangeExpr*)expr)->Left(), binaries);
+		CollectBinaries(((RangeExpr*)expr)->Right(), binaries);
+		break;
+
+	case EXPRESSION_REPLICATE:
+		CollectBinaries(((ReplicateExpr*)expr)->Left(), binaries);
+		CollectBinaries(((ReplicateExpr*)expr)->Right(), binaries);
+		break;
+
+	case EXPRESSION_PAIR:
+		CollectBinaries(((PairExpr*)expr)->GetKey(), binaries);
+		CollectBinaries(((PairExpr*)expr)->GetValue(), binaries);
+		break;
+
+	case EXPRESSION_GROUP:
+		CollectBinaries(((GroupExpr*)expr)->Expression(), binaries);
+		break;
+
+	case EXPRESSION_UNARY:
+		CollectBinaries(((UnaryExpr*)expr)->Right(), binaries);
+		break;
+
+	case EXPRESSION_VARIABLE:
+		CollectBinaries(((VariableExpr*)expr)->VecIndex(), binaries);
+		break;
+
+	case EXPRESSION_GET:
+		CollectBinaries(((GetExpr*)expr)->Object(), binaries);
+		CollectBinaries(((GetExpr*)expr)->VecIndex(), binaries);
+		break;
+
+	case EXPRESSION_CALL:
+		CollectBinaries(((CallExpr*)expr)->GetCallee(), binaries);
+		for (Expr* e : ((CallExpr*)expr)->GetArguments()) CollectBinaries(e, binaries);
+		break;
+
+	case EXPRESSION_INTRINSIC:
+		CollectBinaries(((IntrinsicExpr*)expr)->Call(), binaries);
+		break;
+
+	case EXPRESSION_FORMAT:
+		for (Expr* e : ((FormatExpr*)expr)->GetArguments()) CollectBinaries(e, binaries);
+		break;
+
+	case EXPRESSION_CONCAT:
+		for (Expr* e : ((ConcatExpr*)expr)->GetArguments()) CollectBinaries(e, binaries);
+		break;
+
+	case EXPRESSION_BRACKET:
+		for (Expr* e : ((BracketExpr*)expr)->GetArguments()) CollectBinaries(e, binaries);
+		break;
+
+	case EXPRESSION_STRUCTURE:
+		for (Expr* e : ((StructExpr*)expr)->GetArguments()) CollectBinaries(e, binaries);
+		break;
+
+	case EXPRESSION_DESTRUCTURE:
+		for (Expr* e : ((DestructExpr*)expr)->GetLhsArguments()) CollectBinaries(e, binaries);
+		for (Expr* e : ((DestructExpr*)expr)->GetRhsArguments()) CollectBinaries(e, binaries);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void Parser::SegmentFormat(FormatExpr* format, const std::string& text)
+{
+	Token where = Previous();
+	std::vector<FormatExpr::Segment> segments;
+	int arg = 0;
+	size_t pos = 0;
+
+	while (true)
+	{
+		FormatExpr::Segment segment = { "", -1, nullptr };
+		size_t lhs = text.find('{', pos);
+		if (std::string::npos == lhs)
+		{
+			segment.text = text.substr(pos);
+			segments.push_back(segment);
+			break;
+		}
+
+		// an unclosed brace is reported when the template is formatted
+		size_t rhs = text.find('}', lhs);
+		if (std::string::npos == rhs) return;
+
+		segment.text = text.substr(pos, lhs - pos);
+		if (rhs == lhs + 1)
+		{
+			segment.arg = ++arg;
+		}
+		else
+		{
+			Token* name = new Token(TOKEN_IDENTIFIER, text.substr(lhs + 1, rhs - lhs - 1), where.Line(), where.Filename());
+			segment.variable = new VariableExpr(name, nullptr, m_fqns);
+		}
+		segments.push_back(segment);
+		pos = rhs + 1;
+	}
+
+	format->SetSegments(std::move(segments));
+}
@@ -7,11 +7,17 @@
 #include <time.h>
 #include <fstream>
 #include <set>
+#include <map>
+#include <random>
+#include <algorithm>
 
 #include "Token.h"
 #include "Expressions.h"
 #include "ErrorHandler.h"
 #include "Statements.h"
+#include "Memo.h"
+#include "TypeProfile.h"
+#include "NativeCode.h"
 
 class Parser
 {
@@ -23,9 +29,16 @@ public:
 		m_current = 0;
 		m_errorHandler = errorHandler;
 		m_internal = false;
+		m_canYield = false;
+		m_yields = 0;
+		m_functions = 0;
+		m_quiet = false;
 		//m_global = false;
 		m_namespace.push_back("global");
 		UpdateFQNS();
+
+		// loop labels only need to be unique, keep the generator per parser so parsers can run on any thread
+		m_rng.seed(std::random_device()());
 	}
 
 	StmtList Parse()
@@ -45,6 +58,7 @@ public:
 			}
 		}
 
+		CheckParallelCalls();
 		return list;
 	}
 
@@ -124,6 +138,16 @@ public:
 			ret.append(")");
 			break;
 		}
+		case EXPRESSION_REF:
+		{
+			RefExpr* ex = (RefExpr*)expr;
+
+			ret.append("( ");
+			ret.append("& ");
+			ret.append(PrintExpr(ex->Variable()) + " ");
+			ret.append(")");
+			break;
+		}
 		case EXPRESSION_ASSIGN:
 		{
 			AssignExpr* ex = (AssignExpr*)expr;
@@ -144,6 +168,7 @@ public:
 			ret.append(token->Lexeme() + " ");
 			break;
 		}
+		default: break;
 		}
 
 		return ret;
@@ -161,6 +186,7 @@ private:
 			keep_going = false;
 			if (Match(1, TOKEN_INCLUDE))
 			{
+				if (Check(TOKEN_IDENTIFIER) && "native" == Peek().Lexeme()) return NativeInclude();
 				Include();
 				keep_going = true;
 			}
@@ -198,7 +224,7 @@ private:
 		
 		if (Match(1, TOKEN_STRUCT)) return StructDeclaration();
 
-		if (Check(TOKEN_DEF) && CheckNext(TOKEN_IDENTIFIER) && CheckNextNext(TOKEN_LEFT_PAREN)) return Function("function");
+		if (Check(TOKEN_DEF) && CheckNext(TOKEN_IDENTIFIER) && (CheckNextNext(TOKEN_LEFT_PAREN) || CheckModifier(1))) return Function("function");
 		
 		if (Match(8, TOKEN_VAR_I32, TOKEN_VAR_F32, TOKEN_VAR_STRING,
 			TOKEN_VAR_VEC, TOKEN_VAR_MAP, TOKEN_VAR_ENUM, TOKEN_VAR_BOOL, TOKEN_DEF))
@@ -224,15 +250,22 @@ private:
 		if (Match(1, TOKEN_IF)) return IfStatement();
 		if (Match(1, TOKEN_WHILE)) return WhileStatement();
 		if (Match(1, TOKEN_FOR)) return ForStatement();
+		if (Check(TOKEN_IDENTIFIER) && "parallel" == Peek().Lexeme() && CheckNext(TOKEN_FOR)) return ParallelForStatement();
 		if (Match(1, TOKEN_LOOP)) return LoopStatement();
+		if (Match(1, TOKEN_MATCH)) return MatchStatement();
 		if (Match(1, TOKEN_BREAK)) return BreakStatement();
 		if (Match(1, TOKEN_CONTINUE)) return ContinueStatement();
 		if (Match(1, TOKEN_RETURN)) return ReturnStatement();
+		if (Match(1, TOKEN_YIELD)) return YieldStatement();
 		
 		return ExpressionStatement();
 	}
 
 	void Include();
+	Stmt* NativeInclude();
+	Stmt* ParallelForStatement();
+	Stmt* MatchStatement();
+	bool MatchInteger(int32_t& value);
 
 	Stmt* Function(std::string kind)
 	{
@@ -240,6 +273,16 @@ private:
 		//if (m_global) fqns = "global::";
 		Consume(TOKEN_DEF, "");
 
+		bool pure = false;
+		bool inlined = false;
+		bool native = false;
+		while (CheckModifier(0) && Match(1, TOKEN_IDENTIFIER))
+		{
+			if ("pure" == Previous().Lexeme()) pure = true;
+			else if ("native" == Previous().Lexeme()) native = true;
+			else inlined = true;
+		}
+
 		bool internal = m_internal;
 		if (!Consume(TOKEN_IDENTIFIER, "Expected " + kind + " name.")) return nullptr;
 		
@@ -247,13 +290,16 @@ private:
 		if (!Consume(TOKEN_LEFT_PAREN, "Expected '(' after " + kind + " name.")) return nullptr;
 		
 		TokenList params;
+		std::vector<bool> refs;
 		if (!Check(TOKEN_RIGHT_PAREN))
 		{
 			do
 			{
+				bool ref = Match(1, TOKEN_AMPERSAND);
 				if (Consume(TOKEN_IDENTIFIER, "Expect parameter name."))
 				{
 					params.push_back(Token(Previous()));
+					refs.push_back(ref);
 				}
 			} while (Match(1, TOKEN_COMMA));
 		}
@@ -262,8 +308,53 @@ private:
 
 		if (!Consume(TOKEN_LEFT_BRACE, "Expected '{' before " + kind + " body.")) return nullptr;
 
+		// a yield anywhere in the body makes this a generator
+		bool canYield = m_canYield;
+		int yields = m_yields;
+		m_canYield = true;
+		m_yields = 0;
+		m_functions++;
 		StmtList* body = BlockStatement();
-		return new FunctionStmt(name, params, body, fqns, internal);
+		m_functions--;
+		bool generator = 0 < m_yields;
+		m_canYield = canYield;
+		m_yields = yields;
+
+		if (generator && std::find(refs.begin(), refs.end(), true) != refs.end())
+		{
+			Error(*name, "A generator cannot take reference parameters.");
+		}
+
+		if (pure && (generator || std::find(refs.begin(), refs.end(), true) != refs.end()))
+		{
+			Error(*name, "A pure function cannot be a generator or take reference parameters.");
+		}
+
+		if (pure && inlined)
+		{
+			Error(*name, "A function cannot be both pure and inline.");
+		}
+
+		if (native && (pure || inlined || generator || std::find(refs.begin(), refs.end(), true) != refs.end()))
+		{
+			Error(*name, "A native function cannot be pure, inline, a generator or take reference parameters.");
+		}
+
+		FunctionStmt* stmt = new FunctionStmt(name, params, body, fqns, internal, generator, refs, pure ? new Memo() : nullptr);
+		m_defs[ShortName(name->Lexeme())].push_back(stmt);
+		if (!pure && !native && !generator && !stmt->HasRefs()) stmt->SetInline(Inline(stmt, inlined));
+		if (native) stmt->SetNative(new NativeCode(stmt));
+		if (!generator)
+		{
+			std::vector<BinaryExpr*> binaries;
+			for (Stmt* s : *body) CollectBinaries(s, binaries);
+			stmt->SetProfile(new TypeProfile(params, binaries));
+		}
+		if (inlined && !stmt->GetInline())
+		{
+			Error(*name, "'" + name->Lexeme() + "' is declared inline but cannot be inlined.");
+		}
+		return stmt;
 	}
 	
 	Stmt* StructDeclaration()
@@ -649,7 +740,25 @@ private:
 		}
 
 		if (!Consume(TOKEN_SEMICOLON, "Expected ';' after return value.")) return nullptr;
-		return new ReturnStmt(keyword, value);
+
+		bool tailCall = 0 < m_functions && value && EXPRESSION_CALL == value->GetType();
+		return new ReturnStmt(keyword, value, tailCall);
+	}
+
+	Stmt* YieldStatement()
+	{
+		Token* keyword = new Token(Previous());
+		if (!m_canYield) Error(Previous(), "yield is only allowed inside a def function.");
+		m_yields++;
+
+		Expr* value = nullptr;
+		if (!Check(TOKEN_SEMICOLON))
+		{
+			value = Expression();
+		}
+
+		if (!Consume(TOKEN_SEMICOLON, "Expected ';' after yield value.")) return nullptr;
+		return new YieldStmt(keyword, value);
 	}
 
 	Stmt* WhileStatement()
@@ -691,25 +800,10 @@ private:
 			Token equals = Previous();
 			Expr* value = Assignment();
 
-			if (expr->GetType() == EXPRESSION_VARIABLE)
+			if (expr->GetType() == EXPRESSION_VARIABLE || expr->GetType() == EXPRESSION_GET)
 			{
-				VariableExpr* v = (VariableExpr*)expr;
-				Token* name = v->Operator();
-				return new AssignExpr(name, value, v->VecIndex(), m_fqns);
-			}
-			else if (expr->GetType() == EXPRESSION_GET)
-			{
-				while (true)
-				{
-					GetExpr* get = (GetExpr*)expr;
-					Token* name = get->Name();
-					value = new SetExpr(get->Object(), name, value, get->VecIndex(), m_fqns);
-
-					expr = get->Object();
-					if (EXPRESSION_GET != expr->GetType()) break;
-				};
-
-				return value;				
+				Expr* append = Append(expr, value);
+				return append ? append : AssignTo(expr, value);
 			}
 			else if (expr->GetType() == EXPRESSION_STRUCTURE)
 			{
@@ -735,10 +829,105 @@ private:
 
 			Error(Previous(), "Invalid assignment target.");
 		}
+		else if (Match(5, TOKEN_PLUS_EQUAL, TOKEN_MINUS_EQUAL, TOKEN_STAR_EQUAL, TOKEN_SLASH_EQUAL, TOKEN_PERCENT_EQUAL))
+		{
+			Token oper = Previous();
+			Expr* value = Assignment();
+			return Compound(expr, oper, value, false);
+		}
 
 		return expr;
 	}
 
+	// target = value, a field assignment sets each enclosing object in turn
+	Expr* AssignTo(Expr* target, Expr* value)
+	{
+		if (EXPRESSION_VARIABLE == target->GetType())
+		{
+			VariableExpr* v = (VariableExpr*)target;
+			return new AssignExpr(v->Operator(), value, v->VecIndex(), m_fqns);
+		}
+
+		while (true)
+		{
+			GetExpr* get = (GetExpr*)target;
+			value = new SetExpr(get->Object(), get->Name(), value, get->VecIndex(), m_fqns);
+
+			target = get->Object();
+			if (EXPRESSION_GET != target->GetType()) break;
+		};
+
+		return value;
+	}
+
+	// s = s + a + b appends to s in place like s += a + b, nullptr for any other assignment
+	Expr* Append(Expr* target, Expr* value)
+	{
+		if (!target || !value || EXPRESSION_VARIABLE != target->GetType() || ((VariableExpr*)target)->VecIndex() || EXPRESSION_CONCAT != value->GetType()) return nullptr;
+
+		ConcatExpr* concat = (ConcatExpr*)value;
+		const ArgList& operands = concat->GetArguments();
+		Expr* first = operands[0];
+		if (EXPRESSION_VARIABLE != first->GetType() || ((VariableExpr*)first)->VecIndex()) return nullptr;
+		if (((VariableExpr*)first)->Operator()->Lexeme() != ((VariableExpr*)target)->Operator()->Lexeme()) return nullptr;
+
+		// the tail is evaluated after s is read, so a call that changes s would be seen too late
+		ArgList rest(operands.begin() + 1, operands.end());
+		for (Expr* e : rest)
+		{
+			if (!IsPure(e)) return nullptr;
+		}
+		Expr* tail = 1 == rest.size() ? rest[0] : new ConcatExpr(concat->Operator(), rest);
+		return new CompoundExpr(concat->Operator(), target, tail, false, AssignTo(target, value), true);
+	}
+
+	// target op= value, ++ and -- add or subtract one
+	Expr* Compound(Expr* target, Token oper, Expr* value, bool postfix)
+	{
+		if (EXPRESSION_VARIABLE != target->GetType() && EXPRESSION_GET != target->GetType())
+		{
+			Error(oper, "Invalid assignment target.");
+			return target;
+		}
+
+		TokenTypeEnum type = TOKEN_PLUS;
+		std::string lexeme = "+";
+		switch (oper.GetType())
+		{
+		case TOKEN_MINUS_EQUAL: case TOKEN_MINUS_MINUS: type = TOKEN_MINUS; lexeme = "-"; break;
+		case TOKEN_STAR_EQUAL: type = TOKEN_STAR; lexeme = "*"; break;
+		case TOKEN_SLASH_EQUAL: type = TOKEN_SLASH; lexeme = "/"; break;
+		case TOKEN_PERCENT_EQUAL: type = TOKEN_PERCENT; lexeme = "%"; break;
+		default: break;
+		}
+
+		Token* op = new Token(type, lexeme, oper.Line(), oper.Filename());
+		ArgList once;
+		Expr* read = BindIndices(target, op, once);
+		Expr* fallback = AssignTo(read, new BinaryExpr(read, op, value));
+		return new CompoundExpr(op, target, value, postfix, fallback, false, read, once);
+	}
+
+	// target with each index that has side effects moved to a slot of once, so
+	// m[key()] += 1 calls key() a single time for the read and the store
+	Expr* BindIndices(Expr* target, Token* op, ArgList& once)
+	{
+		GetExpr* get = EXPRESSION_GET == target->GetType() ? (GetExpr*)target : nullptr;
+		Expr* object = get ? get->Object() : nullptr;
+		if (object && (EXPRESSION_VARIABLE == object->GetType() || EXPRESSION_GET == object->GetType())) object = BindIndices(object, op, once);
+
+		Expr* index = get ? get->VecIndex() : ((VariableExpr*)target)->VecIndex();
+		if (index && !IsPure(index))
+		{
+			once.push_back(index);
+			index = new VariableExpr(op, nullptr, m_fqns, int(once.size()) - 1);
+		}
+
+		if (get) return object == get->Object() && index == get->VecIndex() ? target : new GetExpr(object, get->Name(), index);
+		VariableExpr* v = (VariableExpr*)target;
+		return index == v->VecIndex() ? target : new VariableExpr(v->Operator(), index, v->FQNS());
+	}
+
 
 	Expr* Or()
 	{
@@ -810,7 +999,7 @@ private:
 				args.push_back(Range());
 			} while (Match(1, TOKEN_COMMA));
 
-			Token* oper = oper = new Token(Previous());
+			Token* oper = new Token(Previous());
 
 			return new StructExpr(args, oper);
 		}
@@ -820,18 +1009,76 @@ private:
 
 	Expr* Range()
 	{
-		Expr* expr = Addition();
+		Expr* expr = BitOr();
 
 		while (Match(2, TOKEN_DOT_DOT, TOKEN_DOT_DOT_EQUAL))
 		{
 			Token* oper = new Token(Previous());
-			Expr* right = Addition();
+			Expr* right = BitOr();
 			expr = new RangeExpr(expr, oper, right);
 		}
 
 		return expr;
 	}
 
+	// bitwise operators bind tighter than comparisons, flags & MASK == 0 tests the masked bits
+	Expr* BitOr()
+	{
+		Expr* expr = BitXor();
+
+		while (Match(1, TOKEN_PIPE))
+		{
+			Token* oper = new Token(Previous());
+			Expr* right = BitXor();
+			expr = new BinaryExpr(expr, oper, right);
+		}
+
+		return expr;
+	}
+
+	Expr* BitXor()
+	{
+		Expr* expr = BitAnd();
+
+		while (Match(1, TOKEN_CARET))
+		{
+			Token* oper = new Token(Previous());
+			Expr* right = BitAnd();
+			expr = new BinaryExpr(expr, oper, right);
+		}
+
+		return expr;
+	}
+
+	// & between operands, before an operand it passes a reference, see Unary
+	Expr* BitAnd()
+	{
+		Expr* expr = Shift();
+
+		while (Match(1, TOKEN_AMPERSAND))
+		{
+			Token* oper = new Token(Previous());
+			Expr* right = Shift();
+			expr = new BinaryExpr(expr, oper, right);
+		}
+
+		return expr;
+	}
+
+	Expr* Shift()
+	{
+		Expr* expr = Addition();
+
+		while (Match(2, TOKEN_LESS_LESS, TOKEN_GREATER_GREATER))
+		{
+			Token* oper = new Token(Previous());
+			Expr* right = Addition();
+			expr = new BinaryExpr(expr, oper, right);
+		}
+
+		return expr;
+	}
+
 	Expr* Addition()
 	{
 		Expr* expr = Multiplication();
@@ -843,9 +1090,51 @@ private:
 			expr = new BinaryExpr(expr, oper, right);
 		}
 
+		return Concat(expr);
+	}
+
+	// a chain of + with a string operand is one concatenation
+	Expr* Concat(Expr* expr)
+	{
+		ArgList operands;
+		Expr* left = expr;
+		while (left && EXPRESSION_BINARY == left->GetType() && TOKEN_PLUS == ((BinaryExpr*)left)->Operator()->GetType())
+		{
+			operands.push_back(((BinaryExpr*)left)->Right());
+			left = ((BinaryExpr*)left)->Left();
+		}
+		// an operand that failed to parse keeps the plain + and its error
+		if (operands.empty() || !left || std::find(operands.begin(), operands.end(), nullptr) != operands.end()) return expr;
+		operands.push_back(left);
+		std::reverse(operands.begin(), operands.end());
+
+		for (Expr* e : operands)
+		{
+			if (IsText(e)) return new ConcatExpr(((BinaryExpr*)expr)->Operator(), operands);
+		}
 		return expr;
 	}
 
+	// string literals, format() and casts to string
+	static bool IsText(Expr* expr)
+	{
+		if (!expr) return false;
+		switch (expr->GetType())
+		{
+		case EXPRESSION_LITERAL: return ((LiteralExpr*)expr)->GetLiteral().IsString();
+		case EXPRESSION_FORMAT: return true;
+		case EXPRESSION_GROUP: return IsText(((GroupExpr*)expr)->Expression());
+		case EXPRESSION_CONCAT: return true;
+		case EXPRESSION_BINARY:
+		{
+			BinaryExpr* b = (BinaryExpr*)expr;
+			return TOKEN_AS == b->Operator()->GetType() && b->Right() && EXPRESSION_VARIABLE == b->Right()->GetType()
+				&& TOKEN_VAR_STRING == ((VariableExpr*)b->Right())->Operator()->GetType();
+		}
+		default: return false;
+		}
+	}
+
 
 	Expr* Multiplication()
 	{
@@ -863,7 +1152,13 @@ private:
 
 	Expr* Unary()
 	{
-		if (Match(2, TOKEN_BANG, TOKEN_MINUS))
+		if (Match(2, TOKEN_PLUS_PLUS, TOKEN_MINUS_MINUS))
+		{
+			Token oper = Previous();
+			Expr* target = Unary();
+			return Compound(target, oper, new LiteralExpr(int32_t(1)), false);
+		}
+		else if (Match(3, TOKEN_BANG, TOKEN_MINUS, TOKEN_TILDE))
 		{
 			Token* oper = new Token(Previous());
 			Expr* right = Unary();
@@ -874,6 +1169,18 @@ private:
 			Token* oper = new Token(Previous());
 			return FinishFunctor(oper);
 		}
+		else if (Match(1, TOKEN_AMPERSAND))
+		{
+			// only something assignable can be bound to a reference parameter
+			Token* oper = new Token(Previous());
+			Expr* right = Unary();
+			if (!right || EXPRESSION_VARIABLE != right->GetType() || ((VariableExpr*)right)->VecIndex())
+			{
+				Error(*oper, "Only variables can be passed by reference.");
+				return right;
+			}
+			return new RefExpr(oper, (VariableExpr*)right);
+		}
 
 		return Modulus();
 	}
@@ -895,18 +1202,31 @@ private:
 
 	Expr* As()
 	{
-		Expr* expr = Primary();
+		Expr* expr = Postfix();
 
 		while (Match(1, TOKEN_AS))
 		{
 			Token* oper = new Token(Previous());
-			Expr* right = Primary();
+			Expr* right = Postfix();
 			expr = new BinaryExpr(expr, oper, right);
 		}
 
 		return expr;
 	}
 
+	Expr* Postfix()
+	{
+		Expr* expr = Primary();
+
+		if (Match(2, TOKEN_PLUS_PLUS, TOKEN_MINUS_MINUS))
+		{
+			Token oper = Previous();
+			return Compound(expr, oper, new LiteralExpr(int32_t(1)), true);
+		}
+
+		return expr;
+	}
+
 	Expr* Primary()
 	{
 		if (Match(1, TOKEN_FILELINE)) return new LiteralExpr(std::string("File:" + Previous().Filename() + ", Line:" + std::to_string(Previous().Line())));
@@ -927,6 +1247,19 @@ private:
 
 		// used for AS syntax
 		if (Match(4, TOKEN_VAR_I32, TOKEN_VAR_F32, TOKEN_VAR_STRING, TOKEN_VAR_ENUM)) return new VariableExpr(new Token(Previous()), nullptr, m_fqns);
+		if (Match(1, TOKEN_VAR_VEC))
+		{
+			// vec<type>, the element type is kept as the index
+			Token* vec = new Token(Previous());
+			Expr* type = nullptr;
+			if (Consume(TOKEN_LESS, "Expected <type> after vec."))
+			{
+				if (Match(3, TOKEN_VAR_I32, TOKEN_VAR_F32, TOKEN_VAR_STRING)) type = new VariableExpr(new Token(Previous()), nullptr, m_fqns);
+				else Error(Previous(), "Invalid vector type in cast.");
+				Consume(TOKEN_GREATER, "Expected '>' after vector type.");
+			}
+			return new VariableExpr(vec, type, m_fqns);
+		}
 		
 		if (Match(1, TOKEN_FORMAT))
 		{
@@ -1038,7 +1371,39 @@ private:
 			paren = new Token(Previous());
 		}
 
-		return new CallExpr(callee, paren, args);
+		CallExpr* call = new CallExpr(callee, paren, args);
+
+		// lower core builtins to intrinsic nodes, the interpreter falls back to the call if shadowed
+		if (EXPRESSION_VARIABLE == callee->GetType() && !((VariableExpr*)callee)->VecIndex())
+		{
+			IntrinsicTypeEnum intrinsic = IntrinsicType(((VariableExpr*)callee)->Operator()->Lexeme());
+			if (INTRINSIC_NONE != intrinsic)
+			{
+				ArgList flat = args;
+				if (1 == args.size() && EXPRESSION_STRUCTURE == args[0]->GetType()) flat = ((StructExpr*)args[0])->GetArguments();
+
+				size_t arity = (INTRINSIC_MIN == intrinsic || INTRINSIC_MAX == intrinsic) ? 2 : 1;
+				if (arity == flat.size()) return new IntrinsicExpr(intrinsic, call, flat);
+			}
+		}
+
+		return call;
+	}
+
+	IntrinsicTypeEnum IntrinsicType(std::string name)
+	{
+		if (0 == name.find("global::")) name = name.substr(8);
+
+		if ("len" == name) return INTRINSIC_LEN;
+		if ("min" == name) return INTRINSIC_MIN;
+		if ("max" == name) return INTRINSIC_MAX;
+		if ("sqrt" == name) return INTRINSIC_SQRT;
+		if ("sin" == name) return INTRINSIC_SIN;
+		if ("cos" == name) return INTRINSIC_COS;
+		if ("floor" == name) return INTRINSIC_FLOOR;
+		if ("fabs" == name) return INTRINSIC_FABS;
+		if ("sgn" == name) return INTRINSIC_SGN;
+		return INTRINSIC_NONE;
 	}
 
 	Expr* FinishFormat()
@@ -1053,7 +1418,13 @@ private:
 			paren = new Token(Previous());
 		}
 
-		return new FormatExpr(paren, args, m_fqns);
+		FormatExpr* format = new FormatExpr(paren, args, m_fqns);
+		Expr* first = args.empty() ? nullptr : EXPRESSION_STRUCTURE == args[0]->GetType() ? ((StructExpr*)args[0])->GetArguments()[0] : args[0];
+		if (first && EXPRESSION_LITERAL == first->GetType() && ((LiteralExpr*)first)->GetLiteral().IsString())
+		{
+			SegmentFormat(format, ((LiteralExpr*)first)->GetLiteral().StringRef());
+		}
+		return format;
 	}
 
 
@@ -1138,7 +1509,12 @@ private:
 		
 		if (!Consume(TOKEN_LEFT_BRACE, "Expected block for anonymous function.")) return nullptr;
 
+		bool canYield = m_canYield;
+		m_canYield = false;
+		m_functions++;
 		StmtList* body = BlockStatement();
+		m_functions--;
+		m_canYield = canYield;
 
 		return new FunctorExpr(oper, args, body, m_fqns);
 	}
@@ -1179,7 +1555,7 @@ private:
 
 		for (unsigned i = 0; i < 16; i++)
 		{
-			bytes[i] = rand() % 256;
+			bytes[i] = m_rng() % 256;
 			if (i == 0) bytes[i] = bytes[i] & 0x0f;
 			if (i == 6) bytes[i] = 0x40 | (bytes[i] & 0x0F);
 			if (i == 8) bytes[i] = 0x80 | (bytes[i] & 0x3F);
@@ -1192,10 +1568,54 @@ private:
 	}
 
 
+	// what a parallel for body may touch, see CheckParallel
+	struct ParallelScope
+	{
+		std::string var;
+		std::set<std::string> locals;
+		std::set<std::string> outputs;
+		std::vector<std::pair<Token*, bool> > shared;	// non local reads, true when indexed by the loop variable
+		std::vector<Token*> calls;						// callees named directly, checked by CheckParallelCalls
+		int loops = 0;
+		int functors = 0;
+	};
+
+	// parameters and locals of a function being inlined, see Inline
+	struct InlineScope
+	{
+		std::string self;
+		std::map<std::string, int> slots;
+		size_t nodes = 0;
+	};
+
+	// arithmetic and comparisons of a def body that a TypeProfile can specialize
+	void CollectBinaries(Stmt* stmt, std::vector<BinaryExpr*>& binaries);
+	void CollectBinaries(Expr* expr, std::vector<BinaryExpr*>& binaries);
+
+	InlineBody* Inline(FunctionStmt* stmt, bool force);
+	Expr* CloneInline(Expr* expr, InlineScope& scope);
+	Expr* InlineReturn(Stmt* stmt, InlineScope& scope);
+
+	void CheckParallel(Stmt* stmt, ParallelScope& scope);
+	void CheckParallel(Expr* expr, ParallelScope& scope);
+	void ParallelError(Token* token, const std::string& err);
+
+	// defs called from a parallel for with outputs, once every def of the script is known
+	void CheckParallelCalls();
+	static std::string ShortName(const std::string& name)
+	{
+		size_t colon = name.rfind("::");
+		return std::string::npos == colon ? name : name.substr(colon + 2);
+	}
+
+	// split a literal format() template into text, {} and {name} pieces
+	void SegmentFormat(FormatExpr* format, const std::string& text);
+
 	Token Advance();
 	bool Check(TokenTypeEnum tokenType);
 	bool CheckNext(TokenTypeEnum tokenType);
 	bool CheckNextNext(TokenTypeEnum tokenType);
+	bool CheckModifier(size_t offset); // def pure name(...), def inline name(...), def native name(...)
 	bool Consume(TokenTypeEnum tokenType, std::string err);
 	bool IsAtEnd();
 	bool Match(int count, ...);
@@ -1210,8 +1630,16 @@ private:
 	std::vector<std::string> m_namespace;
 	std::string m_fqns;
 
-	static std::set<std::string> m_includes;
+	std::set<std::string> m_includes;
+	std::mt19937 m_rng;
 	bool m_internal;
+	bool m_canYield;
+	int m_yields;
+	int m_functions;	// depth of def and functor bodies being parsed
+	bool m_quiet;		// CheckParallel on a def called from a parallel for, the first error is kept in m_quietError
+	std::string m_quietError;
+	std::map<std::string, FunList> m_defs;
+	std::vector<ParallelScope> m_parallels;	// loops with outputs, see CheckParallelCalls
 	//bool m_global;
 	
 };
@@ -0,0 +1,113 @@
+#ifndef PLUGIN_API_H
+#define PLUGIN_API_H
+
+/*
+	C ABI for native plugins.
+
+	A plugin is a shared library that exports tt_plugin_register(). Scripts load it with
+
+		include native "libfoo.so" as foo;
+
+	and everything the plugin defines ends up in the foo:: namespace. The interpreter only
+	talks to the plugin through the function table below, so a plugin built against one
+	version of the interpreter keeps working as long as TT_PLUGIN_API_VERSION matches.
+
+		#include "PluginApi.h"
+
+		static void dot(const tt_value* const* args, int32_t nargs, tt_value* ret, void* user)
+		{
+			const tt_api* api = (const tt_api*)user;
+			const double* a = api->get_vec_f32(args[0]);
+			const double* b = api->get_vec_f32(args[1]);
+			int32_t n = api->len(args[0]);
+			double sum = 0;
+			for (int32_t i = 0; i < n; ++i) sum += a[i] * b[i];
+			api->set_f32(ret, sum);
+		}
+
+		TT_PLUGIN_EXPORT int32_t tt_plugin_register(const tt_api* api)
+		{
+			if (api->version != TT_PLUGIN_API_VERSION) return 0;
+			api->define_function(api->host, "dot", 2, dot, (void*)api);
+			return 1;
+		}
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TT_PLUGIN_API_VERSION 1
+#define TT_PLUGIN_ENTRY "tt_plugin_register"
+
+#ifdef _WIN32
+#define TT_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define TT_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+// script value, only valid for the duration of the call it was passed to
+typedef struct tt_value tt_value;
+
+typedef enum tt_type
+{
+	TT_TYPE_INVALID,
+	TT_TYPE_F32,
+	TT_TYPE_I32,
+	TT_TYPE_STRING,
+	TT_TYPE_BOOL,
+	TT_TYPE_ENUM,
+	TT_TYPE_VEC,
+	TT_TYPE_OTHER,
+} tt_type;
+
+// arity of a function that accepts any number of arguments
+#define TT_VARIADIC -1
+
+// native function, leaving ret untouched returns nothing to the script
+typedef void (*tt_native_fn)(const tt_value* const* args, int32_t nargs, tt_value* ret, void* userdata);
+
+typedef struct tt_api
+{
+	uint32_t version;
+	uint32_t size;				// sizeof(tt_api) on the interpreter side
+	void* host;					// pass back to the define functions
+	const char* nspace;			// namespace the plugin is loaded into, e.g. "global::foo::"
+
+	// definitions, return 0 on failure
+	int32_t (*define_function)(void* host, const char* name, int32_t arity, tt_native_fn fn, void* userdata);
+	int32_t (*define_i32)(void* host, const char* name, int32_t value);
+	int32_t (*define_f32)(void* host, const char* name, double value);
+	int32_t (*define_string)(void* host, const char* name, const char* value);
+
+	// argument access
+	tt_type (*type_of)(const tt_value* v);
+	tt_type (*vec_type_of)(const tt_value* v);
+	int32_t (*len)(const tt_value* v);
+	int32_t (*get_i32)(const tt_value* v);
+	double (*get_f32)(const tt_value* v);
+	int32_t (*get_bool)(const tt_value* v);
+	const char* (*get_string)(const tt_value* v);
+	const char* (*get_enum)(const tt_value* v);
+	const double* (*get_vec_f32)(const tt_value* v);
+	const int32_t* (*get_vec_i32)(const tt_value* v);
+
+	// return values
+	void (*set_i32)(tt_value* ret, int32_t value);
+	void (*set_f32)(tt_value* ret, double value);
+	void (*set_bool)(tt_value* ret, int32_t value);
+	void (*set_string)(tt_value* ret, const char* value);
+	void (*set_vec_f32)(tt_value* ret, const double* values, int32_t count);
+	void (*set_vec_i32)(tt_value* ret, const int32_t* values, int32_t count);
+} tt_api;
+
+// entry point, return 0 to reject the load
+typedef int32_t (*tt_plugin_register_fn)(const tt_api* api);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
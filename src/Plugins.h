@@ -0,0 +1,166 @@
+#ifndef PLUGINS_H
+#define PLUGINS_H
+
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "Environment.h"
+#include "Literal.h"
+#include "Output.h"
+#include "PluginApi.h"
+
+
+// host side of the native plugin C ABI, see PluginApi.h
+class Plugins
+{
+public:
+
+	// load a shared library and let it define its functions in fqns, returns false on failure
+	static bool Load(Environment* globals, const std::string& filename, const std::string& fqns)
+	{
+		void* entry = nullptr;
+#ifdef _WIN32
+		HMODULE lib = LoadLibraryA(filename.c_str());
+		if (lib) entry = (void*)GetProcAddress(lib, TT_PLUGIN_ENTRY);
+		if (!lib)
+		{
+			Output::Report("Failed to load native plugin: '%s'\n", filename.c_str());
+			return false;
+		}
+#else
+		void* lib = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+		if (lib) entry = dlsym(lib, TT_PLUGIN_ENTRY);
+		if (!lib)
+		{
+			Output::Report("Failed to load native plugin: '%s' (%s)\n", filename.c_str(), dlerror());
+			return false;
+		}
+#endif
+		if (!entry)
+		{
+			Output::Report("Native plugin '%s' does not export %s().\n", filename.c_str(), TT_PLUGIN_ENTRY);
+			Close(lib);
+			return false;
+		}
+
+		// once it has registered the library is never unloaded, so the table has to outlive this call as well
+		Host* host = new Host { globals, fqns, false };
+		tt_api* api = new tt_api(MakeApi());
+		api->host = host;
+		api->nspace = host->fqns.c_str();
+
+		if (0 == ((tt_plugin_register_fn)entry)(api))
+		{
+			Output::Report("Native plugin '%s' failed to register.\n", filename.c_str());
+			delete api;
+			delete host;
+			Close(lib);
+			return false;
+		}
+
+		// definitions are held back until here, so a rejected plugin leaves nothing that calls into it
+		for (auto& d : host->defined) globals->Define(d.first, d.second, host->fqns);
+		host->defined.clear();
+		host->registered = true;
+		return true;
+	}
+
+private:
+
+	struct Host
+	{
+		Environment* globals;
+		std::string fqns;
+		bool registered;
+		std::vector<std::pair<std::string, Literal> > defined;
+	};
+
+#ifdef _WIN32
+	static void Close(HMODULE lib) { FreeLibrary(lib); }
+#else
+	static void Close(void* lib) { dlclose(lib); }
+#endif
+
+	static const Literal& Value(const tt_value* v) { return *(const Literal*)v; }
+	static Literal& Value(tt_value* v) { return *(Literal*)v; }
+
+	static tt_api MakeApi()
+	{
+		tt_api api = {};
+		api.version = TT_PLUGIN_API_VERSION;
+		api.size = sizeof(tt_api);
+
+		api.define_function = [](void* host, const char* name, int32_t arity, tt_native_fn fn, void* userdata)->int32_t
+		{
+			if (!name || !fn) return 0;
+			Literal ftn;
+			ftn.SetCallable(arity < 0 ? 0 : arity, [fn, userdata](const LiteralList& args)->Literal
+			{
+				std::vector<const tt_value*> argv(args.size());
+				for (size_t i = 0; i < args.size(); ++i) argv[i] = (const tt_value*)&args[i];
+
+				Literal ret;
+				fn(argv.data(), int32_t(argv.size()), (tt_value*)&ret, userdata);
+				return ret;
+			}, ((Host*)host)->fqns, arity >= 0);
+			return Define(host, name, ftn);
+		};
+		api.define_i32 = [](void* host, const char* name, int32_t value)->int32_t { return Define(host, name, Literal(value)); };
+		api.define_f32 = [](void* host, const char* name, double value)->int32_t { return Define(host, name, Literal(value)); };
+		api.define_string = [](void* host, const char* name, const char* value)->int32_t { return Define(host, name, Literal(std::string(value ? value : ""))); };
+
+		api.type_of = [](const tt_value* v) { return TypeOf(Value(v).GetType()); };
+		api.vec_type_of = [](const tt_value* v) { return Value(v).IsVector() ? TypeOf(Value(v).GetVecType()) : TT_TYPE_INVALID; };
+		api.len = [](const tt_value* v) { return Value(v).Len(); };
+		api.get_i32 = [](const tt_value* v) { return Value(v).IntValue(); };
+		api.get_f32 = [](const tt_value* v) { return Value(v).DoubleValue(); };
+		api.get_bool = [](const tt_value* v) { return int32_t(Value(v).IsBool() && Value(v).BoolValue()); };
+		api.get_string = [](const tt_value* v) { return Value(v).IsString() ? Value(v).StringRef().c_str() : nullptr; };
+		api.get_enum = [](const tt_value* v) { return Value(v).IsEnum() ? Value(v).EnumRef().c_str() : nullptr; };
+		api.get_vec_f32 = [](const tt_value* v) { return Value(v).IsVector() && Value(v).IsVecDouble() ? Value(v).VecRef_D().data() : nullptr; };
+		api.get_vec_i32 = [](const tt_value* v) { return Value(v).IsVector() && Value(v).IsVecInteger() ? Value(v).VecRef_I().data() : nullptr; };
+
+		api.set_i32 = [](tt_value* ret, int32_t value) { Value(ret) = Literal(value); };
+		api.set_f32 = [](tt_value* ret, double value) { Value(ret) = Literal(value); };
+		api.set_bool = [](tt_value* ret, int32_t value) { Value(ret) = Literal(0 != value); };
+		api.set_string = [](tt_value* ret, const char* value) { Value(ret) = Literal(std::string(value ? value : "")); };
+		api.set_vec_f32 = [](tt_value* ret, const double* values, int32_t count) { Value(ret) = Literal(std::vector<double>(values, values + count)); };
+		api.set_vec_i32 = [](tt_value* ret, const int32_t* values, int32_t count) { Value(ret) = Literal(std::vector<int32_t>(values, values + count)); };
+
+		return api;
+	}
+
+	static int32_t Define(void* host, const char* name, const Literal& value)
+	{
+		if (!name) return 0;
+		Host* h = (Host*)host;
+		if (h->registered) h->globals->Define(name, value, h->fqns);
+		else h->defined.push_back(std::make_pair(std::string(name), value));
+		return 1;
+	}
+
+	static tt_type TypeOf(LiteralTypeEnum type)
+	{
+		switch (type)
+		{
+		case LITERAL_TYPE_INVALID: return TT_TYPE_INVALID;
+		case LITERAL_TYPE_DOUBLE: return TT_TYPE_F32;
+		case LITERAL_TYPE_INTEGER: return TT_TYPE_I32;
+		case LITERAL_TYPE_STRING: return TT_TYPE_STRING;
+		case LITERAL_TYPE_BOOL: return TT_TYPE_BOOL;
+		case LITERAL_TYPE_ENUM: return TT_TYPE_ENUM;
+		case LITERAL_TYPE_VEC: return TT_TYPE_VEC;
+		default: break;
+		}
+		return TT_TYPE_OTHER;
+	}
+};
+
+#endif
@@ -1,3 +1,5 @@
+#include <charconv>
+
 #include "Scanner.h"
 #include "Utility.h"
 
@@ -123,12 +125,21 @@ void Scanner::Number()
 		while (IsDigit(Peek())) { Advance(); }
 	}
 
-	std::string t = m_buffer.substr(m_start, m_current - m_start);
-	
+	const char* first = m_buffer.c_str() + m_start;
+	const char* last = m_buffer.c_str() + m_current;
+
 	if (isInt)
-		AddToken(TOKEN_INTEGER, int32_t(std::stoi(t)));
+	{
+		int32_t value = 0;
+		if (std::errc() != std::from_chars(first, last, value).ec) m_errorHandler->Error(m_filename, m_line, "Integer literal out of range.");
+		AddToken(TOKEN_INTEGER, value);
+	}
 	else
-		AddToken(TOKEN_FLOAT, std::stod(t));
+	{
+		double value = 0;
+		std::from_chars(first, last, value);
+		AddToken(TOKEN_FLOAT, value);
+	}
 }
 
 char Scanner::Peek()
@@ -168,22 +179,24 @@ void Scanner::ScanToken()
 	case '[': AddToken(TOKEN_LEFT_BRACKET); break;
 	case ']': AddToken(TOKEN_RIGHT_BRACKET); break;
 	case ',': AddToken(TOKEN_COMMA); break;
-	case '-': AddToken(TOKEN_MINUS); break;
-	case '+': AddToken(TOKEN_PLUS); break;
+	case '-': AddToken(Match('=') ? TOKEN_MINUS_EQUAL : Match('-') ? TOKEN_MINUS_MINUS : TOKEN_MINUS); break;
+	case '+': AddToken(Match('=') ? TOKEN_PLUS_EQUAL : Match('+') ? TOKEN_PLUS_PLUS : TOKEN_PLUS); break;
 	case ';': AddToken(TOKEN_SEMICOLON); break;
-	case '*': AddToken(TOKEN_STAR); break;
-	case '%': AddToken(TOKEN_PERCENT); break;
+	case '*': AddToken(Match('=') ? TOKEN_STAR_EQUAL : TOKEN_STAR); break;
+	case '%': AddToken(Match('=') ? TOKEN_PERCENT_EQUAL : TOKEN_PERCENT); break;
 	case '@': AddToken(TOKEN_AT); break;
+	case '^': AddToken(TOKEN_CARET); break;
+	case '~': AddToken(TOKEN_TILDE); break;
 
 	// one or two character tokens
 	case '!': AddToken(Match('=') ? TOKEN_BANG_EQUAL : TOKEN_BANG); break;
-	case '=': AddToken(Match('=') ? TOKEN_EQUAL_EQUAL : TOKEN_EQUAL); break;
-	case '>': AddToken(Match('=') ? TOKEN_GREATER_EQUAL : TOKEN_GREATER); break;
-	case '<': AddToken(Match('=') ? TOKEN_LESS_EQUAL : TOKEN_LESS); break;
+	case '=': AddToken(Match('=') ? TOKEN_EQUAL_EQUAL : Match('>') ? TOKEN_ARROW : TOKEN_EQUAL); break;
+	case '>': AddToken(Match('=') ? TOKEN_GREATER_EQUAL : Match('>') ? TOKEN_GREATER_GREATER : TOKEN_GREATER); break;
+	case '<': AddToken(Match('=') ? TOKEN_LESS_EQUAL : Match('<') ? TOKEN_LESS_LESS : TOKEN_LESS); break;
+	case '&': AddToken(Match('&') ? TOKEN_AND : TOKEN_AMPERSAND); break;
+	case '|': AddToken(Match('|') ? TOKEN_OR : TOKEN_PIPE); break;
 	
 	// two character tokens
-	case '&': Match('&') ? AddToken(TOKEN_AND) : m_errorHandler->Error(m_filename, m_line, "Unexpected character"); break;
-	case '|': Match('|') ? AddToken(TOKEN_OR) : m_errorHandler->Error(m_filename, m_line, "Unexpected character"); break;
 	case ':':
 		/*if (Match(':'))
 		{
@@ -235,7 +248,7 @@ void Scanner::ScanToken()
 		}
 		else
 		{
-			AddToken(TOKEN_SLASH);
+			AddToken(Match('=') ? TOKEN_SLASH_EQUAL : TOKEN_SLASH);
 		}
 		break;
 
@@ -46,8 +46,10 @@ public:
 		m_keywordList.insert(std::make_pair("break", TOKEN_BREAK));
 		m_keywordList.insert(std::make_pair("continue", TOKEN_CONTINUE));
 		m_keywordList.insert(std::make_pair("loop", TOKEN_LOOP));
+		m_keywordList.insert(std::make_pair("match", TOKEN_MATCH));
 		m_keywordList.insert(std::make_pair("def", TOKEN_DEF));
 		m_keywordList.insert(std::make_pair("return", TOKEN_RETURN));
+		m_keywordList.insert(std::make_pair("yield", TOKEN_YIELD));
 		m_keywordList.insert(std::make_pair("struct", TOKEN_STRUCT));
 		m_keywordList.insert(std::make_pair("include", TOKEN_INCLUDE));
 		m_keywordList.insert(std::make_pair("internal", TOKEN_INTERNAL));
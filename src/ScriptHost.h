@@ -0,0 +1,310 @@
+#ifndef SCRIPT_HOST_H
+#define SCRIPT_HOST_H
+
+#include <string>
+#include <memory>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+#include "Scanner.h"
+#include "Parser.h"
+#include "Interpreter.h"
+#include "ErrorHandler.h"
+#include "Binding.h"
+
+// Embedding API for hosting scripts in a C++ program.
+//
+//     ScriptHost host;
+//     host.LoadFile("game.tt");
+//     ScriptFunction update = host.Function("update");
+//     ScriptFunction draw = host.Function("draw");
+//     while (running) { update(dt); draw(); }
+//
+// A program is scanned, parsed and run once by Load. Function handles resolve
+// their name once and keep their argument list, so a call only converts the
+// arguments in place and runs the function body.
+//
+// Fork copies the script state of a loaded host without running anything again,
+// e.g. for a lookahead search that plays out many copies of one game state.
+// Each fork can run on its own thread, next to the host and the other forks.
+//
+// Start runs a call in time slices, so a frame never waits on a long update:
+//
+//     ScriptTask task = update.Start(dt);
+//     while (!task.Run(std::chrono::microseconds(2000))) { present_frame(); }
+//
+// Errors are printed as they are found, like Load does, and Failed() tells
+// whether the last call of a function or a task reported any.
+
+
+// print and clear what the script reported, false when there was anything
+inline bool ReportErrors(ErrorHandler* errorHandler)
+{
+	if (!errorHandler->HasErrors()) return true;
+	errorHandler->Print();
+	errorHandler->Clear();
+	return false;
+}
+
+
+// a script call that is suspended when it runs over its time budget and continued by the next Run
+class ScriptTask
+{
+public:
+
+	ScriptTask() : m_interpreter(nullptr), m_failed(true) {}
+
+	bool Done() const { return !m_task || m_task->Done(); }
+
+	// the call could not start or reported errors while running
+	bool Failed() const { return m_failed; }
+
+	// the call's return value once it is Done
+	Literal Result() const { return m_task ? m_task->Value() : Literal(); }
+
+	// run until the call returns or budget has passed, true once it has returned
+	bool Run(std::chrono::microseconds budget)
+	{
+		if (Done()) return true;
+		bool done = m_interpreter->RunSlice(m_task.get(), std::chrono::steady_clock::now() + budget);
+		if (!ReportErrors(m_interpreter->GetErrorHandler())) m_failed = true;
+		return done;
+	}
+
+private:
+
+	friend class ScriptFunction;
+
+	Interpreter* m_interpreter;
+	std::shared_ptr<Generator> m_task;
+	bool m_failed;
+};
+
+
+class ScriptFunction
+{
+public:
+
+	ScriptFunction() : m_interpreter(nullptr), m_token(TOKEN_IDENTIFIER, "", 0, "host"), m_failed(false) {}
+
+	ScriptFunction(Interpreter* interpreter, const std::string& name, size_t arity) : m_interpreter(interpreter), m_token(TOKEN_IDENTIFIER, name, 0, "host"), m_failed(false)
+	{
+		m_args.resize(arity);
+	}
+
+	bool IsValid() { return nullptr != Resolve(); }
+
+	// the last call could not run or reported errors, the returned value is then invalid
+	bool Failed() const { return m_failed; }
+
+	template <typename... A>
+	Literal operator()(A... args)
+	{
+		m_failed = true;
+		Literal* callee = Resolve();
+		if (!callee)
+		{
+			Output::Report("Script function '%s' is not defined.\n", m_token.Lexeme().c_str());
+			return Literal();
+		}
+
+		if (callee->ExplicitArgs() && sizeof...(A) != m_args.size())
+		{
+			Output::Report("Expected %d arguments for '%s', but found %d.\n", int(m_args.size()), m_token.Lexeme().c_str(), int(sizeof...(A)));
+			return Literal();
+		}
+
+		size_t i = 0;
+		(SetArg(i++, args), ...);
+		Literal ret = callee->Call(m_interpreter, m_args);
+		m_failed = !ReportErrors(m_interpreter->GetErrorHandler());
+		return m_failed ? Literal() : ret;
+	}
+
+	// suspendable call, nothing runs until ScriptTask::Run
+	template <typename... A>
+	ScriptTask Start(A... args)
+	{
+		ScriptTask task;
+		Literal* callee = Resolve();
+		if (!callee)
+		{
+			Output::Report("Script function '%s' is not defined.\n", m_token.Lexeme().c_str());
+			return task;
+		}
+
+		if (callee->ExplicitArgs() && sizeof...(A) != m_args.size())
+		{
+			Output::Report("Expected %d arguments for '%s', but found %d.\n", int(m_args.size()), m_token.Lexeme().c_str(), int(sizeof...(A)));
+			return task;
+		}
+
+		// the task keeps its own copy of the function and arguments, m_args is reused by the next call
+		size_t i = 0;
+		(SetArg(i++, args), ...);
+		Interpreter* interpreter = m_interpreter;
+		Literal ftn = *callee;
+		LiteralList list = m_args;
+
+		task.m_interpreter = interpreter;
+		task.m_failed = false;
+		task.m_task = std::make_shared<Generator>(interpreter, [interpreter, ftn, list]() mutable { return ftn.Call(interpreter, std::move(list)); });
+		return task;
+	}
+
+	// call with a time budget, the returned task is Done when the call finished within it
+	template <typename... A>
+	ScriptTask RunFor(std::chrono::microseconds budget, A... args)
+	{
+		ScriptTask task = Start(args...);
+		task.Run(budget);
+		return task;
+	}
+
+	// call and convert the result to a native type
+	template <typename R, typename... A>
+	R CallAs(A... args)
+	{
+		Literal ret = (*this)(args...);
+		if (!ArgConv<R>::Check(ret)) return R();
+		return ArgConv<R>::Get(ret);
+	}
+
+private:
+
+	// only re-resolved when global definitions change
+	Literal* Resolve()
+	{
+		if (!m_interpreter) return nullptr;
+		Environment* globals = m_interpreter->GetGlobals();
+		if (m_cache.env != globals || m_cache.epoch != globals->Epoch())
+		{
+			// only the lookup's own error for an undefined name is dropped
+			ErrorHandler* errorHandler = m_interpreter->GetErrorHandler();
+			ReportErrors(errorHandler);
+			bool isGlobal = false;
+			Literal* slot = globals->Lookup(&m_token, "global::", isGlobal);
+			errorHandler->Clear();
+
+			m_cache.env = globals;
+			m_cache.epoch = globals->Epoch();
+			m_cache.slot = (slot && slot->IsCallable()) ? slot : nullptr;
+		}
+		return m_cache.slot;
+	}
+
+	template <typename T>
+	void SetArg(size_t i, const T& value)
+	{
+		if (i < m_args.size()) m_args[i] = ReturnConv(value);
+		else m_args.push_back(ReturnConv(value));
+	}
+
+	void SetArg(size_t i, const char* value) { SetArg(i, std::string(value)); }
+
+	Interpreter* m_interpreter;
+	Token m_token;
+	GlobalCache m_cache;
+	LiteralList m_args;
+	bool m_failed;
+};
+
+
+class ScriptHost
+{
+public:
+
+	ScriptHost()
+	{
+		m_errorHandler = new ErrorHandler();
+		m_interpreter = new Interpreter(m_errorHandler);
+	}
+
+	~ScriptHost()
+	{
+		delete m_interpreter;
+		delete m_errorHandler;
+	}
+
+	// owns its interpreter, use Fork for a copy of the script state
+	ScriptHost(const ScriptHost&) = delete;
+	ScriptHost& operator=(const ScriptHost&) = delete;
+
+	// scan, parse and run the top level of a program, returns false on errors
+	bool Load(const std::string& source, const std::string& filename)
+	{
+		Scanner scanner(source.c_str(), m_errorHandler, filename.c_str());
+		TokenList tokens = scanner.ScanTokens();
+
+		if (!m_errorHandler->HasErrors())
+		{
+			Parser parser(tokens, m_errorHandler);
+			StmtList stmts = parser.Parse();
+			if (!m_errorHandler->HasErrors()) m_interpreter->Interpret(stmts);
+		}
+
+		return ReportErrors(m_errorHandler);
+	}
+
+	bool LoadFile(const std::string& filename)
+	{
+		std::ifstream f(filename, std::ios::in | std::ios::binary);
+		if (!f.is_open())
+		{
+			Output::Report("Failed to open file: %s\n", filename.c_str());
+			return false;
+		}
+
+		std::stringstream ss;
+		ss << f.rdbuf();
+		return Load(ss.str(), filename);
+	}
+
+	// handle for calling a script function, namespaced names like "game::update" are allowed
+	ScriptFunction Function(const std::string& name)
+	{
+		Token token(TOKEN_IDENTIFIER, name, 0, "host");
+		ReportErrors(m_errorHandler);
+		bool isGlobal = false;
+		Literal* slot = m_interpreter->GetGlobals()->Lookup(&token, "global::", isGlobal);
+		m_errorHandler->Clear();
+
+		if (!slot || !slot->IsCallable())
+		{
+			Output::Report("Script function '%s' is not defined.\n", name.c_str());
+			return ScriptFunction(nullptr, name, 0);
+		}
+		return ScriptFunction(m_interpreter, name, slot->ExplicitArgs() ? slot->Arity() : 0);
+	}
+
+	// define a native function the script can call
+	template <typename F>
+	void Bind(const char* name, F ftn, std::string fqns = "global::")
+	{
+		::Bind(m_interpreter->GetGlobals(), name, ftn, fqns);
+	}
+
+	// independent copy of the current globals, vectors, maps and struct instances
+	// are shared copy on write so this is cheap even for a large game state
+	std::unique_ptr<ScriptHost> Fork() const
+	{
+		return std::unique_ptr<ScriptHost>(new ScriptHost(m_interpreter->GetGlobals()));
+	}
+
+	Interpreter* GetInterpreter() { return m_interpreter; }
+
+private:
+
+	ScriptHost(const Environment* snapshot)
+	{
+		m_errorHandler = new ErrorHandler();
+		m_interpreter = new Interpreter(m_errorHandler, snapshot);
+	}
+
+	ErrorHandler* m_errorHandler;
+	Interpreter* m_interpreter;
+};
+
+#endif
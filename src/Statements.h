@@ -2,12 +2,18 @@
 #define STATEMENTS_H
 
 #include <assert.h>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
 
 #include "Enums.h"
 #include "Token.h"
 #include "Expressions.h"
 
 class FunctionStmt;
+class Memo;
+class TypeProfile;
+class NativeCode;
 
 class Stmt
 {
@@ -57,34 +63,89 @@ private:
 };
 
 
+// body of a small function rewritten over numbered slots instead of a scope, see Parser::Inline,
+// the parameters take the first slots and def locals the ones after them
+struct InlineBody
+{
+	static const size_t MAX_SLOTS = 8;
+
+	// def local when slot is set, guarded return when cond is set, otherwise the final return
+	struct Step
+	{
+		Expr* cond;
+		Expr* value;
+		int slot;
+	};
+
+	size_t params;
+	std::vector<Step> steps;
+};
+
+
 class FunctionStmt : public Stmt
 {
 public:
 	FunctionStmt() = delete;
 
-	FunctionStmt(Token* name, TokenList params, StmtList* body, std::string fqns, bool internal = true)
+	FunctionStmt(Token* name, TokenList params, StmtList* body, std::string fqns, bool internal = true, bool generator = false, std::vector<bool> refs = std::vector<bool>(), Memo* memo = nullptr)
 	{
 		m_name = name;
 		m_params = params;
 		m_body = body;
 		m_fqns = fqns;
 		m_internal = internal;
+		m_generator = generator;
+		m_refs = refs;
+		m_refs.resize(params.size(), false);
+		m_memo = memo;
+		m_inline = nullptr;
+		m_profile = nullptr;
+		m_native = nullptr;
 	}
 
 	StatementTypeEnum GetType() { return STATEMENT_FUNCTION; }
 
 	Token* Operator() { return m_name; }
-	TokenList GetParams() { return m_params; }
+	const TokenList& GetParams() { return m_params; }
 	StmtList* GetBody() { return m_body; }
 	std::string FQNS() { return m_fqns; }
 	bool Internal() { return m_internal; }
 
+	// body contains yield, calls return a generator
+	bool IsGenerator() { return m_generator; }
+
+	// parameter declared as &name, bound to the caller's variable
+	bool IsRef(size_t i) { return i < m_refs.size() && m_refs[i]; }
+	bool HasRefs() { return std::find(m_refs.begin(), m_refs.end(), true) != m_refs.end(); }
+
+	// declared as def pure, calls go through the memo
+	bool IsPure() { return nullptr != m_memo; }
+	Memo* GetMemo() { return m_memo; }
+
+	// small enough to be evaluated at the call site, nullptr otherwise
+	InlineBody* GetInline() { return m_inline; }
+	void SetInline(InlineBody* body) { m_inline = body; }
+
+	// argument types seen by calls, nullptr for generators
+	TypeProfile* GetProfile() { return m_profile; }
+	void SetProfile(TypeProfile* profile) { m_profile = profile; }
+
+	// declared as def native, calls run compiled C when they can
+	NativeCode* GetNative() { return m_native; }
+	void SetNative(NativeCode* native) { m_native = native; }
+
 private:
 	Token* m_name;
 	TokenList m_params;
 	StmtList* m_body;
 	std::string m_fqns;
 	bool m_internal;
+	bool m_generator;
+	std::vector<bool> m_refs;
+	Memo* m_memo;
+	InlineBody* m_inline;
+	TypeProfile* m_profile;
+	NativeCode* m_native;
 };
 
 
@@ -120,6 +181,29 @@ public:
 };
 
 
+// include native "libfoo.so" as foo;
+class NativeIncludeStmt : public Stmt
+{
+public:
+	NativeIncludeStmt() = delete;
+
+	NativeIncludeStmt(std::string filename, std::string fqns)
+	{
+		m_filename = filename;
+		m_fqns = fqns;
+	}
+
+	StatementTypeEnum GetType() { return STATEMENT_NATIVE_INCLUDE; }
+
+	std::string Filename() { return m_filename; }
+	std::string FQNS() { return m_fqns; }
+
+private:
+	std::string m_filename;
+	std::string m_fqns;
+};
+
+
 class PrintStmt : public Stmt
 {
 public:
@@ -169,6 +253,8 @@ public:
 
 	StatementTypeEnum GetType() { return STATEMENT_BREAK; }
 
+	Token* Keyword() { return m_keyword; }
+
 	//Expr* GetValueExpr() { return m_value; }
 
 private:
@@ -188,6 +274,8 @@ public:
 
 	StatementTypeEnum GetType() { return STATEMENT_CONTINUE; }
 
+	Token* Keyword() { return m_keyword; }
+
 	//Expr* GetValueExpr() { return m_value; }
 
 private:
@@ -242,14 +330,42 @@ class ReturnStmt : public Stmt
 public:
 	ReturnStmt() = delete;
 
-	ReturnStmt(Token* keyword, Expr* value)
+	ReturnStmt(Token* keyword, Expr* value, bool tailCall = false)
 	{
 		m_keyword = keyword;
 		m_value = value;
+		m_tailCall = tailCall;
 	}
 
 	StatementTypeEnum GetType() { return STATEMENT_RETURN; }
 
+	Token* Keyword() { return m_keyword; }
+	Expr* GetValueExpr() { return m_value; }
+
+	// return f(...) inside a def or functor body, the value is a CallExpr
+	bool IsTailCall() { return m_tailCall; }
+
+private:
+	Token* m_keyword;
+	Expr* m_value;
+	bool m_tailCall;
+};
+
+
+class YieldStmt : public Stmt
+{
+public:
+	YieldStmt() = delete;
+
+	YieldStmt(Token* keyword, Expr* value)
+	{
+		m_keyword = keyword;
+		m_value = value;
+	}
+
+	StatementTypeEnum GetType() { return STATEMENT_YIELD; }
+
+	Token* Keyword() { return m_keyword; }
 	Expr* GetValueExpr() { return m_value; }
 
 private:
@@ -327,6 +443,41 @@ private:
 };
 
 
+// parallel for i in a..b { ... }, outputs are the vectors the body writes as v[i]
+class ParallelForStmt : public Stmt
+{
+public:
+	ParallelForStmt() = delete;
+
+	ParallelForStmt(Token* var, Expr* begin, Expr* end, StmtList* body, std::vector<std::string> outputs, std::string fqns)
+	{
+		m_var = var;
+		m_begin = begin;
+		m_end = end;
+		m_body = body;
+		m_outputs = outputs;
+		m_fqns = fqns;
+	}
+
+	StatementTypeEnum GetType() { return STATEMENT_PARALLEL_FOR; }
+
+	Token* Var() { return m_var; }
+	Expr* Begin() { return m_begin; }
+	Expr* End() { return m_end; }
+	StmtList* GetBody() { return m_body; }
+	const std::vector<std::string>& Outputs() { return m_outputs; }
+	std::string FQNS() { return m_fqns; }
+
+private:
+	Token* m_var;
+	Expr* m_begin;
+	Expr* m_end;
+	StmtList* m_body;
+	std::vector<std::string> m_outputs;
+	std::string m_fqns;
+};
+
+
 class WhileStmt : public Stmt
 {
 public:
@@ -354,4 +505,132 @@ private:
 	std::string m_label;
 };
 
+
+
+// match value { :A => {...}, 1..=3 => {...}, "s" => {...}, _ => {...} }, the patterns are
+// gathered into tables by the parser so an arm is found with one lookup, not a compare per arm
+class MatchStmt : public Stmt
+{
+public:
+	MatchStmt() = delete;
+
+	// i32 patterns spanning at most this many values dispatch through a jump table
+	static const int64_t MAX_TABLE = 1024;
+
+	MatchStmt(Token* keyword, Expr* subject)
+	{
+		m_keyword = keyword;
+		m_subject = subject;
+		m_fallback = nullptr;
+		m_base = 0;
+	}
+
+	StatementTypeEnum GetType() { return STATEMENT_MATCH; }
+
+	Token* Keyword() { return m_keyword; }
+	Expr* Subject() { return m_subject; }
+	const StmtList& Arms() { return m_arms; }
+	Stmt* Fallback() { return m_fallback; }
+
+	// patterns of the next arm, an earlier arm wins when patterns overlap
+	void AddEnum(const std::string& value) { m_enums.emplace(value, int(m_arms.size())); }
+	void AddString(const std::string& value) { m_strings.emplace(value, int(m_arms.size())); }
+	void AddRange(int32_t lo, int32_t hi) { m_ranges.push_back({ lo, hi, int(m_arms.size()) }); }
+	void AddArm(Stmt* body) { m_arms.push_back(body); }
+	void SetFallback(Stmt* body) { m_fallback = body; }
+
+	// build the i32 tables once every arm has been added
+	void Finish()
+	{
+		if (m_ranges.empty()) return;
+
+		int64_t lo = m_ranges[0].lo, hi = m_ranges[0].hi;
+		for (const Range& r : m_ranges)
+		{
+			lo = std::min<int64_t>(lo, r.lo);
+			hi = std::max<int64_t>(hi, r.hi);
+		}
+
+		if (hi - lo < MAX_TABLE)
+		{
+			m_base = int32_t(lo);
+			m_table.assign(size_t(hi - lo + 1), -1);
+			for (const Range& r : m_ranges)
+			{
+				for (int64_t v = r.lo; v <= r.hi; ++v)
+				{
+					if (-1 == m_table[size_t(v - lo)]) m_table[size_t(v - lo)] = r.arm;
+				}
+			}
+			m_ranges.clear();
+			return;
+		}
+
+		// sparse, single values go in a hash and only real ranges are scanned
+		std::vector<Range> ranges;
+		for (const Range& r : m_ranges)
+		{
+			if (r.lo == r.hi) m_ints.emplace(r.lo, r.arm);
+			else ranges.push_back(r);
+		}
+		m_ranges = ranges;
+	}
+
+	// arm for value, -1 when only the fallback applies
+	int Find(const Literal& value) const
+	{
+		if (value.IsEnum()) return Find(m_enums, value.EnumRef());
+		if (value.IsString()) return Find(m_strings, value.StringRef());
+
+		// a whole f32 matches the same arm as the i32, like == does
+		int32_t i = 0;
+		double d = value.DoubleValue();
+		if (value.IsInt()) i = value.IntValue();
+		else if (value.IsDouble() && -2147483648.0 <= d && d <= 2147483647.0 && double(int32_t(d)) == d) i = int32_t(d);
+		else return -1;
+
+		if (!m_table.empty())
+		{
+			int64_t at = int64_t(i) - m_base;
+			return (0 <= at && at < int64_t(m_table.size())) ? m_table[size_t(at)] : -1;
+		}
+
+		auto it = m_ints.find(i);
+		int arm = m_ints.end() == it ? -1 : it->second;
+
+		// ranges are kept in arm order, only an earlier one can take precedence
+		for (const Range& r : m_ranges)
+		{
+			if (-1 != arm && r.arm > arm) break;
+			if (r.lo <= i && i <= r.hi) return r.arm;
+		}
+		return arm;
+	}
+
+private:
+	struct Range
+	{
+		int32_t lo;
+		int32_t hi;
+		int arm;
+	};
+
+	static int Find(const std::unordered_map<std::string, int>& table, const std::string& key)
+	{
+		auto it = table.find(key);
+		return table.end() == it ? -1 : it->second;
+	}
+
+	Token* m_keyword;
+	Expr* m_subject;
+	StmtList m_arms;
+	Stmt* m_fallback;
+	std::unordered_map<std::string, int> m_enums;
+	std::unordered_map<std::string, int> m_strings;
+	std::unordered_map<int32_t, int> m_ints;
+	std::vector<Range> m_ranges;
+	std::vector<int> m_table;
+	int32_t m_base;
+};
+
 #endif // STATEMENTS_H
\ No newline at end of file
@@ -0,0 +1,172 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Fixed set of worker threads for data parallel loops.
+//
+// ParallelFor splits an integer range evenly across the workers and the
+// calling thread. Each one works through its own part in grain sized chunks
+// and, once it runs dry, steals the upper half of whatever another worker
+// has left, so uneven iterations still keep every thread busy.
+class ThreadPool
+{
+public:
+	typedef std::function<void(size_t worker, int32_t begin, int32_t end)> RangeFunction;
+
+	// threads includes the calling thread, so 1 runs everything inline
+	ThreadPool(size_t threads)
+	{
+		m_count = std::max<size_t>(1, threads);
+		m_slots.reset(new Slot[m_count]);
+		m_ftn = nullptr;
+		m_grain = 1;
+		m_generation = 0;
+		m_active = 0;
+		m_stop = false;
+
+		for (size_t i = 1; i < m_count; ++i)
+		{
+			m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (auto& t : m_threads) t.join();
+	}
+
+	size_t Size() const { return m_count; }
+
+	// returns once ftn has been called for every index in [begin, end), ftn must not throw
+	void ParallelFor(int32_t begin, int32_t end, int32_t grain, const RangeFunction& ftn)
+	{
+		if (begin >= end) return;
+
+		std::lock_guard<std::mutex> run(m_run);
+
+		int64_t n = int64_t(end) - begin;
+		for (size_t i = 0; i < m_count; ++i)
+		{
+			m_slots[i].begin = int32_t(begin + n * int64_t(i) / int64_t(m_count));
+			m_slots[i].end = int32_t(begin + n * int64_t(i + 1) / int64_t(m_count));
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_ftn = &ftn;
+			m_grain = std::max(1, grain);
+			m_active = m_count - 1;
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		Work(0);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this] { return 0 == m_active; });
+		m_ftn = nullptr;
+	}
+
+private:
+
+	struct alignas(64) Slot
+	{
+		std::mutex mutex;
+		int32_t begin = 0;
+		int32_t end = 0;
+	};
+
+	void WorkerLoop(size_t worker)
+	{
+		uint64_t seen = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [&] { return m_stop || seen != m_generation; });
+				if (m_stop) return;
+				seen = m_generation;
+			}
+
+			Work(worker);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (0 == --m_active) m_done.notify_one();
+		}
+	}
+
+	void Work(size_t worker)
+	{
+		int32_t b, e;
+		do
+		{
+			while (Take(worker, b, e)) (*m_ftn)(worker, b, e);
+		} while (Steal(worker));
+	}
+
+	// next chunk from the front of our own range
+	bool Take(size_t worker, int32_t& b, int32_t& e)
+	{
+		Slot& slot = m_slots[worker];
+		std::lock_guard<std::mutex> lock(slot.mutex);
+		if (slot.begin >= slot.end) return false;
+		b = slot.begin;
+		e = std::min(slot.end, slot.begin + m_grain);
+		slot.begin = e;
+		return true;
+	}
+
+	// move the upper half of another worker's range into ours, false when nothing is left anywhere
+	bool Steal(size_t worker)
+	{
+		for (size_t k = 1; k < m_count; ++k)
+		{
+			Slot& victim = m_slots[(worker + k) % m_count];
+			int32_t b, e;
+			{
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				int32_t left = victim.end - victim.begin;
+				if (left <= 0) continue;
+				b = victim.end - (left + 1) / 2;
+				e = victim.end;
+				victim.end = b;
+			}
+
+			Slot& mine = m_slots[worker];
+			std::lock_guard<std::mutex> lock(mine.mutex);
+			mine.begin = b;
+			mine.end = e;
+			return true;
+		}
+		return false;
+	}
+
+	size_t m_count;
+	std::unique_ptr<Slot[]> m_slots;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_run;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const RangeFunction* m_ftn;
+	int32_t m_grain;
+	uint64_t m_generation;
+	size_t m_active;
+	bool m_stop;
+};
+
+#endif // THREAD_POOL_H
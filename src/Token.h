@@ -63,6 +63,9 @@ public:
 		case TOKEN_SLASH: type = "TOKEN_SLASH"; break;
 		case TOKEN_STAR: type = "TOKEN_STAR"; break;
 		case TOKEN_AT: type = "TOKEN_AT"; break;
+		case TOKEN_PIPE: type = "TOKEN_PIPE"; break;
+		case TOKEN_CARET: type = "TOKEN_CARET"; break;
+		case TOKEN_TILDE: type = "TOKEN_TILDE"; break;
 
 		// one or two character tokens
 		case TOKEN_BANG: type = "TOKEN_BANG"; break;
@@ -73,6 +76,16 @@ public:
 		case TOKEN_GREATER_EQUAL: type = "TOKEN_GREATER_EQUAL"; break;
 		case TOKEN_LESS: type = "TOKEN_LESS"; break;
 		case TOKEN_LESS_EQUAL: type = "TOKEN_LESS_EQUAL"; break;
+		case TOKEN_LESS_LESS: type = "TOKEN_LESS_LESS"; break;
+		case TOKEN_GREATER_GREATER: type = "TOKEN_GREATER_GREATER"; break;
+		case TOKEN_ARROW: type = "TOKEN_ARROW"; break;
+		case TOKEN_PLUS_EQUAL: type = "TOKEN_PLUS_EQUAL"; break;
+		case TOKEN_MINUS_EQUAL: type = "TOKEN_MINUS_EQUAL"; break;
+		case TOKEN_STAR_EQUAL: type = "TOKEN_STAR_EQUAL"; break;
+		case TOKEN_SLASH_EQUAL: type = "TOKEN_SLASH_EQUAL"; break;
+		case TOKEN_PERCENT_EQUAL: type = "TOKEN_PERCENT_EQUAL"; break;
+		case TOKEN_PLUS_PLUS: type = "TOKEN_PLUS_PLUS"; break;
+		case TOKEN_MINUS_MINUS: type = "TOKEN_MINUS_MINUS"; break;
 
 		// literals
 		case TOKEN_IDENTIFIER: type = "TOKEN_IDENTIFIER"; break;
@@ -106,6 +119,7 @@ public:
 		case TOKEN_BREAK: type = "TOKEN_BREAK"; break;
 		case TOKEN_CONTINUE: type = "TOKEN_CONTINUE"; break;
 		case TOKEN_LOOP: type = "TOKEN_LOOP"; break;
+		case TOKEN_MATCH: type = "TOKEN_MATCH"; break;
 		case TOKEN_DEF: type = "TOKEN_DEF"; break;
 		case TOKEN_RETURN: type = "TOKEN_RETURN"; break;
 		case TOKEN_STRUCT: type = "TOKEN_STRUCT"; break;
@@ -125,10 +139,11 @@ public:
 
 		//
 		case TOKEN_END_OF_FILE: type = "TOKEN_END_OF_FILE"; break;
+		default: break;
 		}
 
 		std::string val;
-		if (TOKEN_STRING == m_type || TOKEN_ENUM) val = m_stringValue;
+		if (TOKEN_STRING == m_type || TOKEN_ENUM == m_type) val = m_stringValue;
 		if (TOKEN_INTEGER == m_type) val = std::to_string(m_intValue);
 		if (TOKEN_FLOAT == m_type) val = std::to_string(m_doubleValue);
 
@@ -136,13 +151,13 @@ public:
 	}
 
 	TokenTypeEnum GetType() { return m_type; }
-	std::string Lexeme() { return m_lexeme; }
+	const std::string& Lexeme() const { return m_lexeme; }
 	double DoubleValue() { return m_doubleValue; }
 	int32_t IntValue() { return m_intValue; }
 	std::string StringValue() { return m_stringValue; }
 	EnumLiteral EnumValue() { return m_enumValue; }
 	int Line() { return m_line; }
-	std::string Filename() { return m_filename; }
+	const std::string& Filename() const { return m_filename; }
 
 private:
 	TokenTypeEnum m_type;
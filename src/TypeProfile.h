@@ -0,0 +1,141 @@
+#ifndef TYPE_PROFILE_H
+#define TYPE_PROFILE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <stdint.h>
+
+#include "Literal.h"
+#include "Expressions.h"
+
+
+// Argument types a def function is called with. Once a signature has been
+// seen often enough the body is specialized for it, every arithmetic or
+// comparison BinaryExpr whose operands are then known to be i32 or f32 gets
+// a typed fast path, see Interpreter::VisitBinary. The fast paths still check
+// the operand types, a parameter that is reassigned only costs the check.
+// Calls with other signatures run the generic body.
+class TypeProfile
+{
+public:
+
+	// calls with one signature before it is specialized
+	static const int HOT = 16;
+
+	// two bits per parameter in a signature
+	static const size_t MAX_PARAMS = 32;
+
+	// binaries are the candidates the parser found in the body
+	TypeProfile(const TokenList& params, std::vector<BinaryExpr*> binaries) : m_binaries(binaries), m_ways(0)
+	{
+		for (size_t i = 0; i < params.size(); ++i) m_params[params[i].Lexeme()] = int(i);
+	}
+
+	// specialization to run these arguments with, -1 for the generic body
+	int Way(const LiteralList& args)
+	{
+		if (m_binaries.empty() || args.size() > MAX_PARAMS) return -1;
+
+		uint64_t signature = 0;
+		for (size_t i = 0; i < args.size(); ++i) signature |= uint64_t(Kind(args[i])) << (2 * i);
+
+		for (int i = 0; i < m_ways; ++i)
+		{
+			if (m_signatures[i] == signature) return i;
+		}
+		if (BinaryExpr::WAYS == m_ways) return -1;
+
+		// the counts only matter until the ways are used up, drop them if a function sees many signatures
+		if (m_counts.size() > 64) m_counts.clear();
+		if (++m_counts[signature] < HOT) return -1;
+		m_counts.erase(signature);
+
+		std::vector<LiteralTypeEnum> types;
+		for (const Literal& arg : args) types.push_back(arg.GetType());
+		for (BinaryExpr* b : m_binaries) b->SetSpec(m_ways, Specialize(b, types));
+
+		m_signatures[m_ways] = signature;
+		return m_ways++;
+	}
+
+	int Ways() const { return m_ways; }
+
+private:
+
+	static int Kind(const Literal& v) { return v.IsInt() ? 1 : v.IsDouble() ? 2 : 0; }
+
+	// fast path for b with the parameters of these types, SPEC_NONE when an operand is not a number
+	uint8_t Specialize(BinaryExpr* b, const std::vector<LiteralTypeEnum>& types)
+	{
+		uint8_t op = SPEC_NONE;
+		switch (b->Operator()->GetType())
+		{
+		case TOKEN_PLUS: op = SPEC_ADD; break;
+		case TOKEN_MINUS: op = SPEC_SUB; break;
+		case TOKEN_STAR: op = SPEC_MUL; break;
+		case TOKEN_SLASH: op = SPEC_DIV; break;
+		case TOKEN_PERCENT: op = SPEC_MOD; break;
+		case TOKEN_LESS: op = SPEC_LESS; break;
+		case TOKEN_LESS_EQUAL: op = SPEC_LESS_EQUAL; break;
+		case TOKEN_GREATER: op = SPEC_GREATER; break;
+		case TOKEN_GREATER_EQUAL: op = SPEC_GREATER_EQUAL; break;
+		default: return SPEC_NONE;
+		}
+
+		LiteralTypeEnum left = Infer(b->Left(), types);
+		LiteralTypeEnum right = Infer(b->Right(), types);
+		if (LITERAL_TYPE_INVALID == left || LITERAL_TYPE_INVALID == right) return SPEC_NONE;
+		if (SPEC_MOD == op && (LITERAL_TYPE_INTEGER != left || LITERAL_TYPE_INTEGER != right)) return SPEC_NONE;
+
+		if (LITERAL_TYPE_DOUBLE == left) op |= BinaryExpr::LEFT_DOUBLE;
+		if (LITERAL_TYPE_DOUBLE == right) op |= BinaryExpr::RIGHT_DOUBLE;
+		return op;
+	}
+
+	// numeric type of an operand, LITERAL_TYPE_INVALID when it is not known
+	LiteralTypeEnum Infer(Expr* expr, const std::vector<LiteralTypeEnum>& types)
+	{
+		switch (expr->GetType())
+		{
+		case EXPRESSION_LITERAL:
+		{
+			const Literal& v = ((LiteralExpr*)expr)->GetLiteral();
+			return v.IsNumeric() ? v.GetType() : LITERAL_TYPE_INVALID;
+		}
+
+		case EXPRESSION_VARIABLE:
+		{
+			VariableExpr* v = (VariableExpr*)expr;
+			auto it = m_params.find(v->Operator()->Lexeme());
+			if (v->VecIndex() || m_params.end() == it) return LITERAL_TYPE_INVALID;
+			LiteralTypeEnum type = types[it->second];
+			return (LITERAL_TYPE_INTEGER == type || LITERAL_TYPE_DOUBLE == type) ? type : LITERAL_TYPE_INVALID;
+		}
+
+		case EXPRESSION_GROUP:
+			return Infer(((GroupExpr*)expr)->Expression(), types);
+
+		case EXPRESSION_BINARY:
+		{
+			// nested arithmetic is computed unboxed, comparisons are not numbers
+			uint8_t spec = Specialize((BinaryExpr*)expr, types);
+			uint8_t op = spec & BinaryExpr::OP_MASK;
+			if (SPEC_NONE == op || SPEC_LESS <= op) return LITERAL_TYPE_INVALID;
+			if (SPEC_DIV == op || 0 != (spec & (BinaryExpr::LEFT_DOUBLE | BinaryExpr::RIGHT_DOUBLE))) return LITERAL_TYPE_DOUBLE;
+			return LITERAL_TYPE_INTEGER;
+		}
+
+		default:
+			return LITERAL_TYPE_INVALID;
+		}
+	}
+
+	std::unordered_map<std::string, int> m_params;
+	std::vector<BinaryExpr*> m_binaries;
+	std::unordered_map<uint64_t, int> m_counts;
+	uint64_t m_signatures[BinaryExpr::WAYS];
+	int m_ways;
+};
+
+#endif // TYPE_PROFILE_H
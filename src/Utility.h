@@ -4,7 +4,7 @@
 #include <vector>
 #include <string>
 
-static std::string StrJoin(std::vector<std::string> s, std::string delimiter) {
+inline std::string StrJoin(std::vector<std::string> s, std::string delimiter) {
     std::string ret;
     for (size_t i = 0; i < s.size(); ++i)
     {
@@ -15,7 +15,7 @@ static std::string StrJoin(std::vector<std::string> s, std::string delimiter) {
 }
 
 // source: https://stackoverflow.com/questions/14265581/parse-split-a-string-in-c-using-string-delimiter-standard-c
-static std::vector<std::string> StrSplit(std::string s, std::string delimiter) {
+inline std::vector<std::string> StrSplit(std::string s, std::string delimiter) {
     size_t pos_start = 0, pos_end, delim_len = delimiter.length();
     std::string token;
     std::vector<std::string> res;
@@ -32,7 +32,7 @@ static std::vector<std::string> StrSplit(std::string s, std::string delimiter) {
 
 
 // based on https://stackoverflow.com/questions/3418231/replace-part-of-a-string-with-another-string
-static std::string StrReplace(std::string str, const std::string& from, const std::string& to) {
+inline std::string StrReplace(std::string str, const std::string& from, const std::string& to) {
 	if(from.empty()) return str;
     size_t start_pos = 0;
     while((start_pos = str.find(from, start_pos)) != std::string::npos) {
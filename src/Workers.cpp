@@ -0,0 +1,195 @@
+#include <thread>
+#include <algorithm>
+
+#include "Workers.h"
+#include "Binding.h"
+#include "ScriptHost.h"
+#include "Output.h"
+
+
+// body of a worker thread, owns everything it creates
+static void RunWorker(std::string filename, std::string function, size_t argc, Message args, std::shared_ptr<Channel> done)
+{
+	Literal ret = Literal(false);
+	{
+		ScriptHost host;
+		if (host.LoadFile(filename))
+		{
+			Interpreter* interpreter = host.GetInterpreter();
+			Environment* globals = interpreter->GetGlobals();
+
+			LiteralList list(argc);
+			size_t pos = 0;
+			bool unpacked = true;
+			for (auto& arg : list) unpacked = unpacked && Channel::Unpack(globals, args, pos, arg);
+
+			Token token(TOKEN_IDENTIFIER, function, 0, filename);
+			bool isGlobal = false;
+			Literal* callee = unpacked ? globals->Lookup(&token, "global::", isGlobal) : nullptr;
+
+			if (!unpacked)
+			{
+				Output::Report("Unable to read the arguments of worker '%s', struct types must be defined in '%s'.\n", function.c_str(), filename.c_str());
+			}
+			else if (!callee || !callee->IsCallable())
+			{
+				Output::Report("Worker function '%s' is not defined in '%s'.\n", function.c_str(), filename.c_str());
+			}
+			else if (callee->ExplicitArgs() && callee->Arity() != argc)
+			{
+				Output::Report("Expected %d arguments for worker function '%s', but found %d.\n", int(callee->Arity()), function.c_str(), int(argc));
+			}
+			else
+			{
+				try
+				{
+					ret = callee->Call(interpreter, std::move(list));
+					if (ret.IsInvalid()) ret = Literal(true);
+				}
+				catch (...)
+				{
+					Output::Report("Unexpected exit from worker function '%s'.\n", function.c_str());
+				}
+			}
+
+			ErrorHandler* errorHandler = interpreter->GetErrorHandler();
+			if (errorHandler->HasErrors())
+			{
+				errorHandler->Print();
+				errorHandler->Clear();
+			}
+		}
+	}
+
+	// everything the worker printed goes out before the spawner can see it finish
+	Output::Local().Flush();
+
+	Message msg;
+	if (!Channel::Pack(ret, msg))
+	{
+		Output::Report("Unable to return '%s' from worker function '%s'.\n", ret.ToString().c_str(), function.c_str());
+		msg = Message();
+		Channel::Pack(Literal(false), msg);
+	}
+	done->Send(msg);
+}
+
+
+static Literal MakeRecv(Environment* globals, bool wait)
+{
+	if (wait)
+	{
+		// chan::recv(), waits for a message
+		return MakeNative("recv", [globals](const std::shared_ptr<Channel>& ch)->Literal
+		{
+			Output::Local().Flush();
+			Message msg;
+			ch->Recv(msg);
+
+			Literal ret;
+			size_t pos = 0;
+			if (!Channel::Unpack(globals, msg, pos, ret)) Output::Report("Unable to read message in chan::recv().\n");
+			return ret;
+		}, "global::chan::");
+	}
+
+	// chan::try_recv(), fallback when nothing is waiting
+	return MakeNative("try_recv", [globals](const std::shared_ptr<Channel>& ch, const Literal& fallback)->Literal
+	{
+		Message msg;
+		if (!ch->TryRecv(msg)) return fallback;
+
+		Literal ret;
+		size_t pos = 0;
+		if (!Channel::Unpack(globals, msg, pos, ret)) Output::Report("Unable to read message in chan::try_recv().\n");
+		return ret;
+	}, "global::chan::");
+}
+
+
+void Workers::Include(Environment* globals)
+{
+	std::string nspace = "global::chan::";
+
+	// chan::make()
+	Bind(globals, "make", [](int32_t capacity)
+	{
+		return std::make_shared<Channel>(size_t(std::max(1, capacity)));
+	}, nspace);
+
+	// chan::send(), waits while the channel is full
+	// text printed so far is written before the receiver can act on the message
+	Bind(globals, "send", [](const std::shared_ptr<Channel>& ch, const Literal& value)
+	{
+		Output::Local().Flush();
+		Message msg;
+		if (!Channel::Pack(value, msg))
+		{
+			Output::Report("Unable to send '%s' over a channel.\n", value.ToString().c_str());
+			return false;
+		}
+		ch->Send(msg);
+		return true;
+	}, nspace);
+
+	// chan::try_send(), false when the channel is full
+	Bind(globals, "try_send", [](const std::shared_ptr<Channel>& ch, const Literal& value)
+	{
+		Output::Local().Flush();
+		Message msg;
+		if (!Channel::Pack(value, msg))
+		{
+			Output::Report("Unable to send '%s' over a channel.\n", value.ToString().c_str());
+			return false;
+		}
+		return ch->TrySend(msg);
+	}, nspace);
+
+	globals->Define("recv", MakeRecv(globals, true), nspace);
+	globals->Define("try_recv", MakeRecv(globals, false), nspace);
+
+	// chan::len()
+	Bind(globals, "len", [](const std::shared_ptr<Channel>& ch) { return int32_t(ch->Size()); }, nspace);
+
+	///////////////////////
+
+	// worker::spawn(filename, function, args...)
+	Literal spawn;
+	spawn.SetCallable(2, [](const LiteralList& args)->Literal
+	{
+		if (args.size() < 2 || !args[0].IsString() || !args[1].IsString())
+		{
+			Output::Report("Error in worker::spawn() arguments.\n");
+			return Literal();
+		}
+
+		Message msg;
+		for (size_t i = 2; i < args.size(); ++i)
+		{
+			if (!Channel::Pack(args[i], msg))
+			{
+				Output::Report("Unable to pass '%s' to a worker.\n", args[i].ToString().c_str());
+				return Literal();
+			}
+		}
+
+		Output::Local().Flush();
+		std::shared_ptr<Channel> done = std::make_shared<Channel>(1);
+		std::thread(RunWorker, args[0].StringValue(), args[1].StringValue(), args.size() - 2, std::move(msg), done).detach();
+		return Literal(done);
+	}, "global::worker::", false);
+	globals->Define("spawn", spawn, "global::worker::");
+}
+
+
+void Workers::Rebind(Environment* globals)
+{
+	const char* names[] = { "recv", "try_recv" };
+	for (int i = 0; i < 2; ++i)
+	{
+		Token token(TOKEN_IDENTIFIER, names[i], 0, "fork");
+		bool isGlobal = false;
+		Literal* slot = globals->Lookup(&token, "global::chan::", isGlobal);
+		if (slot && LITERAL_TYPE_FUNCTION == slot->GetType()) *slot = MakeRecv(globals, 0 == i);
+	}
+}
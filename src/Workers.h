@@ -0,0 +1,35 @@
+#ifndef WORKERS_H
+#define WORKERS_H
+
+#include <string>
+
+#include "Channel.h"
+#include "Environment.h"
+#include "Literal.h"
+
+
+// Background workers and the channels used to talk to them.
+//
+//     def jobs = chan::make(64);
+//     def done = worker::spawn("pathfind.tt", "run", jobs);
+//     chan::send(jobs, request);
+//     ...
+//     def path = chan::try_recv(results, false);
+//
+// A worker loads its own file into its own interpreter on a new thread and calls
+// one function in it, nothing but channels is shared with the script that spawned
+// it. spawn returns a channel that receives the function's return value, or true
+// when it returns nothing and false when it could not be started, so receiving
+// from it waits for the worker to finish. Scripts should do that before exiting.
+class Workers
+{
+public:
+
+	// chan:: and worker:: functions
+	static void Include(Environment* globals);
+
+	// natives that rebuild struct instances hold on to their globals, give a snapshot its own
+	static void Rebind(Environment* globals);
+};
+
+#endif // WORKERS_H
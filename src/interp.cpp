@@ -12,12 +12,9 @@
 #include "Interpreter.h"
 #include "ErrorHandler.h"
 
-Interpreter* interpreter;
-ErrorHandler* errorHandler;
+void RunFile(Interpreter* interpreter, ErrorHandler* errorHandler, const char* filename);
 
-void RunFile(const char* filename);
-
-bool Run(const char* buf, const char* filename)
+bool Run(Interpreter* interpreter, ErrorHandler* errorHandler, const char* buf, const char* filename)
 {
 	if (std::string(buf).compare("quit") == 0) return false;
 	if (std::string(buf).compare("q") == 0) return false;
@@ -55,7 +52,7 @@ bool Run(const char* buf, const char* filename)
 }
 
 
-void RunPrompt()
+void RunPrompt(Interpreter* interpreter, ErrorHandler* errorHandler)
 {
 	//char* cmd = "(1 + 2) * 3.0;";
 	//char* cmd = "1 + 2 * 3.5 - 4 < 3;";
@@ -124,7 +121,7 @@ void RunPrompt()
 
 
 	printf("%s\n", cmd);
-	Run(cmd, "Console");
+	Run(interpreter, errorHandler, cmd, "Console");
 
 
 	// play game override
@@ -134,11 +131,11 @@ void RunPrompt()
 		std::cout << "> ";
 		std::cin.getline(inbuf, 256);
 
-		if (!Run(inbuf, "Console")) break;
+		if (!Run(interpreter, errorHandler, inbuf, "Console")) break;
 	}
 }
 
-void RunFile(const char* filename)
+void RunFile(Interpreter* interpreter, ErrorHandler* errorHandler, const char* filename)
 {
 	std::ifstream f;
 	f.open(filename, std::ios::in | std::ios::binary | std::ios::ate);
@@ -146,7 +143,7 @@ void RunFile(const char* filename)
 	if (!f.is_open())
 	{
 		printf("Failed to open file: %s\n", filename);
-		RunPrompt();
+		RunPrompt(interpreter, errorHandler);
 		return;
 	}
 
@@ -158,7 +155,7 @@ void RunFile(const char* filename)
 	f.read(buffer, n);
 	f.close();
 	
-	Run(buffer, filename);
+	Run(interpreter, errorHandler, buffer, filename);
 	
 	delete[] buffer;
 }
@@ -169,8 +166,8 @@ int main(int nargs, char* argsv[])
 	const char* version = "0.1.5";
 	printf("Launching Tentacode Interpreter v%s\n", version);
 
-	errorHandler = new ErrorHandler();
-	interpreter = new Interpreter(errorHandler);
+	ErrorHandler* errorHandler = new ErrorHandler();
+	Interpreter* interpreter = new Interpreter(errorHandler);
 
 	if (1 == nargs)
 	{
@@ -178,16 +175,16 @@ int main(int nargs, char* argsv[])
 		f.open("autoplay.tt", std::ios::in | std::ios::binary | std::ios::ate);
 		if (f.is_open())
 		{
-			RunFile("autoplay.tt");
+			RunFile(interpreter, errorHandler, "autoplay.tt");
 		}
 		else {
-			RunPrompt();
+			RunPrompt(interpreter, errorHandler);
 		}
 	}
 	else if (2 == nargs)
 	{
 		printf("Run File: %s\n", argsv[1]);
-		RunFile(argsv[1]);
+		RunFile(interpreter, errorHandler, argsv[1]);
 	}
 	else
 	{
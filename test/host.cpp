@@ -0,0 +1,307 @@
+// embedding API tests, everything a script can check about itself is in unit_test.tt
+#include <chrono>
+#include <string>
+#include <thread>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "ScriptHost.h"
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("Test Failed, %s:%d: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+// stdout points at a temporary file while this is in scope
+class Capture
+{
+public:
+
+	Capture()
+	{
+		fflush(stdout);
+		m_saved = dup(fileno(stdout));
+		m_file = tmpfile();
+		dup2(fileno(m_file), fileno(stdout));
+	}
+
+	~Capture()
+	{
+		fflush(stdout);
+		dup2(m_saved, fileno(stdout));
+		close(m_saved);
+		fclose(m_file);
+	}
+
+	// what has reached stdout so far
+	std::string Text()
+	{
+		fflush(stdout);
+		std::string text;
+		rewind(m_file);
+		for (int c; EOF != (c = fgetc(m_file)); ) text.push_back(char(c));
+		return text;
+	}
+
+private:
+
+	int m_saved;
+	FILE* m_file;
+};
+
+static size_t Count(const std::string& text, const std::string& part)
+{
+	size_t n = 0;
+	for (size_t pos = text.find(part); std::string::npos != pos; pos = text.find(part, pos + 1)) n++;
+	return n;
+}
+
+// recursion in a time sliced call runs on a coroutine stack
+static void TimeSliceRecursion()
+{
+	ScriptHost host;
+	CHECK(host.Load("def deep(n) { if n == 0 { return 0; } return 1 + deep(n - 1); }\n", "slice"));
+	ScriptFunction deep = host.Function("deep");
+
+	ScriptTask task = deep.Start(300);
+	while (!task.Run(std::chrono::microseconds(50))) {}
+	CHECK(task.Result().IsInt() && 300 == task.Result().IntValue());
+
+	// running out of stack ends the whole call with one error
+	std::string text;
+	{
+		Capture out;
+		ScriptTask endless = deep.Start(10000000);
+		while (!endless.Run(std::chrono::microseconds(5000))) {}
+		CHECK(endless.Failed());
+		text = out.Text();
+	}
+	CHECK(1 == Count(text, "File:") && 1 == Count(text, "Call stack exhausted"));
+}
+
+// calls print what the script reports, like Load, and say so through Failed
+static void CallErrors()
+{
+	ScriptHost host;
+	CHECK(host.Load("def ok(n) { return n + 1; }\ndef bad(n) { return n - \"x\"; }\n"
+		"def halve(n) { i32 x = 7; x /= n; return x; }\n", "errors"));
+	ScriptFunction ok = host.Function("ok"), bad = host.Function("bad"), missing = host.Function("missing");
+	ScriptFunction halve = host.Function("halve");
+
+	CHECK(2 == ok.CallAs<int32_t>(1) && !ok.Failed());
+	CHECK(bad(1).IsInvalid() && bad.Failed());
+	CHECK(3 == ok.CallAs<int32_t>(2) && !ok.Failed());
+	missing();
+	CHECK(missing.Failed());
+	ok(1, 2);
+	CHECK(ok.Failed());
+	CHECK(3 == halve.CallAs<int32_t>(2) && !halve.Failed());
+	halve(0);
+	CHECK(halve.Failed());
+
+	ScriptTask task = bad.Start(1);
+	while (!task.Run(std::chrono::microseconds(50))) {}
+	CHECK(task.Failed());
+	ScriptTask good = ok.Start(1);
+	while (!good.Run(std::chrono::microseconds(50))) {}
+	CHECK(!good.Failed() && 2 == good.Result().IntValue());
+}
+
+// forks of one program run on their own threads next to the host
+static void ForkThreads()
+{
+	ScriptHost host;
+	CHECK(host.Load("i32 base = 1;\n"
+		"def rebase(b) { base = b; }\n"
+		"def step(a, b) { return a * 3 + b; }\n"
+		"def run(n) { i32 t = 0; for i in 0..n { t = (step(t, i) + base) % 997; } return t; }\n", "fork"));
+
+	const int32_t rounds = 200;
+	int32_t got[3] = {}, want[3] = {};
+	auto play = [&](ScriptHost* script, int32_t b, int32_t& out)
+	{
+		script->Function("rebase")(b);
+		ScriptFunction run = script->Function("run");
+		for (int32_t i = 0; i < rounds; ++i) out += run.CallAs<int32_t>(500);
+	};
+
+	std::unique_ptr<ScriptHost> a = host.Fork(), b = host.Fork();
+	std::thread first([&] { play(a.get(), 2, got[0]); });
+	std::thread second([&] { play(b.get(), 3, got[1]); });
+	play(&host, 4, got[2]);
+	first.join();
+	second.join();
+
+	for (int32_t i = 0; i < 3; ++i)
+	{
+		std::unique_ptr<ScriptHost> alone = host.Fork();
+		play(alone.get(), 2 + i, want[i]);
+	}
+	CHECK(got[0] == want[0] && got[1] == want[1] && got[2] == want[2]);
+	CHECK(got[0] != got[1]);
+}
+
+// a builtin called by name checks its arguments like the bound function does
+static void IntrinsicArgs()
+{
+	ScriptHost host;
+	CHECK(host.Load("def root(x) { return sqrt(x); }\n"
+		"def bound(x) { def f = sqrt; return f(x); }\n"
+		"def least(a, b) { return min(a, b); }\n", "intrinsic"));
+	ScriptFunction root = host.Function("root"), bound = host.Function("bound"), least = host.Function("least");
+	CHECK(3 == root(9.0).DoubleValue() && 2 == least(2, 5).DoubleValue());
+
+	std::string direct, called, second;
+	{
+		Capture out;
+		CHECK(root("abc").IsInvalid());
+		direct = out.Text();
+	}
+	{
+		Capture out;
+		CHECK(bound("abc").IsInvalid());
+		called = out.Text();
+	}
+	{
+		Capture out;
+		CHECK(least(1, "x").IsInvalid());
+		second = out.Text();
+	}
+	CHECK(1 == Count(direct, "Invalid argument 1 for 'sqrt'") && direct == called);
+	CHECK(1 == Count(second, "Invalid argument 2 for 'min'"));
+}
+
+// a + with a missing operand is a parse error, not a crash in the string + rewrite
+static void MalformedConcat()
+{
+	const char* sources[] = { "println(1 +);\n", "var s = \"a\"; s = s + ;\n", "var t = \"a\" + 1 + ;\n", "println(\"a\" as );\n" };
+	for (const char* source : sources)
+	{
+		ScriptHost host;
+		CHECK(!host.Load(source, "concat"));
+	}
+}
+
+// a def that copies an output would race with the iterations writing it, Load reports the error
+static void ParallelCalls()
+{
+	ScriptHost host;
+	CHECK(!host.Load("vec<i32> out = [0; 3000];\n"
+		"def grab() { vec<i32> c = out; return len(c); }\n"
+		"parallel for i in 0..3000 { out[i] = grab() + i; }\n", "parallel"));
+
+	// nor one that writes anything but its own variables, however deep the call
+	const char* writes[] = {
+		"i32 total = 0;\nparallel for i in 0..100 { total += 1; }\n",
+		"i32 total = 0;\ndef bump() { total += 1; }\nparallel for i in 0..100 { bump(); }\n",
+		"i32 total = 0;\ndef add() { total = total + 1; }\ndef outer(n) { i32 t = n; add(); return t; }\n"
+		"vec<i32> out = [0; 100];\nparallel for i in 0..100 { out[i] = outer(i); }\n" };
+	for (const char* source : writes)
+	{
+		ScriptHost racy;
+		CHECK(!racy.Load(source, "parallel"));
+	}
+
+	ScriptHost other;
+	CHECK(other.Load("vec<i32> out = [0; 3000];\n"
+		"i32 scale = 3;\n"
+		"def sq(x) { i32 y = x * scale; y += 1; return y * x; }\n"
+		"parallel for i in 0..3000 { out[i] = sq(i); }\n"
+		"if out[2] != 14 { println(\"Test Failed, host parallel\"); }\n", "parallel"));
+}
+
+// print waits in the thread's buffer until it is full, a line ends in line mode, or flush()
+static void BufferedOutput()
+{
+	ScriptHost host;
+	CHECK(host.Load("def say(text) { print(text); }\n"
+		"def line(text) { println(text); }\n"
+		"def settings() { return output::capacity() as string + \" \" + output::lines() as string; }\n"
+		"def warn() { println(\"before\"); def r = sqrt(\"x\"); println(\"after\"); }\n", "output"));
+	ScriptFunction say = host.Function("say"), line = host.Function("line"), settings = host.Function("settings");
+	ScriptFunction warn = host.Function("warn");
+	ScriptFunction buffer = host.Function("output::buffer"), flush = host.Function("flush");
+	std::string previous = settings.CallAs<std::string>();
+
+	std::string held, full, unended, ended, flushed;
+	{
+		Capture out;
+		buffer(8, false);
+		say("abc");
+		held = out.Text();
+		say("defgh");
+		full = out.Text();
+		line("ij");
+		unended = out.Text();
+		buffer(64, true);
+		line("kl");
+		ended = out.Text();
+		say("m");
+		flush();
+		flushed = out.Text();
+	}
+
+	CHECK("" == held);
+	CHECK("abcdefgh" == full);
+	CHECK("abcdefgh" == unended);
+	CHECK("abcdefghij\nkl\n" == ended);
+	CHECK("abcdefghij\nkl\nm" == flushed);
+
+	// a warning on a pipe comes out after the text printed before it
+	std::string mixed;
+	{
+		Capture out;
+		buffer(4096, false);
+		warn();
+		flush();
+		mixed = out.Text();
+	}
+	size_t warning = mixed.find("Invalid argument");
+	CHECK(mixed.find("before") < warning && warning < mixed.find("after"));
+
+	int32_t capacity = 0;
+	char lines[8] = {};
+	CHECK(2 == sscanf(previous.c_str(), "%d %7s", &capacity, lines));
+	buffer(capacity, std::string("true") == lines);
+	CHECK(previous == settings.CallAs<std::string>());
+}
+
+// test/plugin.c through the C ABI, plugins is the directory the makefile builds it into
+static void NativePlugin(const std::string& plugins)
+{
+	ScriptHost host;
+	CHECK(host.Load("include native \"" + plugins + "/test_plugin.so\" as sample;\n"
+		"def check_dot() { return sample::dot([1.0, 2.0], [3.0, 4.0]); }\n"
+		"def check_reverse() { vec<i32> r = sample::reverse([1, 2, 3]); return r[0] * 100 + r[1] * 10 + r[2]; }\n"
+		"def check_describe() { return sample::describe(1, 2.5, \"s\", true, [1]); }\n"
+		"def check_length() { return sample::length(\"hello\"); }\n"
+		"def check_values() { return sample::answer as string + \" \" + sample::half as string + \" \" + sample::name; }\n", "plugin"));
+
+	CHECK(11.0 == host.Function("check_dot").CallAs<double>());
+	CHECK(321 == host.Function("check_reverse").CallAs<int32_t>());
+	CHECK("i32 f32 string bool vec" == host.Function("check_describe").CallAs<std::string>());
+	CHECK(5 == host.Function("check_length").CallAs<int32_t>());
+	CHECK("42 0.500000 global::sample::" == host.Function("check_values").CallAs<std::string>());
+
+	// a plugin that refuses to register is unloaded and defines nothing
+	ScriptHost rejected;
+	CHECK(rejected.Load("include native \"" + plugins + "/test_plugin_reject.so\" as bad;\n"
+		"def use_bad() { return bad::dot([1.0], [1.0]); }\n", "plugin"));
+	ScriptFunction bad = rejected.Function("use_bad");
+	bad();
+	CHECK(bad.Failed());
+}
+
+int main(int argc, char** argv)
+{
+	TimeSliceRecursion();
+	CallErrors();
+	IntrinsicArgs();
+	ForkThreads();
+	MalformedConcat();
+	ParallelCalls();
+	BufferedOutput();
+	NativePlugin(argc > 1 ? argv[1] : "./bin");
+
+	if (0 == failures) printf("All host tests passed.\n");
+	return 0 == failures ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+/* sample native plugin for the host tests, built as C so only the C ABI in PluginApi.h is used.
+   Built with -DTT_PLUGIN_REJECT it defines everything and then refuses to register. */
+#include <string.h>
+
+#include "PluginApi.h"
+
+static const tt_api* api;
+
+static void dot(const tt_value* const* args, int32_t nargs, tt_value* ret, void* user)
+{
+	const double* a = api->get_vec_f32(args[0]);
+	const double* b = api->get_vec_f32(args[1]);
+	int32_t n = api->len(args[0]);
+	double sum = 0;
+	(void)nargs;
+	(void)user;
+	if (!a || !b || n != api->len(args[1])) return;
+	for (int32_t i = 0; i < n; ++i) sum += a[i] * b[i];
+	api->set_f32(ret, sum);
+}
+
+static void reverse(const tt_value* const* args, int32_t nargs, tt_value* ret, void* user)
+{
+	int32_t values[64];
+	const int32_t* v = api->get_vec_i32(args[0]);
+	int32_t n = api->len(args[0]);
+	(void)nargs;
+	(void)user;
+	if (!v || n > 64) return;
+	for (int32_t i = 0; i < n; ++i) values[i] = v[n - 1 - i];
+	api->set_vec_i32(ret, values, n);
+}
+
+static void describe(const tt_value* const* args, int32_t nargs, tt_value* ret, void* user)
+{
+	static const char* names[] = { "invalid", "f32", "i32", "string", "bool", "enum", "vec", "other" };
+	char text[256] = "";
+	(void)user;
+	for (int32_t i = 0; i < nargs; ++i)
+	{
+		if (i) strcat(text, " ");
+		strcat(text, names[api->type_of(args[i])]);
+	}
+	api->set_string(ret, text);
+}
+
+static void length(const tt_value* const* args, int32_t nargs, tt_value* ret, void* user)
+{
+	const char* s = api->get_string(args[0]);
+	(void)nargs;
+	(void)user;
+	if (s) api->set_i32(ret, (int32_t)strlen(s));
+}
+
+TT_PLUGIN_EXPORT int32_t tt_plugin_register(const tt_api* table)
+{
+	if (table->version != TT_PLUGIN_API_VERSION || table->size < sizeof(tt_api)) return 0;
+	api = table;
+
+	api->define_function(api->host, "dot", 2, dot, 0);
+	api->define_function(api->host, "reverse", 1, reverse, 0);
+	api->define_function(api->host, "describe", TT_VARIADIC, describe, 0);
+	api->define_function(api->host, "length", 1, length, 0);
+	api->define_i32(api->host, "answer", 42);
+	api->define_f32(api->host, "half", 0.5);
+	api->define_string(api->host, "name", api->nspace);
+#ifdef TT_PLUGIN_REJECT
+	return 0;
+#else
+	return 1;
+#endif
+}